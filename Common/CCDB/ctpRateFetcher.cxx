@@ -23,7 +23,9 @@
 #include <cstdint>
 #include <map>
 #include <ostream>
+#include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace o2
@@ -31,6 +33,38 @@ namespace o2
 double ctpRateFetcher::fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& sourceName, bool fCrashOnNull)
 {
   setupRun(runNumber, ccdb, timeStamp);
+  auto& cached = mRateCache[sourceName];
+  if (!cached.isValid || cached.timeStamp != timeStamp) {
+    cached.rate = fetchUncached(ccdb, timeStamp, runNumber, sourceName, fCrashOnNull);
+    cached.timeStamp = timeStamp;
+    cached.isValid = true;
+  }
+  return cached.rate;
+}
+
+void ctpRateFetcher::fetch(o2::ccdb::BasicCCDBManager* ccdb, std::span<const uint64_t> timeStamps, int runNumber, const std::string& sourceName, std::span<double> rates, bool fCrashOnNull)
+{
+  if (timeStamps.size() != rates.size()) {
+    LOG(fatal) << "Inconsistent sizes of timestamps (" << timeStamps.size() << ") and rates (" << rates.size() << ")";
+  }
+  if (timeStamps.empty()) {
+    return;
+  }
+  setupRun(runNumber, ccdb, timeStamps[0]);
+  auto& cached = mRateCache[sourceName];
+  for (size_t i = 0; i < timeStamps.size(); i++) {
+    // consecutive collisions very often share the timestamp
+    if (!cached.isValid || cached.timeStamp != timeStamps[i]) {
+      cached.rate = fetchUncached(ccdb, timeStamps[i], runNumber, sourceName, fCrashOnNull);
+      cached.timeStamp = timeStamps[i];
+      cached.isValid = true;
+    }
+    rates[i] = cached.rate;
+  }
+}
+
+double ctpRateFetcher::fetchUncached(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& sourceName, bool fCrashOnNull)
+{
   if (sourceName.find("ZNC") != std::string::npos) {
     if (runNumber < 544448) {
       return fetchCTPratesInputs(ccdb, timeStamp, runNumber, 25) / (sourceName.find("hadronic") != std::string::npos ? 28. : 1.);
@@ -107,6 +141,7 @@ void ctpRateFetcher::setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, u
     return;
   }
   mRunNumber = runNumber;
+  mRateCache.clear();
   LOG(debug) << "Setting up CTP scalers for run " << mRunNumber;
   if (mManualCleanup) {
     delete mConfig;
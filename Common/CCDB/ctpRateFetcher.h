@@ -15,7 +15,9 @@
 #include <CCDB/BasicCCDBManager.h>
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <unordered_map>
 
 namespace o2
 {
@@ -36,10 +38,13 @@ class ctpRateFetcher
  public:
   ctpRateFetcher() = default;
   double fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& sourceName, bool fCrashOnNull = true);
+  /// batch version: fills rates[i] for timeStamps[i], rates must have the same size as timeStamps
+  void fetch(o2::ccdb::BasicCCDBManager* ccdb, std::span<const uint64_t> timeStamps, int runNumber, const std::string& sourceName, std::span<double> rates, bool fCrashOnNull = true);
 
   void setManualCleanup(bool manualCleanup = true) { mManualCleanup = manualCleanup; }
 
  private:
+  double fetchUncached(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& sourceName, bool fCrashOnNull);
   double fetchCTPratesInputs(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, int input);
   double fetchCTPratesClasses(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& className, int inputType = 1);
   double pileUpCorrection(double rate);
@@ -50,6 +55,14 @@ class ctpRateFetcher
   ctp::CTPConfiguration* mConfig = nullptr;
   ctp::CTPRunScalers* mScalers = nullptr;
   parameters::GRPLHCIFData* mLHCIFdata = nullptr;
+  /// last rate fetched for a source in the current run
+  struct CachedRate {
+    uint64_t timeStamp = 0;
+    double rate = 0.;
+    bool isValid = false;
+  };
+  /// one entry per source, i.e. bounded within a run: consecutive calls with the same timestamp are evaluated from the scalers only once
+  std::unordered_map<std::string, CachedRate> mRateCache;
 };
 } // namespace o2
 
@@ -107,6 +107,24 @@ void EventPlaneHelper::SumQvectors(int det, int chno, float ampl, int nmod, TCom
   sum += ampl;
 }
 
+void EventPlaneHelper::InitChannelHarmonics(const std::vector<int>& nmods, const o2::ft0::Geometry& ft0geom, o2::fv0::Geometry* fv0geom)
+{
+  /* Tabulate cos(n*phi) and sin(n*phi) of every FT0 and FV0 channel with the
+    current offsets, so that the per-event Q-vectors need neither the geometry
+    nor any trigonometric function. */
+  mNmods = nmods.size();
+  mChannelCos.assign((NChannelsFT0 + NChannelsFV0) * mNmods, 0.);
+  mChannelSin.assign((NChannelsFT0 + NChannelsFV0) * mNmods, 0.);
+
+  for (int ich = 0; ich < NChannelsFT0 + NChannelsFV0; ich++) {
+    double phi = ich < NChannelsFT0 ? GetPhiFT0(ich, ft0geom) : GetPhiFV0(ich - NChannelsFT0, fv0geom);
+    for (int imod = 0; imod < mNmods; imod++) {
+      mChannelCos[ich * mNmods + imod] = TMath::Cos(phi * nmods[imod]);
+      mChannelSin[ich * mNmods + imod] = TMath::Sin(phi * nmods[imod]);
+    }
+  }
+}
+
 int EventPlaneHelper::GetCentBin(float cent)
 {
   const float centClasses[] = {0., 5., 10., 20., 30., 40., 50., 60., 80.};
@@ -67,6 +67,22 @@ class EventPlaneHelper
   // the detector and amplitude.
   void SumQvectors(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum, const o2::ft0::Geometry& ft0geom, o2::fv0::Geometry* fv0geom);
 
+  // Method to tabulate cos(n*phi) and sin(n*phi) of all FIT channels for the
+  // harmonics in nmods. To be called again whenever the offsets change.
+  void InitChannelHarmonics(const std::vector<int>& nmods, const o2::ft0::Geometry& ft0geom, o2::fv0::Geometry* fv0geom);
+
+  // Method to add the contribution of one FIT channel to the Q-vectors of all the
+  // harmonics given to InitChannelHarmonics, qRe and qIm being indexed by harmonic.
+  void SumQvectorsHarmonics(int det, int chno, float ampl, double* qRe, double* qIm) const
+  {
+    const double* chCos = &mChannelCos[(det == 0 ? chno : NChannelsFT0 + chno) * mNmods];
+    const double* chSin = &mChannelSin[(det == 0 ? chno : NChannelsFT0 + chno) * mNmods];
+    for (int imod = 0; imod < mNmods; imod++) {
+      qRe[imod] += ampl * chCos[imod];
+      qIm[imod] += ampl * chSin[imod];
+    }
+  }
+
   // Method to get the bin corresponding to a centrality percentile, according to the
   // centClasses[] array defined in Tasks/qVectorsQA.cxx.
   // Note: Any change in one task should be reflected in the other.
@@ -107,7 +123,13 @@ class EventPlaneHelper
   double mOffsetFV0rightX = 0.; // X-coordinate of the offset of FV0-A right.
   double mOffsetFV0rightY = 0.; // Y-coordinate of the offset of FV0-A right.
 
-  ClassDefNV(EventPlaneHelper, 2)
+  static constexpr int NChannelsFT0 = 208; // FT0-A and FT0-C channels.
+  static constexpr int NChannelsFV0 = 48;  // FV0-A channels.
+  int mNmods = 0;                          // Number of tabulated harmonics.
+  std::vector<double> mChannelCos;         // cos(n*phi) per FIT channel (FT0, then FV0) and harmonic.
+  std::vector<double> mChannelSin;         // sin(n*phi) per FIT channel (FT0, then FV0) and harmonic.
+
+  ClassDefNV(EventPlaneHelper, 3)
 };
 
 #endif // COMMON_CORE_EVENTPLANEHELPER_H_
@@ -485,8 +485,19 @@ class ExpTimes
   template <typename ParamType>
   static float GetExpectedSigma(const ParamType& parameters, const TrackType& track, const float tofSignal, const float collisionTimeRes)
   {
-    const float& mom = track.p();
-    const float& etaTrack = track.eta();
+    return GetExpectedSigma(parameters, track.p(), track.eta(), tofSignal, collisionTimeRes);
+  }
+
+  /// Gets the expected resolution of the t-texp-t0
+  /// Given the track momentum and pseudorapidity, a TOF signal and collision time resolutions
+  /// \param parameters Detector response parameters
+  /// \param mom Momentum of the track of interest
+  /// \param etaTrack Pseudorapidity of the track of interest
+  /// \param tofSignal TOF signal of the track of interest
+  /// \param collisionTimeRes Collision time resolution of the track of interest
+  template <typename ParamType>
+  static float GetExpectedSigma(const ParamType& parameters, const float mom, const float etaTrack, const float tofSignal, const float collisionTimeRes)
+  {
     if (mom <= 0) {
       return -999.f;
     }
@@ -0,0 +1,311 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \file   TPCRecalibrationProvider.h
+/// \brief  Provider of recalibrated TPC nsigma from custom Bethe-Bloch parameterisations
+///         and postcalibration maps, evaluated in blocks into an index-aligned buffer
+///
+
+#ifndef COMMON_CORE_PID_TPCRECALIBRATIONPROVIDER_H_
+#define COMMON_CORE_PID_TPCRECALIBRATIONPROVIDER_H_
+
+#include <Framework/Logger.h>
+#include <MathUtils/BetheBlochAleph.h>
+
+#include <TAxis.h>
+#include <TH3.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace o2::pid::tpc
+{
+
+/// \brief Flat copy of a 3D histogram
+/// The bin lookup follows TAxis::FindFixBin, with under- and overflows clamped to the first and last bin
+class FlatMap3D
+{
+ public:
+  FlatMap3D() = default;
+
+  /// Copies the binning and the content of the histogram, overflow cells included
+  void set(const TH3* hist)
+  {
+    const std::array<const TAxis*, 3> axes{hist->GetXaxis(), hist->GetYaxis(), hist->GetZaxis()};
+    for (int iAxis{0}; iAxis < 3; ++iAxis) {
+      const int nBins = axes[iAxis]->GetNbins();
+      mNBins[iAxis] = nBins;
+      mXmin[iAxis] = axes[iAxis]->GetXmin();
+      mXmax[iAxis] = axes[iAxis]->GetXmax();
+      mEdges[iAxis].clear();
+      if (axes[iAxis]->IsVariableBinSize()) {
+        mEdges[iAxis].assign(axes[iAxis]->GetXbins()->GetArray(), axes[iAxis]->GetXbins()->GetArray() + nBins + 1);
+      }
+    }
+    mContent.resize(hist->GetNcells());
+    for (int iCell{0}; iCell < hist->GetNcells(); ++iCell) {
+      mContent[iCell] = hist->GetBinContent(iCell);
+    }
+    checkBinning(axes);
+  }
+
+  void reset()
+  {
+    mNBins = {0, 0, 0};
+    mContent.clear();
+  }
+
+  bool isSet() const { return !mContent.empty(); }
+
+  /// Bin along one axis, as TAxis::FindFixBin clamped to [1, nBins]
+  int findBin(const int iAxis, const double value) const
+  {
+    const int nBins = mNBins[iAxis];
+    int bin;
+    if (value < mXmin[iAxis]) {
+      bin = 0;
+    } else if (!(value < mXmax[iAxis])) {
+      bin = nBins + 1;
+    } else if (mEdges[iAxis].empty()) {
+      bin = 1 + static_cast<int>(nBins * (value - mXmin[iAxis]) / (mXmax[iAxis] - mXmin[iAxis]));
+    } else {
+      const auto& edges = mEdges[iAxis];
+      bin = static_cast<int>(std::upper_bound(edges.begin(), edges.end(), value) - edges.begin());
+    }
+    return std::clamp(bin, 1, nBins);
+  }
+
+  /// Content of the cell, as TH3::GetBinContent(binX, binY, binZ)
+  double content(const int binX, const int binY, const int binZ) const
+  {
+    return mContent[binX + (mNBins[0] + 2) * (binY + (mNBins[1] + 2) * binZ)];
+  }
+
+ private:
+  /// Compares findBin() with TAxis::FindFixBin at the bin edges and just below them
+  void checkBinning(const std::array<const TAxis*, 3>& axes) const
+  {
+    for (int iAxis{0}; iAxis < 3; ++iAxis) {
+      const int nBins = mNBins[iAxis];
+      for (int iBin{1}; iBin <= nBins + 1; ++iBin) {
+        const double edge = axes[iAxis]->GetBinLowEdge(iBin);
+        for (const double value : {edge, std::nextafter(edge, -std::numeric_limits<double>::infinity())}) {
+          const int binTAxis = std::clamp(axes[iAxis]->FindFixBin(value), 1, nBins);
+          if (findBin(iAxis, value) != binTAxis) {
+            LOGP(fatal, "Flat map bin {} differs from TAxis bin {} at {} on axis {}", findBin(iAxis, value), binTAxis, value, iAxis);
+          }
+        }
+      }
+    }
+  }
+
+  std::array<int, 3> mNBins{0, 0, 0};
+  std::array<double, 3> mXmin{0., 0., 0.};
+  std::array<double, 3> mXmax{0., 0., 0.};
+  std::array<std::vector<double>, 3> mEdges{}; // bin edges of the variable-size axes, empty otherwise
+  std::vector<double> mContent{};
+};
+
+/// \brief Recalibrated TPC nsigma for a set of hypotheses
+/// Parameterisations and maps are loaded once per run into flat tables. The hypotheses requested by the task
+/// are registered as columns and evaluated for a whole track table in one pass, block by block, into a
+/// buffer aligned to the table rows. Helpers owned by the same task can then read it instead of recomputing.
+class RecalibrationProvider
+{
+ public:
+  enum class Method : int {
+    BetheBloch = 0, // custom Bethe-Bloch parameterisation, (dEdx - expected) / (expected * resolution)
+    PostCalibration // mean and width maps in (nClusters, pIn, eta) applied to the nsigma from the AO2D
+  };
+
+  static constexpr int NSlots = 16;
+  static constexpr int MaxColumns = 16;
+  static constexpr int BlockSize = 256;
+
+  RecalibrationProvider() = default;
+
+  /// Sets the Bethe-Bloch parameters of a slot
+  /// \param params are bb1, ..., bb5 and the relative resolution
+  void setBetheBlochParams(const int slot, const std::vector<double>& params)
+  {
+    if (params.size() < 6) {
+      LOGP(fatal, "Bethe-Bloch parameterisation for slot {} needs 6 parameters, got {}", slot, params.size());
+    }
+    std::copy_n(params.begin(), 6, mBetheBloch[slot].begin());
+    mHasBetheBloch[slot] = true;
+  }
+
+  /// Sets the postcalibration maps of a slot
+  void setPostCalibMaps(const int slot, const TH3* mean, const TH3* sigma)
+  {
+    mMeanMaps[slot].set(mean);
+    mSigmaMaps[slot].set(sigma);
+  }
+
+  void resetPostCalibMaps()
+  {
+    for (int iSlot{0}; iSlot < NSlots; ++iSlot) {
+      mMeanMaps[iSlot].reset();
+      mSigmaMaps[iSlot].reset();
+    }
+  }
+
+  bool hasBetheBloch(const int slot) const { return mHasBetheBloch[slot]; }
+  bool hasPostCalibMaps(const int slot) const { return mMeanMaps[slot].isSet() && mSigmaMaps[slot].isSet(); }
+
+  /// nsigma from the custom Bethe-Bloch parameterisation
+  /// \param mass is the mass of the hypothesis used for the beta-gamma scaling
+  float betheBlochNSigma(const int slot, const float mass, const float tpcPin, const float dEdx) const
+  {
+    const auto& par = mBetheBloch[slot];
+    auto bgScaling = 1 / mass;
+    double expBethe = o2::common::BetheBlochAleph(static_cast<double>(tpcPin * bgScaling), par[0], par[1], par[2], par[3], par[4]);
+    double expSigma = expBethe * par[5];
+    return static_cast<float>((dEdx - expBethe) / expSigma);
+  }
+
+  /// nsigma corrected with the postcalibration maps
+  float postCalibNSigma(const int slot, const float tpcPin, const float tpcNCls, const float eta, const float tpcNSigma) const
+  {
+    const auto& meanMap = mMeanMaps[slot];
+    if (!hasPostCalibMaps(slot)) {
+      LOGP(fatal, "Postcalibration TPC PID maps not set for slot {}", slot);
+    }
+    const int binNCls = meanMap.findBin(0, tpcNCls);
+    const int binPin = meanMap.findBin(1, tpcPin);
+    const int binEta = meanMap.findBin(2, eta);
+    auto mean = meanMap.content(binNCls, binPin, binEta);
+    auto width = mSigmaMaps[slot].content(binNCls, binPin, binEta);
+    return (tpcNSigma - mean) / width;
+  }
+
+  /// Block evaluation
+
+  /// Registers a hypothesis to be evaluated by evaluate()
+  /// \return the column of the result buffer
+  int addColumn(const Method method, const int slot, const float mass = 0.f)
+  {
+    if (static_cast<int>(mColumns.size()) >= MaxColumns) {
+      LOGP(fatal, "Cannot register more than {} TPC recalibration columns", MaxColumns);
+    }
+    mColumns.push_back({method, slot, mass});
+    return static_cast<int>(mColumns.size()) - 1;
+  }
+
+  void clearColumns()
+  {
+    mColumns.clear();
+    mNRows = 0;
+    mResults.clear();
+  }
+
+  /// Evaluates all registered columns for every row of the table
+  /// \param tracks is the track table, with TPC extra and, for the postcalibration, the nsigma columns
+  /// \param getNSigma is called as getNSigma(track, slot) to get the nsigma from the AO2D for the postcalibration
+  template <typename TTracks, typename TNSigmaGetter>
+  void evaluate(TTracks const& tracks, TNSigmaGetter&& getNSigma)
+  {
+    const int nColumns = mColumns.size();
+    mNRows = tracks.size();
+    mResults.resize(static_cast<std::size_t>(mNRows) * nColumns);
+    if (nColumns == 0) {
+      return;
+    }
+
+    bool needsNSigma{false};
+    for (const auto& column : mColumns) {
+      if (column.method == Method::PostCalibration) {
+        if (!hasPostCalibMaps(column.slot)) {
+          LOGP(fatal, "Postcalibration TPC PID maps not set for slot {}", column.slot);
+        }
+        needsNSigma = true;
+      } else if (!hasBetheBloch(column.slot)) {
+        LOGP(fatal, "Bethe-Bloch parameterisation not set for slot {}", column.slot);
+      }
+    }
+
+    for (int64_t first{0}; first < mNRows; first += BlockSize) {
+      const int nInBlock = static_cast<int>(std::min<int64_t>(BlockSize, mNRows - first));
+
+      // gather the inputs of the block once for all columns
+      for (int iRow{0}; iRow < nInBlock; ++iRow) {
+        auto track = tracks.rawIteratorAt(first + iRow);
+        mBlock.tpcPin[iRow] = track.tpcInnerParam();
+        mBlock.dEdx[iRow] = track.tpcSignal();
+        mBlock.tpcNCls[iRow] = track.tpcNClsFound();
+        mBlock.eta[iRow] = track.eta();
+        if (needsNSigma) {
+          for (int iColumn{0}; iColumn < nColumns; ++iColumn) {
+            if (mColumns[iColumn].method == Method::PostCalibration) {
+              mBlock.nSigma[iColumn][iRow] = getNSigma(track, mColumns[iColumn].slot);
+            }
+          }
+        }
+      }
+
+      for (int iColumn{0}; iColumn < nColumns; ++iColumn) {
+        const auto& column = mColumns[iColumn];
+        float* out = mResults.data() + first * nColumns + iColumn;
+        if (column.method == Method::BetheBloch) {
+          for (int iRow{0}; iRow < nInBlock; ++iRow) {
+            out[iRow * nColumns] = betheBlochNSigma(column.slot, column.mass, mBlock.tpcPin[iRow], mBlock.dEdx[iRow]);
+          }
+        } else {
+          for (int iRow{0}; iRow < nInBlock; ++iRow) {
+            out[iRow * nColumns] = postCalibNSigma(column.slot, mBlock.tpcPin[iRow], mBlock.tpcNCls[iRow], mBlock.eta[iRow], mBlock.nSigma[iColumn][iRow]);
+          }
+        }
+      }
+    }
+  }
+
+  /// Whether the buffer holds the given row of the last evaluated table
+  bool hasRow(const int64_t row) const { return row >= 0 && row < mNRows && !mColumns.empty(); }
+  int64_t nRows() const { return mNRows; }
+  int nColumns() const { return static_cast<int>(mColumns.size()); }
+
+  /// Result of the last evaluate() for a row of the table and a registered column
+  float nSigma(const int64_t row, const int column) const { return mResults[row * mColumns.size() + column]; }
+
+ private:
+  struct Column {
+    Method method;
+    int slot;
+    float mass;
+  };
+
+  struct Block {
+    std::array<float, BlockSize> tpcPin{};
+    std::array<float, BlockSize> dEdx{};
+    std::array<float, BlockSize> tpcNCls{};
+    std::array<float, BlockSize> eta{};
+    std::array<std::array<float, BlockSize>, MaxColumns> nSigma{};
+  };
+
+  std::array<std::array<double, 6>, NSlots> mBetheBloch{}; // bb1, ..., bb5, resolution per slot
+  std::array<bool, NSlots> mHasBetheBloch{};
+  std::array<FlatMap3D, NSlots> mMeanMaps{};
+  std::array<FlatMap3D, NSlots> mSigmaMaps{};
+
+  std::vector<Column> mColumns{};
+  int64_t mNRows{0};
+  std::vector<float> mResults{}; // row-major, mColumns.size() values per row
+  Block mBlock{};
+};
+
+} // namespace o2::pid::tpc
+
+#endif // COMMON_CORE_PID_TPCRECALIBRATIONPROVIDER_H_
@@ -16,8 +16,6 @@
 
 #include <CCDB/BasicCCDBManager.h>
 #include <CommonConstants/LHCConstants.h>
-#include <CommonDataFormat/IRFrame.h>
-#include <CommonDataFormat/InteractionRecord.h>
 #include <CommonUtils/StringUtils.h>
 #include <Framework/HistogramRegistry.h>
 #include <Framework/HistogramSpec.h>
@@ -30,15 +28,16 @@
 #include <RtypesCore.h>
 
 #include <algorithm>
+#include <bit>
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
-using o2::InteractionRecord;
-
 namespace
 {
 int findBin(TH1* hist, const std::string& label)
@@ -191,7 +190,7 @@ std::vector<int> Zorro::initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber
   mInspectedTVX = mCCDB->getForRun<TH1D>(mBaseCCDBPath + "InspectedTVX", runNumber, true);
   setupHelpers(timestamp);
   mLastBCglobalId = 0;
-  mLastSelectedIdx = 0;
+  mLastSelectedIdx = std::numeric_limits<uint64_t>::max();
   mTOIs.clear();
   mTOIidx.clear();
   std::vector<std::string> tokens = o2::utils::Str::tokenize(tois, ','); // tokens are trimmed
@@ -216,45 +215,64 @@ std::vector<int> Zorro::initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber
   return mTOIidx;
 }
 
+size_t Zorro::findFirstOverlap(uint64_t bcMin, uint64_t bcMax) const
+{
+  /// Ranges are sorted by lower edge, the running maximum of the upper edges gives the first candidate overlapping [bcMin, bcMax]
+  size_t first = std::lower_bound(mBCrangeMaxPrefix.begin(), mBCrangeMaxPrefix.end(), bcMin) - mBCrangeMaxPrefix.begin();
+  for (size_t i = first; i < mBCrangeMin.size() && mBCrangeMin[i] <= bcMax; ++i) {
+    if (mBCrangeMax[i] >= bcMin) {
+      return i;
+    }
+  }
+  return mBCrangeMin.size();
+}
+
 std::bitset<128> Zorro::fetch(uint64_t bcGlobalId, uint64_t tolerance)
 {
   mLastResult.reset();
-  if (bcGlobalId < mBCranges.front().getMin().toLong() - tolerance || bcGlobalId > mBCranges.back().getMax().toLong() + tolerance) {
+  if (bcGlobalId < mBCrangeMin.front() - tolerance || bcGlobalId > mBCrangeMax.back() + tolerance) {
     setupHelpers((mOrbitResetTimestamp + static_cast<int64_t>(bcGlobalId * o2::constants::lhc::LHCBunchSpacingNS * 1e-3)) / 1000);
   }
 
-  o2::dataformats::IRFrame bcFrame{InteractionRecord::long2IR(bcGlobalId) - tolerance, InteractionRecord::long2IR(bcGlobalId) + tolerance};
-  if (bcGlobalId < mLastBCglobalId) { /// Handle the possible discontinuity in the BC processed by the analyses
-    mLastSelectedIdx = 0;
-  }
-  uint64_t lastSelectedIdx = mLastSelectedIdx;
+  const uint64_t bcMin{bcGlobalId > tolerance ? bcGlobalId - tolerance : 0};
+  const uint64_t bcMax{bcGlobalId + tolerance};
   mLastBCglobalId = bcGlobalId;
-  for (size_t i = mLastSelectedIdx; i < mBCranges.size(); i++) {
-    if (!mBCranges[i].isOutside(bcFrame)) {
-      for (int iMask{0}; iMask < 2; ++iMask) {
-        for (int iTOI{0}; iTOI < 64; ++iTOI) {
-          if (mZorroHelpers->at(i).selMask[iMask] & (1ull << iTOI)) {
-            mLastResult.set(iMask * 64 + iTOI, 1);
-            if (!mAccountedBCranges[i]) {
-              mATcounts[iMask * 64 + iTOI]++;
-              if (mAnalysedTriggers) {
-                mAnalysedTriggers->Fill(iMask * 64 + iTOI);
-              }
-            }
-          }
+  /// mLastSelectedIdx is the first range overlapping the BC window (or the number of ranges if none), used by isSelected to avoid double counting
+  mLastSelectedIdx = findFirstOverlap(bcMin, bcMax);
+  uint64_t selMask[2]{0ull, 0ull};
+  for (size_t i = mLastSelectedIdx; i < mBCrangeMin.size() && mBCrangeMin[i] <= bcMax; ++i) {
+    if (mBCrangeMax[i] < bcMin) {
+      continue;
+    }
+    for (int iMask{0}; iMask < 2; ++iMask) {
+      selMask[iMask] |= mBCrangeSelMask[i][iMask];
+      if (mAccountedBCranges[i]) {
+        continue;
+      }
+      for (uint64_t bits{mBCrangeSelMask[i][iMask]}; bits; bits &= bits - 1) {
+        const int iTrigger{iMask * 64 + std::countr_zero(bits)};
+        mATcounts[iTrigger]++;
+        if (mAnalysedTriggers) {
+          mAnalysedTriggers->Fill(iTrigger);
         }
       }
-      mAccountedBCranges[i] = true;
-      mLastSelectedIdx = mLastSelectedIdx == lastSelectedIdx-- ? i : mLastSelectedIdx; /// Decrease lastSelectedIdx to make sure this check is valid only in its first instance
-    } else if (mBCranges[i].getMax() < bcFrame.getMin()) {
-      mLastSelectedIdx = i;
-    } else if (mBCranges[i].getMin() > bcFrame.getMax()) {
-      break;
     }
+    mAccountedBCranges[i] = true;
   }
+  mLastResult = (std::bitset<128>(selMask[1]) << 64) | std::bitset<128>(selMask[0]);
   return mLastResult;
 }
 
+std::vector<std::bitset<128>> Zorro::fetchBatch(std::span<const uint64_t> bcGlobalIds, uint64_t tolerance)
+{
+  std::vector<std::bitset<128>> results;
+  results.reserve(bcGlobalIds.size());
+  for (const auto& bcGlobalId : bcGlobalIds) {
+    results.push_back(fetch(bcGlobalId, tolerance));
+  }
+  return results;
+}
+
 bool Zorro::isSelected(uint64_t bcGlobalId, uint64_t tolerance, TH2* ToiHisto)
 {
   uint64_t lastSelectedIdx = mLastSelectedIdx;
@@ -315,10 +333,16 @@ void Zorro::setupHelpers(int64_t timestamp)
   }
   mZorroHelpers = mCCDB->getSpecific<std::vector<ZorroHelper>>(mBaseCCDBPath + "ZorroHelpers", timestamp, {{"runNumber", std::to_string(mRunNumber)}});
   std::sort(mZorroHelpers->begin(), mZorroHelpers->end(), [](const auto& a, const auto& b) { return std::min(a.bcAOD, a.bcEvSel) < std::min(b.bcAOD, b.bcEvSel); });
-  mBCranges.clear();
+  mBCrangeMin.clear();
+  mBCrangeMax.clear();
+  mBCrangeMaxPrefix.clear();
+  mBCrangeSelMask.clear();
   mAccountedBCranges.clear();
   for (const auto& helper : *mZorroHelpers) {
-    mBCranges.emplace_back(InteractionRecord::long2IR(std::min(helper.bcAOD, helper.bcEvSel)), InteractionRecord::long2IR(std::max(helper.bcAOD, helper.bcEvSel)));
+    mBCrangeMin.push_back(std::min(helper.bcAOD, helper.bcEvSel));
+    mBCrangeMax.push_back(std::max(helper.bcAOD, helper.bcEvSel));
+    mBCrangeMaxPrefix.push_back(mBCrangeMaxPrefix.empty() ? mBCrangeMax.back() : std::max(mBCrangeMaxPrefix.back(), mBCrangeMax.back()));
+    mBCrangeSelMask.push_back({helper.selMask[0], helper.selMask[1]});
   }
-  mAccountedBCranges.resize(mBCranges.size(), false);
+  mAccountedBCranges.resize(mBCrangeMin.size(), false);
 }
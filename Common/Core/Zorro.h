@@ -22,14 +22,16 @@
 #include "ZorroHelper.h"
 #include "ZorroSummary.h"
 
-#include <CommonDataFormat/IRFrame.h>
 #include <Framework/HistogramRegistry.h>
 
 #include <TH1.h>
 #include <TH2.h>
 
+#include <array>
 #include <bitset>
 #include <cstdint>
+#include <limits>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,6 +50,7 @@ class Zorro
   Zorro() = default;
   std::vector<int> initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, uint64_t timestamp, std::string tois, int bcTolerance = 500);
   std::bitset<128> fetch(uint64_t bcGlobalId, uint64_t tolerance = 100);
+  std::vector<std::bitset<128>> fetchBatch(std::span<const uint64_t> bcGlobalIds, uint64_t tolerance = 100);
   bool isSelected(uint64_t bcGlobalId, uint64_t tolerance = 100, TH2* toiHisto = nullptr);
   bool isNotSelectedByAny(uint64_t bcGlobalId, uint64_t tolerance = 100);
 
@@ -72,6 +75,7 @@ class Zorro
 
  private:
   void setupHelpers(int64_t timestamp);
+  size_t findFirstOverlap(uint64_t bcMin, uint64_t bcMax) const;
 
   ZorroSummary mZorroSummary{"ZorroSummary", "ZorroSummary"};
 
@@ -88,13 +92,16 @@ class Zorro
 
   int mBCtolerance = 100;
   uint64_t mLastBCglobalId = 0;
-  uint64_t mLastSelectedIdx = 0;
+  uint64_t mLastSelectedIdx = std::numeric_limits<uint64_t>::max();
   TH1D* mScalers = nullptr;
   TH1D* mSelections = nullptr;
   TH1D* mInspectedTVX = nullptr;
   std::bitset<128> mLastResult;
   std::vector<bool> mAccountedBCranges; /// Avoid double accounting of inspected BC ranges
-  std::vector<o2::dataformats::IRFrame> mBCranges;
+  std::vector<uint64_t> mBCrangeMin;    /// BC ranges of the helpers, sorted by lower edge
+  std::vector<uint64_t> mBCrangeMax;
+  std::vector<uint64_t> mBCrangeMaxPrefix;              /// Running maximum of the upper edges, for the binary search of the first overlapping range
+  std::vector<std::array<uint64_t, 2>> mBCrangeSelMask; /// Selection masks of the BC ranges
   std::vector<ZorroHelper>* mZorroHelpers = nullptr;
   std::vector<std::string> mTOIs;
   std::vector<int> mTOIidx;
@@ -28,6 +28,7 @@
 #include "Common/DataModel/PIDResponseTOF.h"
 
 #include <CCDB/BasicCCDBManager.h>
+#include <CommonConstants/PhysicsConstants.h>
 #include <Framework/ASoA.h>
 #include <Framework/AnalysisDataModel.h>
 #include <Framework/AnalysisHelpers.h>
@@ -53,6 +54,7 @@
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace o2;
@@ -633,6 +635,7 @@ struct tofPidMerge {
       o2::common::core::enableFlagIfTableRequired(initContext, "pidTOF" + particleNames[i], f);
       if (f == 1) {
         mEnabledParticles.push_back(i);
+        mIsEnabled[i] = true;
       }
 
       // Then checking full tables
@@ -640,6 +643,7 @@ struct tofPidMerge {
       o2::common::core::enableFlagIfTableRequired(initContext, "pidTOFFull" + particleNames[i], f);
       if (f == 1) {
         mEnabledParticlesFull.push_back(i);
+        mIsEnabledFull[i] = true;
       }
     }
     if (mEnabledParticlesFull.size() == 0 && mEnabledParticles.size() == 0) {
@@ -880,164 +884,183 @@ struct tofPidMerge {
 
   template <o2::track::PID::ID pid>
   using ResponseImplementation = o2::pid::tof::ExpTimes<Run3TrksWtofWevTime::iterator, pid>;
-  void processRun3(Run3TrksWtofWevTime const& tracks,
-                   aod::Collisions const& collisions,
-                   aod::BCsWithTimestamps const& bcs)
-  {
-    constexpr auto responseEl = ResponseImplementation<PID::Electron>();
-    constexpr auto responseMu = ResponseImplementation<PID::Muon>();
-    constexpr auto responsePi = ResponseImplementation<PID::Pion>();
-    constexpr auto responseKa = ResponseImplementation<PID::Kaon>();
-    constexpr auto responsePr = ResponseImplementation<PID::Proton>();
-    constexpr auto responseDe = ResponseImplementation<PID::Deuteron>();
-    constexpr auto responseTr = ResponseImplementation<PID::Triton>();
-    constexpr auto responseHe = ResponseImplementation<PID::Helium3>();
-    constexpr auto responseAl = ResponseImplementation<PID::Alpha>();
 
-    tofResponse->processSetup(bcs.iteratorAt(0)); // Update the calibration parameters
+  // Columnar nsigma kernel for Run 3: the track columns and the species-independent terms
+  // (momentum, shifted expected momentum, time shift, event time) are read once per track into
+  // blocks, then all the enabled species are evaluated on the block and written to their tables
+  static constexpr int kBlockSize = 256;
+  struct NSigmaBlock {
+    std::array<bool, kBlockSize> hasCollision;
+    std::array<bool, kBlockSize> hasTOF;
+    std::array<float, kBlockSize> tofSignal;
+    std::array<float, kBlockSize> evTime;
+    std::array<float, kBlockSize> evTimeErr;
+    std::array<float, kBlockSize> mom;
+    std::array<float, kBlockSize> eta;
+    std::array<float, kBlockSize> length;
+    std::array<float, kBlockSize> expMom;    // TOF expected momentum corrected for the momentum shift
+    std::array<float, kBlockSize> timeShift; // eta dependent time shift of the expected time
+    std::array<std::array<float, kBlockSize>, nSpecies> resolution;
+    std::array<std::array<float, kBlockSize>, nSpecies> nsigma;
+  };
+  NSigmaBlock mBlock;
+  std::array<bool, nSpecies> mIsEnabled{};     // Enabled PID hypotheses for tiny tables, indexed by particle ID
+  std::array<bool, nSpecies> mIsEnabledFull{}; // Enabled PID hypotheses for full tables, indexed by particle ID
+
+  template <o2::track::PID::ID id>
+  auto& tinyTable()
+  {
+    if constexpr (id == PID::Electron) {
+      return tablePIDEl;
+    } else if constexpr (id == PID::Muon) {
+      return tablePIDMu;
+    } else if constexpr (id == PID::Pion) {
+      return tablePIDPi;
+    } else if constexpr (id == PID::Kaon) {
+      return tablePIDKa;
+    } else if constexpr (id == PID::Proton) {
+      return tablePIDPr;
+    } else if constexpr (id == PID::Deuteron) {
+      return tablePIDDe;
+    } else if constexpr (id == PID::Triton) {
+      return tablePIDTr;
+    } else if constexpr (id == PID::Helium3) {
+      return tablePIDHe;
+    } else {
+      return tablePIDAl;
+    }
+  }
 
-    for (auto const& pidId : mEnabledParticles) {
-      reserveTable(pidId, tracks.size(), false);
+  template <o2::track::PID::ID id>
+  auto& fullTable()
+  {
+    if constexpr (id == PID::Electron) {
+      return tablePIDFullEl;
+    } else if constexpr (id == PID::Muon) {
+      return tablePIDFullMu;
+    } else if constexpr (id == PID::Pion) {
+      return tablePIDFullPi;
+    } else if constexpr (id == PID::Kaon) {
+      return tablePIDFullKa;
+    } else if constexpr (id == PID::Proton) {
+      return tablePIDFullPr;
+    } else if constexpr (id == PID::Deuteron) {
+      return tablePIDFullDe;
+    } else if constexpr (id == PID::Triton) {
+      return tablePIDFullTr;
+    } else if constexpr (id == PID::Helium3) {
+      return tablePIDFullHe;
+    } else {
+      return tablePIDFullAl;
     }
+  }
 
-    for (auto const& pidId : mEnabledParticlesFull) {
-      reserveTable(pidId, tracks.size(), true);
+  // Loads the columns of a track and its species-independent terms in the block
+  void loadTrack(Run3TrksWtofWevTime::iterator const& trk, const bool hasCollision, const int i)
+  {
+    mBlock.hasCollision[i] = hasCollision;
+    if (!hasCollision) {
+      return;
+    }
+    mBlock.hasTOF[i] = trk.hasTOF();
+    mBlock.tofSignal[i] = trk.tofSignal();
+    mBlock.evTime[i] = trk.tofEvTime();
+    mBlock.evTimeErr[i] = trk.tofEvTimeErr();
+    mBlock.mom[i] = trk.p();
+    mBlock.eta[i] = trk.eta();
+    if (!mBlock.hasTOF[i]) {
+      return;
+    }
+    mBlock.length[i] = trk.length();
+    // Same as ExpTimes::GetCorrectedExpectedSignal
+    if (trk.trackType() == o2::aod::track::Run2Track) {
+      mBlock.expMom[i] = trk.tofExpMom() * o2::constants::physics::invLightSpeedCm2PS / (1.f + trk.sign() * tofResponse->parameters.getMomentumChargeShift(mBlock.eta[i]));
+      mBlock.timeShift[i] = 0.f;
+    } else {
+      mBlock.expMom[i] = trk.tofExpMom() / (1.f + trk.sign() * tofResponse->parameters.getMomentumChargeShift(mBlock.eta[i]));
+      mBlock.timeShift[i] = tofResponse->parameters.getTimeShift(mBlock.eta[i], trk.sign());
     }
+  }
 
-    float resolution = 1.f; // Last resolution assigned
-    float nsigma = 0;
-    for (auto const& trk : tracks) { // Loop on all tracks
-      if (!trk.has_collision() || collisions.size() == 0) { // Track was not assigned, cannot compute NSigma (no event time) -> filling with empty table
-        for (auto const& pidId : mEnabledParticles) {
-          makeTableEmpty(pidId, false);
-        }
-        for (auto const& pidId : mEnabledParticlesFull) {
-          makeTableEmpty(pidId, true);
-        }
+  // Evaluates one species on the block and fills its tables, same as ExpTimes::GetExpectedSigma and ExpTimes::GetSeparation
+  template <o2::track::PID::ID id>
+  void processSpeciesBlock(const int nTracks)
+  {
+    if (!mIsEnabled[id] && !mIsEnabledFull[id]) {
+      return;
+    }
+    using Response = ResponseImplementation<id>;
+    auto& resolution = mBlock.resolution[id];
+    auto& nsigma = mBlock.nsigma[id];
+    for (int i = 0; i < nTracks; i++) {
+      if (!mBlock.hasCollision[i]) {
         continue;
       }
+      resolution[i] = Response::GetExpectedSigma(tofResponse->parameters, mBlock.mom[i], mBlock.eta[i], mBlock.tofSignal[i], mBlock.evTimeErr[i]);
+      nsigma[i] = mBlock.hasTOF[i] ? (mBlock.tofSignal[i] - mBlock.evTime[i] - (Response::ComputeExpectedTime(mBlock.expMom[i], mBlock.length[i]) + mBlock.timeShift[i])) / resolution[i] : o2::pid::tof::defaultReturnValue;
+    }
 
-      for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
-        switch (pidId) {
-          case kIdxEl: {
-            nsigma = responseEl.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDEl);
-            break;
-          }
-          case kIdxMu: {
-            nsigma = responseMu.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDMu);
-            break;
-          }
-          case kIdxPi: {
-            nsigma = responsePi.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDPi);
-            break;
-          }
-          case kIdxKa: {
-            nsigma = responseKa.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDKa);
-            break;
-          }
-          case kIdxPr: {
-            nsigma = responsePr.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDPr);
-            break;
-          }
-          case kIdxDe: {
-            nsigma = responseDe.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDDe);
-            break;
-          }
-          case kIdxTr: {
-            nsigma = responseTr.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDTr);
-            break;
-          }
-          case kIdxHe: {
-            nsigma = responseHe.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDHe);
-            break;
-          }
-          case kIdxAl: {
-            nsigma = responseAl.GetSeparation(tofResponse->parameters, trk);
-            aod::pidtof_tiny::binning::packInTable(nsigma, tablePIDAl);
-            break;
-          }
-          default:
-            LOG(fatal) << "Wrong particle ID for standard tables";
-            break;
+    if (mIsEnabled[id]) {
+      auto& table = tinyTable<id>();
+      for (int i = 0; i < nTracks; i++) {
+        if (!mBlock.hasCollision[i]) { // Track was not assigned, cannot compute NSigma (no event time) -> filling with empty table
+          aod::pidtof_tiny::binning::packInTable(-999.f, table);
+          continue;
         }
+        aod::pidtof_tiny::binning::packInTable(nsigma[i], table);
         if (enableQaHistograms) {
-          hnsigma[pidId]->Fill(trk.p(), nsigma);
+          hnsigma[id]->Fill(mBlock.mom[i], nsigma[i]);
         }
       }
-      for (auto const& pidId : mEnabledParticlesFull) { // Loop on enabled particle hypotheses with full tables
-        switch (pidId) {
-          case kIdxEl: {
-            resolution = responseEl.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responseEl.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullEl(resolution, nsigma);
-            break;
-          }
-          case kIdxMu: {
-            resolution = responseMu.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responseMu.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullMu(resolution, nsigma);
-            break;
-          }
-          case kIdxPi: {
-            resolution = responsePi.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responsePi.GetSeparation(tofResponse->parameters, trk);
-            tablePIDFullPi(resolution, nsigma);
-            break;
-          }
-          case kIdxKa: {
-            resolution = responseKa.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responseKa.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullKa(resolution, nsigma);
-            break;
-          }
-          case kIdxPr: {
-            resolution = responsePr.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responsePr.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullPr(resolution, nsigma);
-            break;
-          }
-          case kIdxDe: {
-            resolution = responseDe.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responseDe.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullDe(resolution, nsigma);
-            break;
-          }
-          case kIdxTr: {
-            resolution = responseTr.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responseTr.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullTr(resolution, nsigma);
-            break;
-          }
-          case kIdxHe: {
-            resolution = responseHe.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responseHe.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullHe(resolution, nsigma);
-            break;
-          }
-          case kIdxAl: {
-            resolution = responseAl.GetExpectedSigma(tofResponse->parameters, trk);
-            nsigma = responseAl.GetSeparation(tofResponse->parameters, trk, resolution);
-            tablePIDFullAl(resolution, nsigma);
-            break;
-          }
-          default:
-            LOG(fatal) << "Wrong particle ID for full tables";
-            break;
+    }
+    if (mIsEnabledFull[id]) {
+      auto& table = fullTable<id>();
+      for (int i = 0; i < nTracks; i++) {
+        if (!mBlock.hasCollision[i]) {
+          table(-999.f, -999.f);
+          continue;
         }
+        table(resolution[i], nsigma[i]);
         if (enableQaHistograms) {
-          hnsigmaFull[pidId]->Fill(trk.p(), nsigma);
+          hnsigmaFull[id]->Fill(mBlock.mom[i], nsigma[i]);
         }
       }
     }
   }
+
+  template <o2::track::PID::ID... ids>
+  void processBlock(const int nTracks, std::integer_sequence<o2::track::PID::ID, ids...>)
+  {
+    (processSpeciesBlock<ids>(nTracks), ...);
+  }
+
+  void processRun3(Run3TrksWtofWevTime const& tracks,
+                   aod::Collisions const& collisions,
+                   aod::BCsWithTimestamps const& bcs)
+  {
+    tofResponse->processSetup(bcs.iteratorAt(0)); // Update the calibration parameters
+
+    for (auto const& pidId : mEnabledParticles) {
+      reserveTable(pidId, tracks.size(), false);
+    }
+
+    for (auto const& pidId : mEnabledParticlesFull) {
+      reserveTable(pidId, tracks.size(), true);
+    }
+
+    constexpr auto allSpecies = std::make_integer_sequence<o2::track::PID::ID, nSpecies>();
+    int nTracksInBlock = 0;
+    for (auto const& trk : tracks) { // Loop on all tracks
+      loadTrack(trk, trk.has_collision() && collisions.size() != 0, nTracksInBlock);
+      if (++nTracksInBlock == kBlockSize) {
+        processBlock(nTracksInBlock, allSpecies);
+        nTracksInBlock = 0;
+      }
+    }
+    if (nTracksInBlock > 0) {
+      processBlock(nTracksInBlock, allSpecies);
+    }
+  }
   PROCESS_SWITCH(tofPidMerge, processRun3, "Produce Run 3 Nsigma table. Set to off if the tables are not required, or autoset is on", false);
 
   template <o2::track::PID::ID pid>
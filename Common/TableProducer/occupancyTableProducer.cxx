@@ -166,6 +166,40 @@ struct OccupancyTableProducer {
   std::vector<std::vector<float>> occMultNTracksITSTPCUnfm80;
   std::vector<std::vector<float>> occMultAllTracksTPCOnlyUnfm80;
 
+  // drift-window accumulation through difference arrays, one contiguous [TF][detector][bin] buffer
+  enum OccDetector {
+    kOccPrim = 0,
+    kOccFV0A,
+    kOccFV0C,
+    kOccFT0A,
+    kOccFT0C,
+    kOccFDDA,
+    kOccFDDC,
+    kOccNTrackITS,
+    kOccNTrackTPC,
+    kOccNTrackTRD,
+    kOccNTrackTOF,
+    kOccNTrackSize,
+    kOccNTrackTPCA,
+    kOccNTrackTPCC,
+    kOccNTrackITSTPC,
+    kOccNTrackITSTPCA,
+    kOccNTrackITSTPCC,
+    kOccMultNTracksHasITS,
+    kOccMultNTracksHasTPC,
+    kOccMultNTracksHasTOF,
+    kOccMultNTracksHasTRD,
+    kOccMultNTracksITSOnly,
+    kOccMultNTracksTPCOnly,
+    kOccMultNTracksITSTPC,
+    kOccMultAllTracksTPCOnly,
+    kNOccDetectors
+  };
+  std::vector<double> occDiffBuffer;
+  std::array<std::vector<std::vector<float>>*, kNOccDetectors> occDetVectors{};
+  std::array<bool, kNOccDetectors> occDetFilled{};
+  std::vector<int> bcOccSlot; // TF slot of the collisions in a given BC, -1 if none
+
   std::vector<float> vecRobustOccT0V0PrimUnfm80;
   std::vector<float> vecRobustOccFDDT0V0PrimUnfm80;
   std::vector<float> vecRobustOccNtrackDetUnfm80;
@@ -267,6 +301,9 @@ struct OccupancyTableProducer {
       }
     }
 
+    occDetVectors = {&occPrimUnfm80, &occFV0AUnfm80, &occFV0CUnfm80, &occFT0AUnfm80, &occFT0CUnfm80, &occFDDAUnfm80, &occFDDCUnfm80, &occNTrackITSUnfm80, &occNTrackTPCUnfm80, &occNTrackTRDUnfm80, &occNTrackTOFUnfm80, &occNTrackSizeUnfm80, &occNTrackTPCAUnfm80, &occNTrackTPCCUnfm80, &occNTrackITSTPCUnfm80, &occNTrackITSTPCAUnfm80, &occNTrackITSTPCCUnfm80, &occMultNTracksHasITSUnfm80, &occMultNTracksHasTPCUnfm80, &occMultNTracksHasTOFUnfm80, &occMultNTracksHasTRDUnfm80, &occMultNTracksITSOnlyUnfm80, &occMultNTracksTPCOnlyUnfm80, &occMultNTracksITSTPCUnfm80, &occMultAllTracksTPCOnlyUnfm80};
+    occDiffBuffer.assign(static_cast<size_t>(occVecArraySize) * kNOccDetectors * (nBCinTF / bcGrouping + 1), 0.);
+
     if (buildFullOccTableProducer || buildOnlyOccsT0V0Prim || buildFlag02OccRobustTable || buildFlag03OccMeanRobustTable) {
       vecRobustOccT0V0PrimUnfm80.resize(nBCinTF / bcGrouping);
       vecRobustOccT0V0PrimUnfm80medianPosVec.resize(nBCinTF / bcGrouping); // Median => one for odd and two for even entries
@@ -305,6 +342,52 @@ struct OccupancyTableProducer {
     std::transform(OriginalVec.begin(), OriginalVec.end(), OriginalVec.begin(), [scaleFactor](float x) { return x * scaleFactor; });
   }
 
+  // add value to all bins of the drift window starting at firstBin (wrapping around the TF) in O(1)
+  void addToDriftWindow(int tfSlot, int det, int firstBin, double value)
+  {
+    const int nBins = nBCinTF / bcGrouping;
+    const int nDriftBins = nBCinDrift / bcGrouping;
+    double* diff = &occDiffBuffer[(static_cast<size_t>(tfSlot) * kNOccDetectors + det) * (nBins + 1)];
+    const int nTurns = nDriftBins / nBins; // drift window longer than the TF, not the case for default settings
+    if (nTurns > 0) {
+      diff[0] += nTurns * value;
+      diff[nBins] -= nTurns * value;
+    }
+    const int start = firstBin % nBins;
+    const int end = start + nDriftBins % nBins;
+    diff[start] += value;
+    if (end <= nBins) {
+      diff[end] -= value;
+    } else {
+      diff[nBins] -= value;
+      diff[0] += value;
+      diff[end - nBins] -= value;
+    }
+    occDetFilled[det] = true;
+  }
+
+  // prefix-sum the difference arrays into the per-TF occupancy vectors and reset them for the next dataframe
+  void integrateDriftWindows(uint nTFs)
+  {
+    const int nBins = nBCinTF / bcGrouping;
+    for (int det = 0; det < kNOccDetectors; det++) {
+      if (!occDetFilled[det]) {
+        continue;
+      }
+      for (uint tfSlot = 0; tfSlot < nTFs; tfSlot++) {
+        double* diff = &occDiffBuffer[(static_cast<size_t>(tfSlot) * kNOccDetectors + det) * (nBins + 1)];
+        auto& occVec = (*occDetVectors[det])[tfSlot];
+        double sum = 0.;
+        for (int bin = 0; bin < nBins; bin++) {
+          sum += diff[bin];
+          occVec[bin] = sum;
+        }
+        std::fill(diff, diff + nBins + 1, 0.);
+      }
+      occDetFilled[det] = false;
+    }
+  }
+
   template <typename... Vecs>
   void getMedianOccVect(
     std::vector<float>& medianVector,
@@ -481,44 +564,8 @@ struct OccupancyTableProducer {
       for (int i = 0; i < occVecArraySize; i++) {
         tfList[i] = -1;
         bcTFMap[i].clear(); // list of BCs used in one time frame;
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccPrim || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-          std::fill(occPrimUnfm80[i].begin(), occPrimUnfm80[i].end(), 0.);
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim) {
-          std::fill(occFV0AUnfm80[i].begin(), occFV0AUnfm80[i].end(), 0.);
-          std::fill(occFV0CUnfm80[i].begin(), occFV0CUnfm80[i].end(), 0.);
-          std::fill(occFT0AUnfm80[i].begin(), occFT0AUnfm80[i].end(), 0.);
-          std::fill(occFT0CUnfm80[i].begin(), occFT0CUnfm80[i].end(), 0.);
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccFDDT0V0Prim) {
-          std::fill(occFDDAUnfm80[i].begin(), occFDDAUnfm80[i].end(), 0.);
-          std::fill(occFDDCUnfm80[i].begin(), occFDDCUnfm80[i].end(), 0.);
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet) {
-          std::fill(occNTrackITSUnfm80[i].begin(), occNTrackITSUnfm80[i].end(), 0.);
-          std::fill(occNTrackTPCUnfm80[i].begin(), occNTrackTPCUnfm80[i].end(), 0.);
-          std::fill(occNTrackTRDUnfm80[i].begin(), occNTrackTRDUnfm80[i].end(), 0.);
-          std::fill(occNTrackTOFUnfm80[i].begin(), occNTrackTOFUnfm80[i].end(), 0.);
-          std::fill(occNTrackSizeUnfm80[i].begin(), occNTrackSizeUnfm80[i].end(), 0.);
-          std::fill(occNTrackTPCAUnfm80[i].begin(), occNTrackTPCAUnfm80[i].end(), 0.);
-          std::fill(occNTrackTPCCUnfm80[i].begin(), occNTrackTPCCUnfm80[i].end(), 0.);
-          std::fill(occNTrackITSTPCAUnfm80[i].begin(), occNTrackITSTPCAUnfm80[i].end(), 0.);
-          std::fill(occNTrackITSTPCCUnfm80[i].begin(), occNTrackITSTPCCUnfm80[i].end(), 0.);
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-          std::fill(occNTrackITSTPCUnfm80[i].begin(), occNTrackITSTPCUnfm80[i].end(), 0.);
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccMultExtra) {
-          std::fill(occMultNTracksHasITSUnfm80[i].begin(), occMultNTracksHasITSUnfm80[i].end(), 0.);
-          std::fill(occMultNTracksHasTPCUnfm80[i].begin(), occMultNTracksHasTPCUnfm80[i].end(), 0.);
-          std::fill(occMultNTracksHasTOFUnfm80[i].begin(), occMultNTracksHasTOFUnfm80[i].end(), 0.);
-          std::fill(occMultNTracksHasTRDUnfm80[i].begin(), occMultNTracksHasTRDUnfm80[i].end(), 0.);
-          std::fill(occMultNTracksITSOnlyUnfm80[i].begin(), occMultNTracksITSOnlyUnfm80[i].end(), 0.);
-          std::fill(occMultNTracksTPCOnlyUnfm80[i].begin(), occMultNTracksTPCOnlyUnfm80[i].end(), 0.);
-          std::fill(occMultNTracksITSTPCUnfm80[i].begin(), occMultNTracksITSTPCUnfm80[i].end(), 0.);
-          std::fill(occMultAllTracksTPCOnlyUnfm80[i].begin(), occMultAllTracksTPCOnlyUnfm80[i].end(), 0.);
-        }
       }
+      bcOccSlot.assign(BCs.size(), -1);
 
       std::vector<int64_t> tfIDList;
       int nTrackITS = 0;
@@ -547,36 +594,6 @@ struct OccupancyTableProducer {
       int fNTrackITSTPCA = -9999;
       int fNTrackITSTPCC = -9999;
 
-      decltype(&occPrimUnfm80[0]) tfOccPrimUnfm80 = nullptr;
-      decltype(&occFV0AUnfm80[0]) tfOccFV0AUnfm80 = nullptr;
-      decltype(&occFV0CUnfm80[0]) tfOccFV0CUnfm80 = nullptr;
-      decltype(&occFT0AUnfm80[0]) tfOccFT0AUnfm80 = nullptr;
-      decltype(&occFT0CUnfm80[0]) tfOccFT0CUnfm80 = nullptr;
-
-      decltype(&occFDDAUnfm80[0]) tfOccFDDAUnfm80 = nullptr;
-      decltype(&occFDDCUnfm80[0]) tfOccFDDCUnfm80 = nullptr;
-
-      decltype(&occNTrackITSTPCUnfm80[0]) tfOccNTrackITSTPCUnfm80 = nullptr;
-
-      decltype(&occNTrackITSUnfm80[0]) tfOccNTrackITSUnfm80 = nullptr;
-      decltype(&occNTrackTPCUnfm80[0]) tfOccNTrackTPCUnfm80 = nullptr;
-      decltype(&occNTrackTRDUnfm80[0]) tfOccNTrackTRDUnfm80 = nullptr;
-      decltype(&occNTrackTOFUnfm80[0]) tfOccNTrackTOFUnfm80 = nullptr;
-      decltype(&occNTrackSizeUnfm80[0]) tfOccNTrackSizeUnfm80 = nullptr;
-      decltype(&occNTrackTPCAUnfm80[0]) tfOccNTrackTPCAUnfm80 = nullptr;
-      decltype(&occNTrackTPCCUnfm80[0]) tfOccNTrackTPCCUnfm80 = nullptr;
-      decltype(&occNTrackITSTPCAUnfm80[0]) tfOccNTrackITSTPCAUnfm80 = nullptr;
-      decltype(&occNTrackITSTPCCUnfm80[0]) tfOccNTrackITSTPCCUnfm80 = nullptr;
-
-      decltype(&occMultNTracksHasITSUnfm80[0]) tfOccMultNTracksHasITSUnfm80 = nullptr;
-      decltype(&occMultNTracksHasTPCUnfm80[0]) tfOccMultNTracksHasTPCUnfm80 = nullptr;
-      decltype(&occMultNTracksHasTOFUnfm80[0]) tfOccMultNTracksHasTOFUnfm80 = nullptr;
-      decltype(&occMultNTracksHasTRDUnfm80[0]) tfOccMultNTracksHasTRDUnfm80 = nullptr;
-      decltype(&occMultNTracksITSOnlyUnfm80[0]) tfOccMultNTracksITSOnlyUnfm80 = nullptr;
-      decltype(&occMultNTracksTPCOnlyUnfm80[0]) tfOccMultNTracksTPCOnlyUnfm80 = nullptr;
-      decltype(&occMultNTracksITSTPCUnfm80[0]) tfOccMultNTracksITSTPCUnfm80 = nullptr;
-      decltype(&occMultAllTracksTPCOnlyUnfm80[0]) tfOccMultAllTracksTPCOnlyUnfm80 = nullptr;
-
       for (const auto& collision : collisions) {
         const auto& bc = collision.template bc_as<B>();
         getTimingInfo(bc, lastRun, nBCsPerTF, bcSOR, time, tfIdThis, bcInTF);
@@ -649,43 +666,7 @@ struct OccupancyTableProducer {
         }
 
         bcTFMap[tfIDX].push_back(bc.globalIndex());
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccPrim || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-          tfOccPrimUnfm80 = &occPrimUnfm80[tfIDX];
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim) {
-          tfOccFV0AUnfm80 = &occFV0AUnfm80[tfIDX];
-          tfOccFV0CUnfm80 = &occFV0CUnfm80[tfIDX];
-          tfOccFT0AUnfm80 = &occFT0AUnfm80[tfIDX];
-          tfOccFT0CUnfm80 = &occFT0CUnfm80[tfIDX];
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccFDDT0V0Prim) {
-          tfOccFDDAUnfm80 = &occFDDAUnfm80[tfIDX];
-          tfOccFDDCUnfm80 = &occFDDCUnfm80[tfIDX];
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet) {
-          tfOccNTrackITSUnfm80 = &occNTrackITSUnfm80[tfIDX];
-          tfOccNTrackTPCUnfm80 = &occNTrackTPCUnfm80[tfIDX];
-          tfOccNTrackTRDUnfm80 = &occNTrackTRDUnfm80[tfIDX];
-          tfOccNTrackTOFUnfm80 = &occNTrackTOFUnfm80[tfIDX];
-          tfOccNTrackSizeUnfm80 = &occNTrackSizeUnfm80[tfIDX];
-          tfOccNTrackTPCAUnfm80 = &occNTrackTPCAUnfm80[tfIDX];
-          tfOccNTrackTPCCUnfm80 = &occNTrackTPCCUnfm80[tfIDX];
-          tfOccNTrackITSTPCAUnfm80 = &occNTrackITSTPCAUnfm80[tfIDX];
-          tfOccNTrackITSTPCCUnfm80 = &occNTrackITSTPCCUnfm80[tfIDX];
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-          tfOccNTrackITSTPCUnfm80 = &occNTrackITSTPCUnfm80[tfIDX];
-        }
-        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccMultExtra) {
-          tfOccMultNTracksHasITSUnfm80 = &occMultNTracksHasITSUnfm80[tfIDX];
-          tfOccMultNTracksHasTPCUnfm80 = &occMultNTracksHasTPCUnfm80[tfIDX];
-          tfOccMultNTracksHasTOFUnfm80 = &occMultNTracksHasTOFUnfm80[tfIDX];
-          tfOccMultNTracksHasTRDUnfm80 = &occMultNTracksHasTRDUnfm80[tfIDX];
-          tfOccMultNTracksITSOnlyUnfm80 = &occMultNTracksITSOnlyUnfm80[tfIDX];
-          tfOccMultNTracksTPCOnlyUnfm80 = &occMultNTracksTPCOnlyUnfm80[tfIDX];
-          tfOccMultNTracksITSTPCUnfm80 = &occMultNTracksITSTPCUnfm80[tfIDX];
-          tfOccMultAllTracksTPCOnlyUnfm80 = &occMultAllTracksTPCOnlyUnfm80[tfIDX];
-        }
+        bcOccSlot[bc.globalIndex()] = tfIDX;
 
         // current collision bin in 80/160 bcGrouping.
         int bin80Zero = bcInTF / bcGrouping;
@@ -718,50 +699,47 @@ struct OccupancyTableProducer {
           fNTrackITSTPCA = nTrackITSTPCA;
           fNTrackITSTPCC = nTrackITSTPCC;
         }
-        // Processing for bcGrouping of 80 BCs
-        for (int deltaBin = 0; deltaBin < nBCinDrift / bcGrouping; deltaBin++) {
-
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccPrim || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-            (*tfOccPrimUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNumContrib * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim) {
-            (*tfOccFV0AUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFV0A * 1;
-            (*tfOccFV0CUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFV0C * 1;
-            (*tfOccFT0AUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFT0A * 1;
-            (*tfOccFT0CUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFT0C * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccFDDT0V0Prim) {
-            (*tfOccFDDAUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFDDA * 1;
-            (*tfOccFDDCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFDDC * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet) {
-            (*tfOccNTrackITSUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITS * 1;
-            (*tfOccNTrackTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTPC * 1;
-            (*tfOccNTrackTRDUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTRD * 1;
-            (*tfOccNTrackTOFUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTOF * 1;
-            (*tfOccNTrackSizeUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackSize * 1;
-            (*tfOccNTrackTPCAUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTPCA * 1;
-            (*tfOccNTrackTPCCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTPCC * 1;
-            (*tfOccNTrackITSTPCAUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITSTPCA * 1;
-            (*tfOccNTrackITSTPCCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITSTPCC * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-            (*tfOccNTrackITSTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITSTPC * 1;
-          }
-
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccMultExtra) {
-            (*tfOccMultNTracksHasITSUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasITS() * 1;
-            (*tfOccMultNTracksHasTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasTPC() * 1;
-            (*tfOccMultNTracksHasTOFUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasTOF() * 1;
-            (*tfOccMultNTracksHasTRDUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasTRD() * 1;
-            (*tfOccMultNTracksITSOnlyUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksITSOnly() * 1;
-            (*tfOccMultNTracksTPCOnlyUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksTPCOnly() * 1;
-            (*tfOccMultNTracksITSTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksITSTPC() * 1;
-            (*tfOccMultAllTracksTPCOnlyUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multAllTracksTPCOnly() * 1;
-          }
+        // Processing for bcGrouping of 80 BCs: the collision contributes to all bins of its drift window
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccPrim || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
+          addToDriftWindow(tfIDX, kOccPrim, bin80Zero, fNumContrib);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim) {
+          addToDriftWindow(tfIDX, kOccFV0A, bin80Zero, fMultFV0A);
+          addToDriftWindow(tfIDX, kOccFV0C, bin80Zero, fMultFV0C);
+          addToDriftWindow(tfIDX, kOccFT0A, bin80Zero, fMultFT0A);
+          addToDriftWindow(tfIDX, kOccFT0C, bin80Zero, fMultFT0C);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccFDDT0V0Prim) {
+          addToDriftWindow(tfIDX, kOccFDDA, bin80Zero, fMultFDDA);
+          addToDriftWindow(tfIDX, kOccFDDC, bin80Zero, fMultFDDC);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet) {
+          addToDriftWindow(tfIDX, kOccNTrackITS, bin80Zero, fNTrackITS);
+          addToDriftWindow(tfIDX, kOccNTrackTPC, bin80Zero, fNTrackTPC);
+          addToDriftWindow(tfIDX, kOccNTrackTRD, bin80Zero, fNTrackTRD);
+          addToDriftWindow(tfIDX, kOccNTrackTOF, bin80Zero, fNTrackTOF);
+          addToDriftWindow(tfIDX, kOccNTrackSize, bin80Zero, fNTrackSize);
+          addToDriftWindow(tfIDX, kOccNTrackTPCA, bin80Zero, fNTrackTPCA);
+          addToDriftWindow(tfIDX, kOccNTrackTPCC, bin80Zero, fNTrackTPCC);
+          addToDriftWindow(tfIDX, kOccNTrackITSTPCA, bin80Zero, fNTrackITSTPCA);
+          addToDriftWindow(tfIDX, kOccNTrackITSTPCC, bin80Zero, fNTrackITSTPCC);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
+          addToDriftWindow(tfIDX, kOccNTrackITSTPC, bin80Zero, fNTrackITSTPC);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccMultExtra) {
+          addToDriftWindow(tfIDX, kOccMultNTracksHasITS, bin80Zero, collision.multNTracksHasITS());
+          addToDriftWindow(tfIDX, kOccMultNTracksHasTPC, bin80Zero, collision.multNTracksHasTPC());
+          addToDriftWindow(tfIDX, kOccMultNTracksHasTOF, bin80Zero, collision.multNTracksHasTOF());
+          addToDriftWindow(tfIDX, kOccMultNTracksHasTRD, bin80Zero, collision.multNTracksHasTRD());
+          addToDriftWindow(tfIDX, kOccMultNTracksITSOnly, bin80Zero, collision.multNTracksITSOnly());
+          addToDriftWindow(tfIDX, kOccMultNTracksTPCOnly, bin80Zero, collision.multNTracksTPCOnly());
+          addToDriftWindow(tfIDX, kOccMultNTracksITSTPC, bin80Zero, collision.multNTracksITSTPC());
+          addToDriftWindow(tfIDX, kOccMultAllTracksTPCOnly, bin80Zero, collision.multAllTracksTPCOnly());
         }
       }
       // collision Loop is over
+      integrateDriftWindows(tfCounted);
 
       occupancyQA.fill(HIST("h_TF_in_DataFrame"), tfCounted);
 
@@ -1012,23 +990,23 @@ struct OccupancyTableProducer {
       // Create a BC index table.
       int64_t occIDX = -1;
       int idx = -1;
+      int64_t lastTfId = -1;
       for (auto const& bc : BCs) {
-        idx = -1;
         getTimingInfo(bc, lastRun, nBCsPerTF, bcSOR, time, tfIdThis, bcInTF);
 
-        auto idxIt = std::find(tfList.begin(), tfList.end(), tfIdThis);
-        if (idxIt != tfList.end()) {
-          idx = std::distance(tfList.begin(), idxIt);
-        } else {
-          LOG(error) << "DEBUG :: SEVERE :: BC  Timeframe not in the list";
+        if (idx == -1 || tfIdThis != lastTfId) { // BCs are time ordered, the TF slot changes rarely
+          lastTfId = tfIdThis;
+          auto idxIt = std::find(tfList.begin(), tfList.end(), tfIdThis);
+          if (idxIt != tfList.end()) {
+            idx = std::distance(tfList.begin(), idxIt);
+          } else {
+            idx = -1;
+            LOG(error) << "DEBUG :: SEVERE :: BC  Timeframe not in the list";
+          }
         }
 
-        auto it = std::find(bcTFMap[idx].begin(), bcTFMap[idx].end(), bc.globalIndex()); // will find the iterator where object is placed.
-        if (it != bcTFMap[idx].end()) {
-          occIDX = idx; // Element is in the vector
-        } else {
-          occIDX = -1; // Element is not in the vector
-        }
+        // the BC is in bcTFMap[idx] if one of its collisions was stored in this TF slot
+        occIDX = (idx >= 0 && bcOccSlot[bc.globalIndex()] == idx) ? idx : -1;
 
         genBCTFinfoTable(tfIdThis, bcInTF);
         genOccIndexTable(bc.globalIndex(), occIDX); // BCId, OccId
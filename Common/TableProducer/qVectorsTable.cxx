@@ -43,11 +43,12 @@
 #include <Framework/RunningWorkflowInfo.h>
 #include <Framework/runDataProcessing.h>
 
-#include <TComplex.h>
 #include <TH3.h>
 #include <TProfile3D.h>
 #include <TString.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <cstddef>
@@ -182,8 +183,36 @@ struct QVectorsTable {
   const int nShiftIndex = 10;
   const float trackEtaMin = 0.1;
 
-  std::vector<TH3F*> corrsQvecSp{};
-  std::vector<TH3F*> corrsQvecEse{};
+  /// Flat copy of a TH3F with correction constants, read like TH3::GetBinContent(binx, biny, binz)
+  struct FlatCorrections {
+    int nCellsX{1};
+    int nCellsY{1};
+    int nCellsZ{1};
+    std::vector<float> values{0.f}; // no correction by default
+
+    void set(TH3F* hist)
+    {
+      nCellsX = hist->GetNbinsX() + 2;
+      nCellsY = hist->GetNbinsY() + 2;
+      nCellsZ = hist->GetNbinsZ() + 2;
+      values.assign(hist->GetArray(), hist->GetArray() + nCellsX * nCellsY * nCellsZ);
+    }
+    float get(int binx, int biny, int binz) const
+    {
+      binx = std::clamp(binx, 0, nCellsX - 1);
+      biny = std::clamp(biny, 0, nCellsY - 1);
+      binz = std::clamp(binz, 0, nCellsZ - 1);
+      return values[binx + nCellsX * (biny + nCellsY * binz)];
+    }
+  };
+
+  std::vector<FlatCorrections> corrsQvecSp{};
+  std::vector<FlatCorrections> corrsQvecEse{};
+
+  // FIT Q-vectors of all harmonics for the current collision, indexed as [detector * nMods + harmonic]
+  std::vector<double> qVecFITRe{};
+  std::vector<double> qVecFITIm{};
+  std::array<float, kTPCPos> sumAmplFIT{};
   std::vector<TProfile3D*> shiftProfileSp{};
   std::vector<TProfile3D*> shiftProfileEse{};
 
@@ -291,6 +320,7 @@ struct QVectorsTable {
     } else {
       LOGF(fatal, "Could not get the alignment parameters for FV0.");
     }
+    helperEP.InitChannelHarmonics(cfgnMods.value, ft0geom, fv0geom);
 
     corrsQvecSp.clear();
     for (std::size_t i = 0; i < cfgnMods->size(); i++) {
@@ -304,11 +334,13 @@ struct QVectorsTable {
         fullPath += "/v2";
         modeCorrQvecSp = getForTsOrRun<TH3F>(fullPath, timestamp, runnumber);
       }
+      FlatCorrections modeCorrs;
       if (!modeCorrQvecSp) {
         LOGF(info, "Could not get the correction histograms for Q-vectors for mode %d. Setting to no correction.", ind);
-        modeCorrQvecSp = new TH3F("modeCorrQvecSp", "modeCorrQvecSp", 1, 0, 1, 1, 0, 1, 1, 0, 1);
+      } else {
+        modeCorrs.set(modeCorrQvecSp);
       }
-      corrsQvecSp.push_back(modeCorrQvecSp);
+      corrsQvecSp.push_back(modeCorrs);
     }
 
     if (cfgProduceRedQVecs) {
@@ -324,11 +356,13 @@ struct QVectorsTable {
           fullPath += "/eseq2";
           modeCorrQvecEse = getForTsOrRun<TH3F>(fullPath, timestamp, runnumber);
         }
+        FlatCorrections modeCorrs;
         if (!modeCorrQvecEse) {
           LOGF(info, "Could not get the correction histograms for Q-vectors for mode %d. Setting to no correction.", ind);
-          modeCorrQvecEse = new TH3F("modeCorrQvecEse", "modeCorrQvecEse", 1, 0, 1, 1, 0, 1, 1, 0, 1);
+        } else {
+          modeCorrs.set(modeCorrQvecEse);
         }
-        corrsQvecEse.push_back(modeCorrQvecEse);
+        corrsQvecEse.push_back(modeCorrs);
       }
     }
 
@@ -471,28 +505,30 @@ struct QVectorsTable {
   /// \param centrality is the collision centrality
   /// \param qVecRe is the vector with the real part of the q-vector for each detector and correction step
   /// \param qVecIm is the vector with the imaginary part of the q-vector for each detector and correction step
-  /// \param histsCorrs is the vector with the histograms with the correction constants for each detector and correction step
+  /// \param corrs are the correction constants for each detector and correction step
   /// \param nMode is the modulation of interest
-  void correctQVec(float centrality, std::vector<float>& qVecRe, std::vector<float>& qVecIm, TH3F* histsCorrs, std::vector<TProfile3D*>& shiftProfile, int nMode)
+  void correctQVec(float centrality, std::vector<float>& qVecRe, std::vector<float>& qVecIm, FlatCorrections const& corrs, std::vector<TProfile3D*>& shiftProfile, int nMode)
   {
     int nCorrections = static_cast<int>(kNCorrections);
     if (centrality < cfgMaxCentrality) {
+      const int centBin = static_cast<int>(centrality) + 1;
       for (auto i{0u}; i < kTPCAll + 1; i++) {
         int idxDet = i * kNCorrections;
-        helperEP.DoRecenter(qVecRe[idxDet + kRecenter], qVecIm[idxDet + kRecenter],
-                            histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 1, i + 1), histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 2, i + 1));
-
-        helperEP.DoRecenter(qVecRe[idxDet + kTwist], qVecIm[idxDet + kTwist],
-                            histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 1, i + 1), histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 2, i + 1));
-        helperEP.DoTwist(qVecRe[idxDet + kTwist], qVecIm[idxDet + kTwist],
-                         histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 3, i + 1), histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 4, i + 1));
-
-        helperEP.DoRecenter(qVecRe[idxDet + kRescale], qVecIm[idxDet + kRescale],
-                            histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 1, i + 1), histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 2, i + 1));
-        helperEP.DoTwist(qVecRe[idxDet + kRescale], qVecIm[idxDet + kRescale],
-                         histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 3, i + 1), histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 4, i + 1));
-        helperEP.DoRescale(qVecRe[idxDet + kRescale], qVecIm[idxDet + kRescale],
-                           histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 5, i + 1), histsCorrs->GetBinContent(static_cast<int>(centrality) + 1, 6, i + 1));
+        const float meanX = corrs.get(centBin, 1, i + 1);
+        const float meanY = corrs.get(centBin, 2, i + 1);
+        const float lambdaPlus = corrs.get(centBin, 3, i + 1);
+        const float lambdaMinus = corrs.get(centBin, 4, i + 1);
+        const float aPlus = corrs.get(centBin, 5, i + 1);
+        const float aMinus = corrs.get(centBin, 6, i + 1);
+
+        helperEP.DoRecenter(qVecRe[idxDet + kRecenter], qVecIm[idxDet + kRecenter], meanX, meanY);
+
+        helperEP.DoRecenter(qVecRe[idxDet + kTwist], qVecIm[idxDet + kTwist], meanX, meanY);
+        helperEP.DoTwist(qVecRe[idxDet + kTwist], qVecIm[idxDet + kTwist], lambdaPlus, lambdaMinus);
+
+        helperEP.DoRecenter(qVecRe[idxDet + kRescale], qVecIm[idxDet + kRescale], meanX, meanY);
+        helperEP.DoTwist(qVecRe[idxDet + kRescale], qVecIm[idxDet + kRescale], lambdaPlus, lambdaMinus);
+        helperEP.DoRescale(qVecRe[idxDet + kRescale], qVecIm[idxDet + kRescale], aPlus, aMinus);
       }
       if (cfgShiftCorr) {
         auto deltaPsiFT0C = 0.0;
@@ -577,33 +613,15 @@ struct QVectorsTable {
     }
   }
 
-  /// Function to calculate the un-normalized q-vectors
-  /// \param nMode is the harmonic number of the q-vector
+  /// Function to calculate the un-normalized FIT q-vectors of all harmonics in one pass over the channels
   /// \param coll is the collision object
-  /// \param tracks are the tracks associated to the collision
-  /// \param qVecRe is the vector with the real part of the q-vector for each detector
-  /// \param qVecIm is the vector with the imaginary part of the q-vector for each detector
-  /// \param qVecAmp is the vector with the amplitude of the signal in each detector
-  /// \param trkTPCPosLabel is the vector with the number of TPC tracks with positive eta
-  /// \param trkTPCNegLabel is the vector with the number of TPC tracks with negative eta
-  /// \param trkTPCAllLabel is the vector with the number of TPC tracks with any eta
-  template <typename Nmode, typename CollType, typename TrackType>
-  void calcQVec(const Nmode nMode, const CollType& coll, const TrackType& tracks, std::vector<float>& qVecRe, std::vector<float>& qVecIm, std::vector<float>& qVecAmp, std::vector<int>& trkTPCPosLabel, std::vector<int>& trkTPCNegLabel, std::vector<int>& trkTPCAllLabel)
+  template <typename CollType>
+  void calcFITQVecs(const CollType& coll)
   {
-    float qVectFT0A[2] = {-999., -999.};
-    float qVectFT0C[2] = {-999., -999.};
-    float qVectFT0M[2] = {-999., -999.};
-    float qVectFV0A[2] = {-999., -999.};
-    float qVectTPCPos[2] = {0., 0.}; // Always computed
-    float qVectTPCNeg[2] = {0., 0.}; // Always computed
-    float qVectTPCAll[2] = {0., 0.}; // Always computed
-
-    TComplex qVecDet(0);
-    TComplex qVecFT0M(0);
-    float sumAmplFT0A = 0.;
-    float sumAmplFT0C = 0.;
-    float sumAmplFT0M = 0.;
-    float sumAmplFV0A = 0.;
+    const std::size_t nMods = cfgnMods->size();
+    qVecFITRe.assign(kTPCPos * nMods, 0.);
+    qVecFITIm.assign(kTPCPos * nMods, 0.);
+    sumAmplFIT.fill(0.f);
 
     if (coll.has_foundFT0() && (useDetector["QvectorFT0As"] || useDetector["QvectorFT0Cs"] || useDetector["QvectorFT0Ms"])) {
       auto ft0 = coll.foundFT0();
@@ -612,61 +630,99 @@ struct QVectorsTable {
         for (std::size_t iChA = 0; iChA < ft0.channelA().size(); iChA++) {
           float ampl = ft0.amplitudeA()[iChA];
           int ft0AchId = ft0.channelA()[iChA];
+          float amplCor = ampl / ft0RelGainConst[ft0AchId];
 
           histosQA.fill(HIST("FT0Amp"), ampl, ft0AchId);
-          histosQA.fill(HIST("FT0AmpCor"), ampl / ft0RelGainConst[ft0AchId], ft0AchId);
+          histosQA.fill(HIST("FT0AmpCor"), amplCor, ft0AchId);
 
-          helperEP.SumQvectors(0, ft0AchId, ampl / ft0RelGainConst[ft0AchId], nMode, qVecDet, sumAmplFT0A, ft0geom, fv0geom);
-          helperEP.SumQvectors(0, ft0AchId, ampl / ft0RelGainConst[ft0AchId], nMode, qVecFT0M, sumAmplFT0M, ft0geom, fv0geom);
-        }
-        if (sumAmplFT0A > minAmplitude) {
-          qVectFT0A[0] = qVecDet.Re();
-          qVectFT0A[1] = qVecDet.Im();
+          helperEP.SumQvectorsHarmonics(0, ft0AchId, amplCor, &qVecFITRe[kFT0A * nMods], &qVecFITIm[kFT0A * nMods]);
+          helperEP.SumQvectorsHarmonics(0, ft0AchId, amplCor, &qVecFITRe[kFT0M * nMods], &qVecFITIm[kFT0M * nMods]);
+          sumAmplFIT[kFT0A] += amplCor;
+          sumAmplFIT[kFT0M] += amplCor;
         }
       }
 
       if (useDetector["QvectorFT0Cs"]) {
-        qVecDet = TComplex(0., 0.);
         for (std::size_t iChC = 0; iChC < ft0.channelC().size(); iChC++) {
           float ampl = ft0.amplitudeC()[iChC];
           int ft0CchId = ft0.channelC()[iChC] + 96;
+          float amplCor = ampl / ft0RelGainConst[ft0CchId];
 
           histosQA.fill(HIST("FT0Amp"), ampl, ft0CchId);
-          histosQA.fill(HIST("FT0AmpCor"), ampl / ft0RelGainConst[ft0CchId], ft0CchId);
-
-          helperEP.SumQvectors(0, ft0CchId, ampl / ft0RelGainConst[ft0CchId], nMode, qVecDet, sumAmplFT0C, ft0geom, fv0geom);
-          helperEP.SumQvectors(0, ft0CchId, ampl / ft0RelGainConst[ft0CchId], nMode, qVecFT0M, sumAmplFT0M, ft0geom, fv0geom);
-        }
+          histosQA.fill(HIST("FT0AmpCor"), amplCor, ft0CchId);
 
-        if (sumAmplFT0C > minAmplitude) {
-          qVectFT0C[0] = qVecDet.Re();
-          qVectFT0C[1] = qVecDet.Im();
-        }
-        if (sumAmplFT0M > minAmplitude && useDetector["QvectorFT0Ms"]) {
-          qVectFT0M[0] = qVecFT0M.Re();
-          qVectFT0M[1] = qVecFT0M.Im();
+          helperEP.SumQvectorsHarmonics(0, ft0CchId, amplCor, &qVecFITRe[kFT0C * nMods], &qVecFITIm[kFT0C * nMods]);
+          helperEP.SumQvectorsHarmonics(0, ft0CchId, amplCor, &qVecFITRe[kFT0M * nMods], &qVecFITIm[kFT0M * nMods]);
+          sumAmplFIT[kFT0C] += amplCor;
+          sumAmplFIT[kFT0M] += amplCor;
         }
       }
 
-      qVecDet = TComplex(0., 0.);
-      sumAmplFV0A = 0;
       if (coll.has_foundFV0() && useDetector["QvectorFV0As"]) {
         auto fv0 = coll.foundFV0();
 
         for (std::size_t iCh = 0; iCh < fv0.channel().size(); iCh++) {
           float ampl = fv0.amplitude()[iCh];
           int fv0AchId = fv0.channel()[iCh];
+          float amplCor = ampl / fv0RelGainConst[fv0AchId];
+
           histosQA.fill(HIST("FV0Amp"), ampl, fv0AchId);
-          histosQA.fill(HIST("FV0AmpCor"), ampl / fv0RelGainConst[fv0AchId], fv0AchId);
+          histosQA.fill(HIST("FV0AmpCor"), amplCor, fv0AchId);
 
-          helperEP.SumQvectors(1, fv0AchId, ampl / fv0RelGainConst[fv0AchId], nMode, qVecDet, sumAmplFV0A, ft0geom, fv0geom);
+          helperEP.SumQvectorsHarmonics(1, fv0AchId, amplCor, &qVecFITRe[kFV0A * nMods], &qVecFITIm[kFV0A * nMods]);
+          sumAmplFIT[kFV0A] += amplCor;
         }
+      }
+    }
+  }
+
+  /// Function to calculate the un-normalized q-vectors
+  /// \param iMode is the index of the harmonic in cfgnMods
+  /// \param nMode is the harmonic number of the q-vector
+  /// \param coll is the collision object
+  /// \param tracks are the tracks associated to the collision
+  /// \param qVecRe is the vector with the real part of the q-vector for each detector
+  /// \param qVecIm is the vector with the imaginary part of the q-vector for each detector
+  /// \param qVecAmp is the vector with the amplitude of the signal in each detector
+  /// \param trkTPCPosLabel is the vector with the number of TPC tracks with positive eta
+  /// \param trkTPCNegLabel is the vector with the number of TPC tracks with negative eta
+  /// \param trkTPCAllLabel is the vector with the number of TPC tracks with any eta
+  template <typename Nmode, typename CollType, typename TrackType>
+  void calcQVec(const std::size_t iMode, const Nmode nMode, const CollType& coll, const TrackType& tracks, std::vector<float>& qVecRe, std::vector<float>& qVecIm, std::vector<float>& qVecAmp, std::vector<int>& trkTPCPosLabel, std::vector<int>& trkTPCNegLabel, std::vector<int>& trkTPCAllLabel)
+  {
+    float qVectFT0A[2] = {-999., -999.};
+    float qVectFT0C[2] = {-999., -999.};
+    float qVectFT0M[2] = {-999., -999.};
+    float qVectFV0A[2] = {-999., -999.};
+    float qVectTPCPos[2] = {0., 0.}; // Always computed
+    float qVectTPCNeg[2] = {0., 0.}; // Always computed
+    float qVectTPCAll[2] = {0., 0.}; // Always computed
 
-        if (sumAmplFV0A > minAmplitude) {
-          qVectFV0A[0] = qVecDet.Re();
-          qVectFV0A[1] = qVecDet.Im();
+    // FIT Q-vectors, computed for all harmonics in calcFITQVecs
+    const std::size_t nMods = cfgnMods->size();
+    float sumAmplFT0A = sumAmplFIT[kFT0A];
+    float sumAmplFT0C = sumAmplFIT[kFT0C];
+    float sumAmplFT0M = sumAmplFIT[kFT0M];
+    float sumAmplFV0A = sumAmplFIT[kFV0A];
+    if (coll.has_foundFT0() && (useDetector["QvectorFT0As"] || useDetector["QvectorFT0Cs"] || useDetector["QvectorFT0Ms"])) {
+      if (useDetector["QvectorFT0As"] && sumAmplFT0A > minAmplitude) {
+        qVectFT0A[0] = qVecFITRe[kFT0A * nMods + iMode];
+        qVectFT0A[1] = qVecFITIm[kFT0A * nMods + iMode];
+      }
+      if (useDetector["QvectorFT0Cs"]) {
+        if (sumAmplFT0C > minAmplitude) {
+          qVectFT0C[0] = qVecFITRe[kFT0C * nMods + iMode];
+          qVectFT0C[1] = qVecFITIm[kFT0C * nMods + iMode];
+        }
+        if (sumAmplFT0M > minAmplitude && useDetector["QvectorFT0Ms"]) {
+          qVectFT0M[0] = qVecFITRe[kFT0M * nMods + iMode];
+          qVectFT0M[1] = qVecFITIm[kFT0M * nMods + iMode];
         }
       }
+      if (coll.has_foundFV0() && useDetector["QvectorFV0As"] && sumAmplFV0A > minAmplitude) {
+        qVectFV0A[0] = qVecFITRe[kFV0A * nMods + iMode];
+        qVectFV0A[1] = qVecFITIm[kFV0A * nMods + iMode];
+      }
     }
 
     int nTrkTPCPos = 0;
@@ -786,13 +842,16 @@ struct QVectorsTable {
       isCalibrated = false;
     }
 
+    // FIT Q-vectors of all harmonics in a single pass over the channels
+    calcFITQVecs(coll);
+
     for (std::size_t id = 0; id < cfgnMods->size(); id++) {
       int nMode = cfgnMods->at(id);
 
       // Raw Q-vectors, no multiplicity normalization and no corrections
       std::vector<float> qVecReRaw{};
       std::vector<float> qVecImRaw{};
-      calcQVec(nMode, coll, tracks, qVecReRaw, qVecImRaw, qVecAmp, trkTPCPosLabel, trkTPCNegLabel, trkTPCAllLabel);
+      calcQVec(id, nMode, coll, tracks, qVecReRaw, qVecImRaw, qVecAmp, trkTPCPosLabel, trkTPCNegLabel, trkTPCAllLabel);
 
       // Scalar Product Q-vectors, normalization by multiplicity/amplitude
       std::vector<float> nModeQVecReSp{};
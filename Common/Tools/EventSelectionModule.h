@@ -51,6 +51,7 @@
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <map>
@@ -87,6 +88,62 @@ struct BcselEntry {
   int foundZDCId = -1;
 };
 
+// flat globalBC-sorted index of bcs (struct-of-arrays), replaces std::map lookups
+// globalBC -> {bc index, FT0 vertex z} in the per-dataframe collision-bc matching
+struct GlobalBcIndex {
+  std::vector<int64_t> globalBC; // sorted, unique
+  std::vector<int32_t> bcIndex;  // bc table index for each globalBC
+  std::vector<float> vtxZ;       // FT0 vertex z for each globalBC
+  std::vector<bool> isFree;      // false once the bc was assigned to a collision
+
+  void clear()
+  {
+    globalBC.clear();
+    bcIndex.clear();
+    vtxZ.clear();
+    isFree.clear();
+  }
+  size_t size() const { return globalBC.size(); }
+  void add(int64_t bc, int32_t index, float z)
+  {
+    globalBC.push_back(bc);
+    bcIndex.push_back(index);
+    vtxZ.push_back(z);
+    isFree.push_back(true);
+  }
+  // sort by globalBC if needed; for duplicated globalBCs keep the last added entry (as std::map::operator[] would)
+  void finalize()
+  {
+    if (std::adjacent_find(globalBC.begin(), globalBC.end(), std::greater_equal<int64_t>()) == globalBC.end()) {
+      return; // already strictly increasing, the usual case
+    }
+    std::vector<size_t> order(globalBC.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return globalBC[a] < globalBC[b]; });
+    GlobalBcIndex sorted;
+    for (size_t i = 0; i < order.size(); i++) {
+      size_t j = order[i];
+      if (sorted.size() > 0 && sorted.globalBC.back() == globalBC[j]) {
+        sorted.bcIndex.back() = bcIndex[j];
+        sorted.vtxZ.back() = vtxZ[j];
+        continue;
+      }
+      sorted.add(globalBC[j], bcIndex[j], vtxZ[j]);
+    }
+    *this = std::move(sorted);
+  }
+  // position of the first entry with globalBC >= bc
+  size_t lowerBound(int64_t bc) const { return std::lower_bound(globalBC.begin(), globalBC.end(), bc) - globalBC.begin(); }
+  // position of the first entry with globalBC > bc
+  size_t upperBound(int64_t bc) const { return std::upper_bound(globalBC.begin(), globalBC.end(), bc) - globalBC.begin(); }
+  // position of bc in the index, -1 if not present
+  int64_t find(int64_t bc) const
+  {
+    size_t pos = lowerBound(bc);
+    return (pos < globalBC.size() && globalBC[pos] == bc) ? static_cast<int64_t>(pos) : -1;
+  }
+};
+
 // bc selection configurables
 struct BcselConfigurables : o2::framework::ConfigurableGroup {
   std::string prefix = "bcselOpts";
@@ -640,15 +697,17 @@ class EventSelectionModule
   std::vector<float> diffVzParMean;  // parameterization for mean of diff vZ by FT0 vs by tracks
   std::vector<float> diffVzParSigma; // parameterization for stddev of diff vZ by FT0 vs by tracks
 
-  int32_t findClosest(const int64_t globalBC, const std::map<int64_t, int32_t>& bcs)
+  GlobalBcIndex bcsWithTVX; // TVX-fired bcs of the current dataframe, sorted by globalBC
+
+  int32_t findClosest(const int64_t globalBC, const GlobalBcIndex& bcs)
   {
-    auto it = bcs.lower_bound(globalBC);
-    int64_t bc1 = it->first;
-    int32_t index1 = it->second;
-    if (it != bcs.begin())
-      --it;
-    int64_t bc2 = it->first;
-    int32_t index2 = it->second;
+    size_t pos = std::min(bcs.lowerBound(globalBC), bcs.size() - 1);
+    int64_t bc1 = bcs.globalBC[pos];
+    int32_t index1 = bcs.bcIndex[pos];
+    if (pos > 0)
+      --pos;
+    int64_t bc2 = bcs.globalBC[pos];
+    int32_t index2 = bcs.bcIndex[pos];
     int64_t dbc1 = std::abs(bc1 - globalBC);
     int64_t dbc2 = std::abs(bc2 - globalBC);
     return (dbc1 <= dbc2) ? index1 : index2;
@@ -663,7 +722,8 @@ class EventSelectionModule
   }
 
   // helper function to find closest TVX signal in time and in zVtx
-  int64_t findBestGlobalBC(int64_t meanBC, int64_t sigmaBC, int32_t nContrib, float zVtxCol, std::map<int64_t, float>& mapGlobalBcVtxZ)
+  // (only bcs not yet assigned to a collision are considered)
+  int64_t findBestGlobalBC(int64_t meanBC, int64_t sigmaBC, int32_t nContrib, float zVtxCol, const GlobalBcIndex& bcsWithTVX)
   {
     // protection against
     if (sigmaBC < 1)
@@ -676,16 +736,18 @@ class EventSelectionModule
     float zVtxSigma = 2.7 * std::pow(nContrib, -0.466) + 0.024;
     zVtxSigma += 1.0; // additional uncertainty due to imperfectections of FT0 time calibration
 
-    auto itMin = mapGlobalBcVtxZ.lower_bound(minBC);
-    auto itMax = mapGlobalBcVtxZ.upper_bound(maxBC);
+    size_t posMin = bcsWithTVX.lowerBound(minBC);
+    size_t posMax = bcsWithTVX.upperBound(maxBC);
 
     float bestChi2 = 1e+10;
     int64_t bestGlobalBC = 0;
-    for (std::map<int64_t, float>::iterator it = itMin; it != itMax; ++it) {
-      float chi2 = std::pow((it->second - zVtxCol) / zVtxSigma, 2) + std::pow(static_cast<float>(it->first - meanBC) / sigmaBC, 2.);
+    for (size_t pos = posMin; pos < posMax; ++pos) {
+      if (!bcsWithTVX.isFree[pos])
+        continue;
+      float chi2 = std::pow((bcsWithTVX.vtxZ[pos] - zVtxCol) / zVtxSigma, 2) + std::pow(static_cast<float>(bcsWithTVX.globalBC[pos] - meanBC) / sigmaBC, 2.);
       if (chi2 < bestChi2) {
         bestChi2 = chi2;
-        bestGlobalBC = it->first;
+        bestGlobalBC = bcsWithTVX.globalBC[pos];
       }
     }
 
@@ -898,11 +960,9 @@ class EventSelectionModule
       return; // don't do anything in case configuration reported not ok
 
     int run = bcs.iteratorAt(0).runNumber();
-    // create maps from globalBC to bc index for TVX-fired bcs
+    // create flat index from globalBC to bc index for TVX-fired bcs
     // to be used for closest TVX searches
-    std::map<int64_t, int32_t> mapGlobalBcWithTVX;
-    std::map<int64_t, int32_t> mapGlobalBcWithOrInFT0;
-    std::map<int64_t, float> mapGlobalBcVtxZ;
+    bcsWithTVX.clear();
     for (const auto& bc : bcs) {
       int64_t globalBC = bc.globalBC();
       // skip non-colliding bcs for data and anchored runs
@@ -910,19 +970,15 @@ class EventSelectionModule
         continue;
       }
 
-      if (bc.has_ft0()) {
-        mapGlobalBcWithOrInFT0[globalBC] = bc.globalIndex();
-      }
-
       auto selection = bcselbuffer[bc.globalIndex()].selection;
       if (BITCHECK64(selection, aod::evsel::kIsTriggerTVX)) {
-        mapGlobalBcWithTVX[globalBC] = bc.globalIndex();
-        mapGlobalBcVtxZ[globalBC] = bc.has_ft0() ? bc.ft0().posZ() : 0;
+        bcsWithTVX.add(globalBC, bc.globalIndex(), bc.has_ft0() ? bc.ft0().posZ() : 0);
       }
     }
+    bcsWithTVX.finalize();
 
     // protection against empty FT0 maps
-    if (mapGlobalBcWithTVX.size() == 0) {
+    if (bcsWithTVX.size() == 0) {
       LOGP(error, "FT0 table is empty or corrupted. Filling evsel table with dummy values");
       for (const auto& col : cols) {
         auto bc = col.template bc_as<soa::Join<aod::BCs, aod::Run3MatchedToBCSparse>>();
@@ -1032,19 +1088,19 @@ class EventSelectionModule
 
         // matched with TOF --> precise time, match to TVX, but keep the nominal foundGlobalBC from pattern
         if (vIsVertexTOFmatched[colIndex]) {
-          std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(foundGlobalBC);
-          if (it != mapGlobalBcWithTVX.end()) {
-            foundBCindex = it->second;                       // TVX at foundGlobalBC is found
-          } else {                                           // check if TVX is in nearby bcs
-            it = mapGlobalBcWithTVX.find(foundGlobalBC + 1); // next bc
-            if (it != mapGlobalBcWithTVX.end()) {
+          int64_t pos = bcsWithTVX.find(foundGlobalBC);
+          if (pos >= 0) {
+            foundBCindex = bcsWithTVX.bcIndex[pos];   // TVX at foundGlobalBC is found
+          } else {                                    // check if TVX is in nearby bcs
+            pos = bcsWithTVX.find(foundGlobalBC + 1); // next bc
+            if (pos >= 0) {
               // foundGlobalBC += 1;
-              foundBCindex = it->second;
+              foundBCindex = bcsWithTVX.bcIndex[pos];
             } else {
-              it = mapGlobalBcWithTVX.find(foundGlobalBC - 1); // previous bc
-              if (it != mapGlobalBcWithTVX.end()) {
+              pos = bcsWithTVX.find(foundGlobalBC - 1); // previous bc
+              if (pos >= 0) {
                 // foundGlobalBC -= 1;
-                foundBCindex = it->second;
+                foundBCindex = bcsWithTVX.bcIndex[pos];
               } else {
                 foundBCindex = bc.globalIndex(); // keep original BC index
               }
@@ -1054,7 +1110,7 @@ class EventSelectionModule
         } else {
           // for non-TOF and low-mult vertices, consider nearby nominal bcs
           int64_t meanBC = globalBC + TMath::Nint(sumHighPtTime / sumHighPtW / bcNS);
-          int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
+          int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ(), bcsWithTVX);
           if (bestGlobalBC > 0) {
             foundGlobalBC = bestGlobalBC;
             // find closest nominal bc in pattern
@@ -1066,7 +1122,7 @@ class EventSelectionModule
                 break; // the bc in pattern is found
               }
             }
-            foundBCindex = mapGlobalBcWithTVX[bestGlobalBC];
+            foundBCindex = bcsWithTVX.bcIndex[bcsWithTVX.find(bestGlobalBC)];
           } else {                           // failed to find a proper TVX with small vZ difference
             foundBCindex = bc.globalIndex(); // keep original BC index
           }
@@ -1081,28 +1137,28 @@ class EventSelectionModule
         // for collisions with TOF tracks:
         // take bc corresponding to TOF track with median time
         int64_t tofGlobalBC = globalBC + TMath::Nint(getMedian(vTrackTimesTOF) / bcNS);
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(tofGlobalBC);
-        if (it != mapGlobalBcWithTVX.end()) {
-          foundGlobalBC = it->first;
-          foundBCindex = it->second;
+        int64_t pos = bcsWithTVX.find(tofGlobalBC);
+        if (pos >= 0) {
+          foundGlobalBC = bcsWithTVX.globalBC[pos];
+          foundBCindex = bcsWithTVX.bcIndex[pos];
         }
       } else if (nPvTracksTPCnoTOFnoTRD == 0 && nPvTracksTRDnoTOF > 0) {
         // for collisions with TRD tracks but without TOF or ITSTPC-only tracks:
         // take bc corresponding to TRD track with median time
         int64_t trdGlobalBC = globalBC + TMath::Nint(getMedian(vTrackTimesTRDnoTOF) / bcNS);
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(trdGlobalBC);
-        if (it != mapGlobalBcWithTVX.end()) {
-          foundGlobalBC = it->first;
-          foundBCindex = it->second;
+        int64_t pos = bcsWithTVX.find(trdGlobalBC);
+        if (pos >= 0) {
+          foundGlobalBC = bcsWithTVX.globalBC[pos];
+          foundBCindex = bcsWithTVX.bcIndex[pos];
         }
       } else if (nPvTracksHighPtTPCnoTOFnoTRD > 0) {
         // for collisions with high-pt ITSTPC-nonTOF-nonTRD tracks
         // search in 3*confSigmaBCforHighPtTracks range (3*4 bcs by default)
         int64_t meanBC = globalBC + TMath::Nint(sumHighPtTime / sumHighPtW / bcNS);
-        int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
+        int64_t bestGlobalBC = findBestGlobalBC(meanBC, evselOpts.confSigmaBCforHighPtTracks, vNcontributors[colIndex], col.posZ(), bcsWithTVX);
         if (bestGlobalBC > 0) {
           foundGlobalBC = bestGlobalBC;
-          foundBCindex = mapGlobalBcWithTVX[bestGlobalBC];
+          foundBCindex = bcsWithTVX.bcIndex[bcsWithTVX.find(bestGlobalBC)];
         }
       }
 
@@ -1112,19 +1168,25 @@ class EventSelectionModule
       vFoundGlobalBC[colIndex] = foundGlobalBC > 0 ? foundGlobalBC : globalBC;
 
       // erase found global BC with TVX from the pool of bcs for the next loop over low-pt TPCnoTOFnoTRD collisions
-      if (foundBCindex >= 0)
-        mapGlobalBcVtxZ.erase(foundGlobalBC);
+      if (foundBCindex >= 0) {
+        int64_t pos = bcsWithTVX.find(foundGlobalBC);
+        if (pos >= 0)
+          bcsWithTVX.isFree[pos] = false;
+      }
     }
     // alternative matching: looking for collisions with the same nominal BC
     if (runLightIons >= 0) {
-      for (uint32_t iCol = 0; iCol < vBCinPatternPerColl.size(); iCol++) {
-        int64_t foundNominalBC = vBCinPatternPerColl[iCol];
-        for (uint32_t jCol = 0; jCol < vBCinPatternPerColl.size(); jCol++) {
-          int64_t foundNominalBC2 = vBCinPatternPerColl[jCol];
-          if (foundNominalBC2 == foundNominalBC) {
-            vCollisionsPileupPerColl[iCol]++;
-          }
-        }
+      // sweep over collisions sorted by nominal BC instead of comparing all pairs
+      std::vector<uint32_t> vSortedByNominalBC(vBCinPatternPerColl.size());
+      std::iota(vSortedByNominalBC.begin(), vSortedByNominalBC.end(), 0);
+      std::stable_sort(vSortedByNominalBC.begin(), vSortedByNominalBC.end(), [&](uint32_t a, uint32_t b) { return vBCinPatternPerColl[a] < vBCinPatternPerColl[b]; });
+      for (size_t iFirst = 0; iFirst < vSortedByNominalBC.size();) {
+        size_t iLast = iFirst + 1;
+        while (iLast < vSortedByNominalBC.size() && vBCinPatternPerColl[vSortedByNominalBC[iLast]] == vBCinPatternPerColl[vSortedByNominalBC[iFirst]])
+          iLast++;
+        for (size_t i = iFirst; i < iLast; i++)
+          vCollisionsPileupPerColl[vSortedByNominalBC[i]] += iLast - iFirst;
+        iFirst = iLast;
       }
     } else { // continue standard matching: second loop to match remaining low-pt TPCnoTOFnoTRD collisions
       for (const auto& col : cols) {
@@ -1136,9 +1198,9 @@ class EventSelectionModule
           int64_t globalBC = bc.globalBC();
           int64_t meanBC = globalBC + TMath::Nint(weightedTime / bcNS);
           int64_t sigmaBC = TMath::CeilNint(weightedSigma / bcNS);
-          int64_t bestGlobalBC = findBestGlobalBC(meanBC, sigmaBC, vNcontributors[colIndex], col.posZ(), mapGlobalBcVtxZ);
+          int64_t bestGlobalBC = findBestGlobalBC(meanBC, sigmaBC, vNcontributors[colIndex], col.posZ(), bcsWithTVX);
           vFoundGlobalBC[colIndex] = bestGlobalBC > 0 ? bestGlobalBC : globalBC;
-          vFoundBCindex[colIndex] = bestGlobalBC > 0 ? mapGlobalBcWithTVX[bestGlobalBC] : bc.globalIndex();
+          vFoundBCindex[colIndex] = bestGlobalBC > 0 ? bcsWithTVX.bcIndex[bcsWithTVX.find(bestGlobalBC)] : bc.globalIndex();
         }
         // fill pileup counter
         vCollisionsPerBc[vFoundBCindex[colIndex]]++;
@@ -1396,10 +1458,10 @@ class EventSelectionModule
       if (vIsFullInfoForOccupancy[colIndex] && vCanHaveAssocCollsWithinLastDriftTime[colIndex] && colIndexFirstRejectedByTFborderCut >= 0) {
         int64_t foundGlobalBC = vFoundGlobalBC[colIndex];
         int64_t tfId = (foundGlobalBC - bcSOR) / nBCsPerTF;
-        std::map<int64_t, int32_t>::iterator it = mapGlobalBcWithTVX.find(vFoundGlobalBC[colIndexFirstRejectedByTFborderCut]);
-        while (it != mapGlobalBcWithTVX.end()) {
-          int64_t thisFoundGlobalBC = it->first;
-          int32_t thisFoundBCindex = it->second;
+        int64_t firstPos = bcsWithTVX.find(vFoundGlobalBC[colIndexFirstRejectedByTFborderCut]);
+        for (int64_t pos = firstPos; pos >= 0 && pos < static_cast<int64_t>(bcsWithTVX.size()); pos++) {
+          int64_t thisFoundGlobalBC = bcsWithTVX.globalBC[pos];
+          int32_t thisFoundBCindex = bcsWithTVX.bcIndex[pos];
           auto bc = bcs.iteratorAt(thisFoundBCindex);
           int64_t thisTFid = (bc.globalBC() - bcSOR) / nBCsPerTF;
           if (thisTFid != tfId)
@@ -1422,7 +1484,6 @@ class EventSelectionModule
               sumAmpFT0CInFullTimeWindow += wOccup * multT0C;
             }
           }
-          it++;
         }
       }
 
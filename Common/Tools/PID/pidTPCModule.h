@@ -516,15 +516,17 @@ class pidTPCModule
     // To load the Hadronic rate once for each collision
     float hadronicRateBegin = 0.;
     std::vector<float> hadronicRateForCollision(collisions.size(), 0.0f);
-    size_t i = 0;
-    for (const auto& collision : collisions) {
-      const auto& bc = collision.template bc_as<B>();
-      if (irSource.compare("") != 0) {
-        hadronicRateForCollision[i] = mRateFetcher.fetch(ccdb.service, bc.timestamp(), bc.runNumber(), irSource) * 1.e-3;
-      } else {
-        hadronicRateForCollision[i] = 0.0f;
+    if (irSource.compare("") != 0 && collisions.size() > 0) {
+      std::vector<uint64_t> timestampsForCollision;
+      timestampsForCollision.reserve(collisions.size());
+      for (const auto& collision : collisions) {
+        timestampsForCollision.push_back(collision.template bc_as<B>().timestamp());
+      }
+      std::vector<double> rates(timestampsForCollision.size());
+      mRateFetcher.fetch(ccdb.service, timestampsForCollision, collisions.begin().template bc_as<B>().runNumber(), irSource, rates);
+      for (size_t i = 0; i < rates.size(); i++) {
+        hadronicRateForCollision[i] = rates[i] * 1.e-3;
       }
-      i++;
     }
     auto bc = bcs.begin();
     if (irSource.compare("") != 0) {
@@ -772,15 +774,17 @@ class pidTPCModule
     std::vector<float> hadronicRateForCollision(cols.size(), 0.0f);
     float hadronicRateBegin = 0.0f;
     if (pidTPCopts.useCorrecteddEdx) {
-      size_t i = 0;
-      for (const auto& collision : cols) {
-        const auto& bc = collision.template bc_as<aod::BCsWithTimestamps>();
-        if (irSource.compare("") != 0) {
-          hadronicRateForCollision[i] = mRateFetcher.fetch(ccdb.service, bc.timestamp(), bc.runNumber(), irSource) * 1.e-3;
-        } else {
-          hadronicRateForCollision[i] = 0.0f;
+      if (irSource.compare("") != 0 && cols.size() > 0) {
+        std::vector<uint64_t> timestampsForCollision;
+        timestampsForCollision.reserve(cols.size());
+        for (const auto& collision : cols) {
+          timestampsForCollision.push_back(collision.template bc_as<aod::BCsWithTimestamps>().timestamp());
+        }
+        std::vector<double> rates(timestampsForCollision.size());
+        mRateFetcher.fetch(ccdb.service, timestampsForCollision, cols.begin().template bc_as<aod::BCsWithTimestamps>().runNumber(), irSource, rates);
+        for (size_t i = 0; i < rates.size(); i++) {
+          hadronicRateForCollision[i] = rates[i] * 1.e-3;
         }
-        i++;
       }
       auto bc = bcs.begin();
       if (irSource.compare("") != 0) {
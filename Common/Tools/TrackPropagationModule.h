@@ -39,11 +39,15 @@
 #include <TH1.h>
 #include <TH2.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 //__________________________________________
 // track propagation module
@@ -76,6 +80,9 @@ struct TrackPropagationConfigurables : o2::framework::ConfigurableGroup {
   // for TrackTuner only (MC smearing)
   o2::framework::Configurable<bool> useTrackTuner{"useTrackTuner", false, "Apply track tuner corrections to MC"};
   o2::framework::Configurable<bool> useTrkPid{"useTrkPid", false, "use pid in tracking"};
+  o2::framework::Configurable<int> nThreads{"nThreads", 1, "Number of threads used for the track propagation (1: serial)"};
+  o2::framework::Configurable<int> minTracksPerThread{"minTracksPerThread", 1000, "Minimum number of tracks per thread in the parallel propagation"};
+  o2::framework::Configurable<bool> checkParallelPropagation{"checkParallelPropagation", false, "Propagate the tracks serially as well when running with several threads and abort if the results differ (validation only)"};
   o2::framework::Configurable<bool> fillTrackTunerTable{"fillTrackTunerTable", false, "flag to fill track tuner table"};
   o2::framework::Configurable<int> trackTunerConfigSource{"trackTunerConfigSource", aod::track_tuner::InputString, "1: input string; 2: TrackTuner Configurables"};
   o2::framework::Configurable<std::string> trackTunerParams{"trackTunerParams", "debugInfo=0|updateTrackDCAs=1|updateTrackCovMat=1|updateCurvature=0|updateCurvatureIU=0|updatePulls=0|isInputFileFromCCDB=1|pathInputFile=Users/m/mfaggin/test/inputsTrackTuner/PbPb2022|nameInputFile=trackTuner_DataLHC22sPass5_McLHC22l1b2_run529397.root|pathFileQoverPt=Users/h/hsharma/qOverPtGraphs|nameFileQoverPt=D0sigma_Data_removal_itstps_MC_LHC22b1b.root|usePvRefitCorrections=0|qOverPtMC=-1.|qOverPtData=-1.", "TrackTuner parameter initialization (format: <name>=<value>|<name>=<value>)"};
@@ -254,114 +261,360 @@ class TrackPropagationModule
       cursors.tunertable.reserve(tracks.size());
     }
 
-    for (const auto& track : tracks) {
-      if (fillTracksCov) {
-        if (fillTracksDCA || fillTracksDCACov) {
-          mDcaInfoCov.set(999, 999, 999, 999, 999);
-        }
-        setTrackParCov(track, mTrackParCov);
-        if (cGroup.useTrkPid.value) {
-          mTrackParCov.setPID(track.pidForTracking());
-        }
-      } else {
-        if (fillTracksDCA) {
-          mDcaInfo[0] = 999;
-          mDcaInfo[1] = 999;
-        }
-        setTrackPar(track, mTrackPar);
-        if (cGroup.useTrkPid.value) {
-          mTrackPar.setPID(track.pidForTracking());
-        }
+    if (cGroup.nThreads.value > 1 && tracks.size() >= 2 * std::max(1, cGroup.minTracksPerThread.value)) {
+      if (isParallelPropagationSafe()) {
+        fillTrackTablesParallel<isMc>(cGroup, trackTunerObj, ccdbLoader, collisions, tracks, cursors, registry);
+        return;
+      }
+      if (!mIsSerialFallbackReported) {
+        LOG(warning) << "Parallel track propagation requires the material LUT (or no material correction) and the fast magnetic field, propagating the tracks serially";
+        mIsSerialFallbackReported = true;
       }
-      // auto trackParCov = getTrackParCov(track);
+    }
+
+    for (const auto& track : tracks) {
       o2::aod::track::TrackTypeEnum trackType = (o2::aod::track::TrackTypeEnum)track.trackType();
-      // std::array<float, 3> trackPxPyPz;
-      // std::array<float, 3> trackPxPyPzTuned = {0.0, 0.0, 0.0};
       double q2OverPtNew = -9999.;
-      // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
-      if (track.trackType() == o2::aod::track::TrackIU && track.x() < cGroup.minPropagationRadius.value) {
-        if (fillTracksCov) {
-          if constexpr (isMc) { // checking MC and fillCovMat block begins
-            // bool hasMcParticle = track.has_mcParticle();
-            if (cGroup.useTrackTuner.value) {
-              trackTunedTracks->Fill(1); // all tracks
-              bool hasMcParticle = track.has_mcParticle();
-              if (hasMcParticle) {
-                auto mcParticle = track.mcParticle();
-                trackTunerObj.tuneTrackParams(mcParticle, mTrackParCov, matCorr, &mDcaInfoCov, trackTunedTracks);
-                q2OverPtNew = mTrackParCov.getQ2Pt();
-              }
-            }
-          } // MC and fillCovMat block ends
-        }
-        bool isPropagationOK = true;
-
-        if (track.has_collision()) {
-          auto const& collision = collisions.rawIteratorAt(track.collisionId());
-          if (fillTracksCov) {
-            mVtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
-            mVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
-          } else {
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, mTrackPar, 2.f, matCorr, &mDcaInfo);
-          }
-        } else {
-          if (fillTracksCov) {
-            mVtx.setPos({ccdbLoader.mMeanVtx->getX(), ccdbLoader.mMeanVtx->getY(), ccdbLoader.mMeanVtx->getZ()});
-            mVtx.setCov(ccdbLoader.mMeanVtx->getSigmaX() * ccdbLoader.mMeanVtx->getSigmaX(), 0.0f, ccdbLoader.mMeanVtx->getSigmaY() * ccdbLoader.mMeanVtx->getSigmaY(), 0.0f, 0.0f, ccdbLoader.mMeanVtx->getSigmaZ() * ccdbLoader.mMeanVtx->getSigmaZ());
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
-          } else {
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({ccdbLoader.mMeanVtx->getX(), ccdbLoader.mMeanVtx->getY(), ccdbLoader.mMeanVtx->getZ()}, mTrackPar, 2.f, matCorr, &mDcaInfo);
-          }
+      if (cGroup.useTrackTuner.value && fillTracksCov && track.trackType() == o2::aod::track::TrackIU && track.x() < cGroup.minPropagationRadius.value) {
+        if constexpr (isMc) {
+          trackTunedTracks->Fill(1); // all tracks
         }
-        if (isPropagationOK) {
-          trackType = o2::aod::track::Track;
-        }
-        // filling some QA histograms for track tuner test purpose
-        if (fillTracksCov) {
-          if constexpr (isMc) { // checking MC and fillCovMat block begins
-            if (track.has_mcParticle() && isPropagationOK) {
-              auto mcParticle1 = track.mcParticle();
-              // && abs(mcParticle1.pdgCode())==211
-              if (mcParticle1.isPhysicalPrimary()) {
-                registry.fill(HIST("hDCAxyVsPtRec"), mDcaInfoCov.getY(), mTrackParCov.getPt());
-                registry.fill(HIST("hDCAxyVsPtMC"), mDcaInfoCov.getY(), mcParticle1.pt());
-                registry.fill(HIST("hDCAzVsPtRec"), mDcaInfoCov.getZ(), mTrackParCov.getPt());
-                registry.fill(HIST("hDCAzVsPtMC"), mDcaInfoCov.getZ(), mcParticle1.pt());
-              }
+      }
+      bool isPropagationOK = propagateTrack<isMc>(cGroup, trackTunerObj, ccdbLoader, collisions, track, trackTunedTracks, mTrackPar, mTrackParCov, mDcaInfo, mDcaInfoCov, mVtx, trackType, q2OverPtNew);
+      // filling some QA histograms for track tuner test purpose
+      if (fillTracksCov) {
+        if constexpr (isMc) { // checking MC and fillCovMat block begins
+          if (isPropagationOK && track.has_mcParticle()) {
+            auto mcParticle1 = track.mcParticle();
+            // && abs(mcParticle1.pdgCode())==211
+            if (mcParticle1.isPhysicalPrimary()) {
+              registry.fill(HIST("hDCAxyVsPtRec"), mDcaInfoCov.getY(), mTrackParCov.getPt());
+              registry.fill(HIST("hDCAxyVsPtMC"), mDcaInfoCov.getY(), mcParticle1.pt());
+              registry.fill(HIST("hDCAzVsPtRec"), mDcaInfoCov.getZ(), mTrackParCov.getPt());
+              registry.fill(HIST("hDCAzVsPtMC"), mDcaInfoCov.getZ(), mcParticle1.pt());
             }
-          } // MC and fillCovMat block ends
-        }
+          }
+        } // MC and fillCovMat block ends
       }
       // Filling modified Q/Pt values at IU/production point by track tuner in track tuner table
       if (cGroup.useTrackTuner.value && cGroup.fillTrackTunerTable.value) {
         cursors.tunertable(q2OverPtNew);
       }
       // LOG(info) <<  " trackPropagation (this value filled in tuner table)--> "  << q2OverPtNew;
+      fillTrackRow(cursors, track.collisionId(), trackType, mTrackPar, mTrackParCov, mDcaInfo, mDcaInfoCov);
+    }
+  }
+
+ private:
+  // per-worker QA counts of the track tuner, replayed into trackTunedTracks
+  // after the workers joined (TH1::Fill is not thread safe)
+  struct TunerQACounts {
+    std::array<int, 5> counts{};
+    void Fill(int bin) { counts[bin]++; }
+  };
+
+  // per-track results of the parallel propagation, appended to the cursors
+  // in track order once all workers are done
+  std::vector<o2::track::TrackParametrization<float>> mTrackParBuffer;
+  std::vector<o2::track::TrackParametrizationWithError<float>> mTrackParCovBuffer;
+  std::vector<std::array<float, 2>> mDcaInfoBuffer;
+  std::vector<o2::dataformats::DCA> mDcaInfoCovBuffer;
+  std::vector<o2::aod::track::TrackTypeEnum> mTrackTypeBuffer;
+  std::vector<double> mQ2OverPtBuffer;
+  std::vector<uint8_t> mIsPropagatedBuffer;
+  bool mIsSerialFallbackReported = false;
+
+  /// The workers share the propagator singleton, also used by the track tuner. This is only safe when
+  /// the material correction comes from the LUT or is disabled (TGeo navigation is not thread safe)
+  /// and the field from the fast parameterisation (the full field map caches its state).
+  bool isParallelPropagationSafe() const
+  {
+    auto const* propagator = o2::base::Propagator::Instance();
+    const bool isMatCorrSafe = matCorr == o2::base::Propagator::MatCorrType::USEMatCorrNONE ||
+                               (matCorr == o2::base::Propagator::MatCorrType::USEMatCorrLUT && propagator->getMatLUT() != nullptr);
+    return isMatCorrSafe && propagator->getFieldFast() != nullptr;
+  }
+
+  /// propagates one track to its collision (or to the mean vertex), applying the track tuner
+  /// to MC tracks if requested. Only touches the state passed by reference, so that it can be
+  /// called concurrently by several workers with their own state.
+  template <bool isMc, typename TConfigurableGroup, typename TCCDBLoader, typename TCollisions, typename TTrack, typename THisto>
+  bool propagateTrack(TConfigurableGroup const& cGroup, TrackTuner& trackTunerObj, TCCDBLoader const& ccdbLoader, TCollisions const& collisions, TTrack const& track, THisto& hTunerQA,
+                      o2::track::TrackParametrization<float>& trackPar, o2::track::TrackParametrizationWithError<float>& trackParCov,
+                      std::array<float, 2>& dcaInfo, o2::dataformats::DCA& dcaInfoCov, o2::dataformats::VertexBase& vtx,
+                      o2::aod::track::TrackTypeEnum& trackType, double& q2OverPtNew) const
+  {
+    if (fillTracksCov) {
+      if (fillTracksDCA || fillTracksDCACov) {
+        dcaInfoCov.set(999, 999, 999, 999, 999);
+      }
+      setTrackParCov(track, trackParCov);
+      if (cGroup.useTrkPid.value) {
+        trackParCov.setPID(track.pidForTracking());
+      }
+    } else {
+      if (fillTracksDCA) {
+        dcaInfo[0] = 999;
+        dcaInfo[1] = 999;
+      }
+      setTrackPar(track, trackPar);
+      if (cGroup.useTrkPid.value) {
+        trackPar.setPID(track.pidForTracking());
+      }
+    }
+    // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
+    if (track.trackType() != o2::aod::track::TrackIU || track.x() >= cGroup.minPropagationRadius.value) {
+      return false;
+    }
+    if (fillTracksCov) {
+      if constexpr (isMc) { // checking MC and fillCovMat block begins
+        if (cGroup.useTrackTuner.value && track.has_mcParticle()) {
+          auto mcParticle = track.mcParticle();
+          trackTunerObj.tuneTrackParams(mcParticle, trackParCov, matCorr, &dcaInfoCov, hTunerQA);
+          q2OverPtNew = trackParCov.getQ2Pt();
+        }
+      } // MC and fillCovMat block ends
+    }
+    bool isPropagationOK = true;
+
+    if (track.has_collision()) {
+      auto const& collision = collisions.rawIteratorAt(track.collisionId());
       if (fillTracksCov) {
-        cursors.tracksParPropagated(track.collisionId(), trackType, mTrackParCov.getX(), mTrackParCov.getAlpha(), mTrackParCov.getY(), mTrackParCov.getZ(), mTrackParCov.getSnp(), mTrackParCov.getTgl(), mTrackParCov.getQ2Pt());
-        cursors.tracksParExtensionPropagated(mTrackParCov.getPt(), mTrackParCov.getP(), mTrackParCov.getEta(), mTrackParCov.getPhi());
-        // TODO do we keep the rho as 0? Also the sigma's are duplicated information
-        cursors.tracksParCovPropagated(std::sqrt(mTrackParCov.getSigmaY2()), std::sqrt(mTrackParCov.getSigmaZ2()), std::sqrt(mTrackParCov.getSigmaSnp2()),
-                                       std::sqrt(mTrackParCov.getSigmaTgl2()), std::sqrt(mTrackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-        cursors.tracksParCovExtensionPropagated(mTrackParCov.getSigmaY2(), mTrackParCov.getSigmaZY(), mTrackParCov.getSigmaZ2(), mTrackParCov.getSigmaSnpY(),
-                                                mTrackParCov.getSigmaSnpZ(), mTrackParCov.getSigmaSnp2(), mTrackParCov.getSigmaTglY(), mTrackParCov.getSigmaTglZ(), mTrackParCov.getSigmaTglSnp(),
-                                                mTrackParCov.getSigmaTgl2(), mTrackParCov.getSigma1PtY(), mTrackParCov.getSigma1PtZ(), mTrackParCov.getSigma1PtSnp(), mTrackParCov.getSigma1PtTgl(),
-                                                mTrackParCov.getSigma1Pt2());
-        if (fillTracksDCA) {
-          cursors.tracksDCA(mDcaInfoCov.getY(), mDcaInfoCov.getZ());
+        vtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
+        vtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+        isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackParCov, 2.f, matCorr, &dcaInfoCov);
+      } else {
+        isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackPar, 2.f, matCorr, &dcaInfo);
+      }
+    } else {
+      if (fillTracksCov) {
+        vtx.setPos({ccdbLoader.mMeanVtx->getX(), ccdbLoader.mMeanVtx->getY(), ccdbLoader.mMeanVtx->getZ()});
+        vtx.setCov(ccdbLoader.mMeanVtx->getSigmaX() * ccdbLoader.mMeanVtx->getSigmaX(), 0.0f, ccdbLoader.mMeanVtx->getSigmaY() * ccdbLoader.mMeanVtx->getSigmaY(), 0.0f, 0.0f, ccdbLoader.mMeanVtx->getSigmaZ() * ccdbLoader.mMeanVtx->getSigmaZ());
+        isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackParCov, 2.f, matCorr, &dcaInfoCov);
+      } else {
+        isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({ccdbLoader.mMeanVtx->getX(), ccdbLoader.mMeanVtx->getY(), ccdbLoader.mMeanVtx->getZ()}, trackPar, 2.f, matCorr, &dcaInfo);
+      }
+    }
+    if (isPropagationOK) {
+      trackType = o2::aod::track::Track;
+    }
+    return isPropagationOK;
+  }
+
+  template <typename TOutputGroup>
+  void fillTrackRow(TOutputGroup& cursors, int collisionId, o2::aod::track::TrackTypeEnum trackType,
+                    o2::track::TrackParametrization<float> const& trackPar, o2::track::TrackParametrizationWithError<float> const& trackParCov,
+                    std::array<float, 2> const& dcaInfo, o2::dataformats::DCA const& dcaInfoCov)
+  {
+    if (fillTracksCov) {
+      cursors.tracksParPropagated(collisionId, trackType, trackParCov.getX(), trackParCov.getAlpha(), trackParCov.getY(), trackParCov.getZ(), trackParCov.getSnp(), trackParCov.getTgl(), trackParCov.getQ2Pt());
+      cursors.tracksParExtensionPropagated(trackParCov.getPt(), trackParCov.getP(), trackParCov.getEta(), trackParCov.getPhi());
+      // TODO do we keep the rho as 0? Also the sigma's are duplicated information
+      cursors.tracksParCovPropagated(std::sqrt(trackParCov.getSigmaY2()), std::sqrt(trackParCov.getSigmaZ2()), std::sqrt(trackParCov.getSigmaSnp2()),
+                                     std::sqrt(trackParCov.getSigmaTgl2()), std::sqrt(trackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+      cursors.tracksParCovExtensionPropagated(trackParCov.getSigmaY2(), trackParCov.getSigmaZY(), trackParCov.getSigmaZ2(), trackParCov.getSigmaSnpY(),
+                                              trackParCov.getSigmaSnpZ(), trackParCov.getSigmaSnp2(), trackParCov.getSigmaTglY(), trackParCov.getSigmaTglZ(), trackParCov.getSigmaTglSnp(),
+                                              trackParCov.getSigmaTgl2(), trackParCov.getSigma1PtY(), trackParCov.getSigma1PtZ(), trackParCov.getSigma1PtSnp(), trackParCov.getSigma1PtTgl(),
+                                              trackParCov.getSigma1Pt2());
+      if (fillTracksDCA) {
+        cursors.tracksDCA(dcaInfoCov.getY(), dcaInfoCov.getZ());
+      }
+      if (fillTracksDCACov) {
+        cursors.tracksDCACov(dcaInfoCov.getSigmaY2(), dcaInfoCov.getSigmaZ2());
+      }
+    } else {
+      cursors.tracksParPropagated(collisionId, trackType, trackPar.getX(), trackPar.getAlpha(), trackPar.getY(), trackPar.getZ(), trackPar.getSnp(), trackPar.getTgl(), trackPar.getQ2Pt());
+      cursors.tracksParExtensionPropagated(trackPar.getPt(), trackPar.getP(), trackPar.getEta(), trackPar.getPhi());
+      if (fillTracksDCA) {
+        cursors.tracksDCA(dcaInfo[0], dcaInfo[1]);
+      }
+    }
+  }
+
+  /// Parallel version of the propagation loop: the tracks are split in contiguous chunks,
+  /// each propagated by a worker thread with its own track/DCA/vertex state into the pre-sized
+  /// buffers above. The rows, the track tuner counters and the QA histograms are then filled
+  /// serially in track order, so that the output is identical to the serial loop.
+  /// Only used if isParallelPropagationSafe(). The track tuner QA is counted per worker
+  /// (TunerQACounts) and never filled into the shared histogram by the workers.
+  template <bool isMc, typename TConfigurableGroup, typename TCCDBLoader, typename TCollisions, typename TTracks, typename TOutputGroup, typename THistoRegistry>
+  void fillTrackTablesParallel(TConfigurableGroup const& cGroup, TrackTuner& trackTunerObj, TCCDBLoader const& ccdbLoader, TCollisions const& collisions, TTracks const& tracks, TOutputGroup& cursors, THistoRegistry& registry)
+  {
+    const int64_t nTracks = tracks.size();
+    const int64_t nWorkers = std::min<int64_t>(cGroup.nThreads.value, nTracks / std::max(1, cGroup.minTracksPerThread.value));
+    const int64_t chunkSize = (nTracks + nWorkers - 1) / nWorkers;
+
+    if (fillTracksCov) {
+      mTrackParCovBuffer.resize(nTracks);
+      mDcaInfoCovBuffer.resize(nTracks);
+    } else {
+      mTrackParBuffer.resize(nTracks);
+      mDcaInfoBuffer.resize(nTracks);
+    }
+    mTrackTypeBuffer.resize(nTracks);
+    mQ2OverPtBuffer.resize(nTracks);
+    mIsPropagatedBuffer.resize(nTracks);
+    std::vector<TunerQACounts> tunerQA(nWorkers);
+
+    auto propagateChunk = [&](int64_t iWorker) {
+      const int64_t first = iWorker * chunkSize;
+      const int64_t last = std::min(first + chunkSize, nTracks);
+      o2::track::TrackParametrization<float> trackPar;
+      o2::track::TrackParametrizationWithError<float> trackParCov;
+      std::array<float, 2> dcaInfo{};
+      o2::dataformats::DCA dcaInfoCov;
+      o2::dataformats::VertexBase vtx;
+      TunerQACounts* hTunerQA = &tunerQA[iWorker];
+      auto track = tracks.rawIteratorAt(first);
+      for (int64_t iTrack = first; iTrack < last; ++iTrack, ++track) {
+        auto trackType = (o2::aod::track::TrackTypeEnum)track.trackType();
+        double q2OverPtNew = -9999.;
+        if (cGroup.useTrackTuner.value && fillTracksCov && track.trackType() == o2::aod::track::TrackIU && track.x() < cGroup.minPropagationRadius.value) {
+          if constexpr (isMc) {
+            hTunerQA->Fill(1); // all tracks
+          }
         }
-        if (fillTracksDCACov) {
-          cursors.tracksDCACov(mDcaInfoCov.getSigmaY2(), mDcaInfoCov.getSigmaZ2());
+        mIsPropagatedBuffer[iTrack] = propagateTrack<isMc>(cGroup, trackTunerObj, ccdbLoader, collisions, track, hTunerQA, trackPar, trackParCov, dcaInfo, dcaInfoCov, vtx, trackType, q2OverPtNew);
+        if (fillTracksCov) {
+          mTrackParCovBuffer[iTrack] = trackParCov;
+          mDcaInfoCovBuffer[iTrack] = dcaInfoCov;
+        } else {
+          mTrackParBuffer[iTrack] = trackPar;
+          mDcaInfoBuffer[iTrack] = dcaInfo;
         }
-      } else {
-        cursors.tracksParPropagated(track.collisionId(), trackType, mTrackPar.getX(), mTrackPar.getAlpha(), mTrackPar.getY(), mTrackPar.getZ(), mTrackPar.getSnp(), mTrackPar.getTgl(), mTrackPar.getQ2Pt());
-        cursors.tracksParExtensionPropagated(mTrackPar.getPt(), mTrackPar.getP(), mTrackPar.getEta(), mTrackPar.getPhi());
-        if (fillTracksDCA) {
-          cursors.tracksDCA(mDcaInfo[0], mDcaInfo[1]);
+        mTrackTypeBuffer[iTrack] = trackType;
+        mQ2OverPtBuffer[iTrack] = q2OverPtNew;
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(nWorkers - 1);
+    for (int64_t iWorker = 1; iWorker < nWorkers; iWorker++) {
+      workers.emplace_back(propagateChunk, iWorker);
+    }
+    propagateChunk(0);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    if constexpr (isMc) {
+      for (const auto& counts : tunerQA) {
+        for (std::size_t bin = 0; bin < counts.counts.size(); bin++) {
+          for (int iFill = 0; iFill < counts.counts[bin]; iFill++) {
+            trackTunedTracks->Fill(static_cast<int>(bin));
+          }
         }
       }
     }
+
+    if (cGroup.checkParallelPropagation.value) {
+      checkParallelPropagation<isMc>(cGroup, trackTunerObj, ccdbLoader, collisions, tracks);
+    }
+
+    o2::track::TrackParametrization<float> const emptyPar;
+    o2::track::TrackParametrizationWithError<float> const emptyParCov;
+    std::array<float, 2> const emptyDcaInfo{};
+    o2::dataformats::DCA const emptyDcaInfoCov;
+    int64_t iTrack = 0;
+    for (const auto& track : tracks) {
+      // filling some QA histograms for track tuner test purpose
+      if (fillTracksCov) {
+        if constexpr (isMc) { // checking MC and fillCovMat block begins
+          if (mIsPropagatedBuffer[iTrack] && track.has_mcParticle()) {
+            auto mcParticle1 = track.mcParticle();
+            if (mcParticle1.isPhysicalPrimary()) {
+              registry.fill(HIST("hDCAxyVsPtRec"), mDcaInfoCovBuffer[iTrack].getY(), mTrackParCovBuffer[iTrack].getPt());
+              registry.fill(HIST("hDCAxyVsPtMC"), mDcaInfoCovBuffer[iTrack].getY(), mcParticle1.pt());
+              registry.fill(HIST("hDCAzVsPtRec"), mDcaInfoCovBuffer[iTrack].getZ(), mTrackParCovBuffer[iTrack].getPt());
+              registry.fill(HIST("hDCAzVsPtMC"), mDcaInfoCovBuffer[iTrack].getZ(), mcParticle1.pt());
+            }
+          }
+        } // MC and fillCovMat block ends
+      }
+      if (cGroup.useTrackTuner.value && cGroup.fillTrackTunerTable.value) {
+        cursors.tunertable(mQ2OverPtBuffer[iTrack]);
+      }
+      if (fillTracksCov) {
+        fillTrackRow(cursors, track.collisionId(), mTrackTypeBuffer[iTrack], emptyPar, mTrackParCovBuffer[iTrack], emptyDcaInfo, mDcaInfoCovBuffer[iTrack]);
+      } else {
+        fillTrackRow(cursors, track.collisionId(), mTrackTypeBuffer[iTrack], mTrackParBuffer[iTrack], emptyParCov, mDcaInfoBuffer[iTrack], emptyDcaInfoCov);
+      }
+      iTrack++;
+    }
+  }
+
+  static bool isSameValue(double a, double b)
+  {
+    return a == b || (std::isnan(a) && std::isnan(b));
+  }
+
+  static bool isSameTrackPar(o2::track::TrackParametrization<float> const& a, o2::track::TrackParametrization<float> const& b)
+  {
+    if (!isSameValue(a.getX(), b.getX()) || !isSameValue(a.getAlpha(), b.getAlpha()) || a.getPID() != b.getPID()) {
+      return false;
+    }
+    for (int iPar = 0; iPar < o2::track::kNParams; iPar++) {
+      if (!isSameValue(a.getParams()[iPar], b.getParams()[iPar])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool isSameTrackParCov(o2::track::TrackParametrizationWithError<float> const& a, o2::track::TrackParametrizationWithError<float> const& b)
+  {
+    if (!isSameTrackPar(a, b)) {
+      return false;
+    }
+    for (int iCov = 0; iCov < o2::track::kCovMatSize; iCov++) {
+      if (!isSameValue(a.getCov()[iCov], b.getCov()[iCov])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool isSameDcaInfoCov(o2::dataformats::DCA const& a, o2::dataformats::DCA const& b)
+  {
+    return isSameValue(a.getY(), b.getY()) && isSameValue(a.getZ(), b.getZ()) &&
+           isSameValue(a.getSigmaY2(), b.getSigmaY2()) && isSameValue(a.getSigmaYZ(), b.getSigmaYZ()) && isSameValue(a.getSigmaZ2(), b.getSigmaZ2());
+  }
+
+  /// Validation of the parallel propagation: the tracks are propagated again in track order on the
+  /// calling thread and compared with the buffers filled by the workers, i.e. the rows that are
+  /// about to be written. Any difference is reported per row and the task aborts.
+  template <bool isMc, typename TConfigurableGroup, typename TCCDBLoader, typename TCollisions, typename TTracks>
+  void checkParallelPropagation(TConfigurableGroup const& cGroup, TrackTuner& trackTunerObj, TCCDBLoader const& ccdbLoader, TCollisions const& collisions, TTracks const& tracks) const
+  {
+    o2::track::TrackParametrization<float> trackPar;
+    o2::track::TrackParametrizationWithError<float> trackParCov;
+    std::array<float, 2> dcaInfo{};
+    o2::dataformats::DCA dcaInfoCov;
+    o2::dataformats::VertexBase vtx;
+    TunerQACounts tunerQA; // not replayed, the counts were taken by the workers
+    TunerQACounts* hTunerQA = &tunerQA;
+    int64_t nMismatches = 0;
+    int64_t iTrack = 0;
+    for (const auto& track : tracks) {
+      auto trackType = (o2::aod::track::TrackTypeEnum)track.trackType();
+      double q2OverPtNew = -9999.;
+      const bool isPropagated = propagateTrack<isMc>(cGroup, trackTunerObj, ccdbLoader, collisions, track, hTunerQA, trackPar, trackParCov, dcaInfo, dcaInfoCov, vtx, trackType, q2OverPtNew);
+      bool isSame = isPropagated == static_cast<bool>(mIsPropagatedBuffer[iTrack]) && trackType == mTrackTypeBuffer[iTrack] && isSameValue(q2OverPtNew, mQ2OverPtBuffer[iTrack]);
+      if (fillTracksCov) {
+        isSame = isSame && isSameTrackParCov(trackParCov, mTrackParCovBuffer[iTrack]) && isSameDcaInfoCov(dcaInfoCov, mDcaInfoCovBuffer[iTrack]);
+      } else {
+        isSame = isSame && isSameTrackPar(trackPar, mTrackParBuffer[iTrack]) && isSameValue(dcaInfo[0], mDcaInfoBuffer[iTrack][0]) && isSameValue(dcaInfo[1], mDcaInfoBuffer[iTrack][1]);
+      }
+      if (!isSame) {
+        LOG(error) << "Parallel and serial track propagation differ for track row " << iTrack << " (global index " << track.globalIndex() << ")";
+        nMismatches++;
+      }
+      iTrack++;
+    }
+    if (nMismatches > 0) {
+      LOG(fatal) << "Parallel track propagation differs from the serial one for " << nMismatches << " of " << iTrack << " tracks";
+    }
+    LOG(info) << "Parallel track propagation checked against the serial one for " << iTrack << " tracks";
   }
 };
 
@@ -25,6 +25,8 @@
 #include <Framework/AnalysisDataModel.h>
 #include <Framework/Configurable.h>
 #include <Framework/runDataProcessing.h>
+#include <ReconstructionDataFormats/DCA.h>
+#include <ReconstructionDataFormats/TrackParametrizationWithError.h>
 #include <ReconstructionDataFormats/Vertex.h>
 
 #include <TDirectory.h>
@@ -36,9 +38,12 @@
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -125,6 +130,28 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
   std::vector<std::unique_ptr<TGraphErrors>> grDcaZPullVsPtPionMC;
   std::vector<std::unique_ptr<TGraphErrors>> grDcaZPullVsPtPionData;
 
+  /// quantities tabulated in the pT x phi lookup tables
+  enum LutQuantity : int { kDcaXYResMC = 0,
+                           kDcaXYResData,
+                           kDcaZResMC,
+                           kDcaZResData,
+                           kDcaXYMeanMC,
+                           kDcaXYMeanData,
+                           kDcaXYPullMC,
+                           kDcaXYPullData,
+                           kDcaZPullMC,
+                           kDcaZPullData,
+                           kOneOverPtMC,
+                           kOneOverPtData,
+                           kNLutQuantities };
+
+  /// The graphs are linear interpolations clamped at their first and last point. They are
+  /// sampled at the union of their pT abscissae, so that a linear interpolation of the table
+  /// reproduces them, and evaluated for all quantities with a single binary search per track
+  std::vector<double> lutPtKnots;
+  std::vector<double> lutValues;    // [phiBin][knot][quantity]
+  std::vector<uint8_t> lutHasGraph; // [phiBin][quantity], 0 if the graph was not loaded
+
   /// @brief Function to initialize the run number to that of the 1st considered bunch crossing (useful only if autoDetectDcaCalib = true)
   void setRunNumber(int n)
   {
@@ -713,11 +740,113 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
       grOneOverPtPionData.reset(dynamic_cast<TGraphErrors*>(ccdb_object_qoverpt->FindObject(grOneOverPtPionNameData.c_str())));
     }
 
+    buildLookupTables();
+
     /// if we arrive here, it means that the graphs are all set
     areGraphsConfigured = true;
 
   } // getDcaGraphs() ends here
 
+  /// graph tabulated for a given quantity and phi bin (nullptr if not loaded)
+  const TGraphErrors* getLutGraph(int quantity, int phiBin) const
+  {
+    switch (quantity) {
+      case kDcaXYResMC:
+        return grDcaXYResVsPtPionMC[phiBin].get();
+      case kDcaXYResData:
+        return grDcaXYResVsPtPionData[phiBin].get();
+      case kDcaZResMC:
+        return grDcaZResVsPtPionMC[phiBin].get();
+      case kDcaZResData:
+        return grDcaZResVsPtPionData[phiBin].get();
+      case kDcaXYMeanMC:
+        return grDcaXYMeanVsPtPionMC[phiBin].get();
+      case kDcaXYMeanData:
+        return grDcaXYMeanVsPtPionData[phiBin].get();
+      case kDcaXYPullMC:
+        return grDcaXYPullVsPtPionMC[phiBin].get();
+      case kDcaXYPullData:
+        return grDcaXYPullVsPtPionData[phiBin].get();
+      case kDcaZPullMC:
+        return grDcaZPullVsPtPionMC[phiBin].get();
+      case kDcaZPullData:
+        return grDcaZPullVsPtPionData[phiBin].get();
+      case kOneOverPtMC:
+        return grOneOverPtPionMC.get();
+      case kOneOverPtData:
+        return grOneOverPtPionData.get();
+      default:
+        return nullptr;
+    }
+  }
+
+  /// resample the correction graphs into the dense pT x phi lookup tables
+  void buildLookupTables()
+  {
+    lutPtKnots.clear();
+    for (int iPhiBin = 0; iPhiBin < nPhiBins; ++iPhiBin) {
+      for (int iQuantity = 0; iQuantity < kNLutQuantities; ++iQuantity) {
+        const TGraphErrors* graph = getLutGraph(iQuantity, iPhiBin);
+        if (graph) {
+          lutPtKnots.insert(lutPtKnots.end(), graph->GetX(), graph->GetX() + graph->GetN());
+        }
+      }
+    }
+    std::sort(lutPtKnots.begin(), lutPtKnots.end());
+    lutPtKnots.erase(std::unique(lutPtKnots.begin(), lutPtKnots.end()), lutPtKnots.end());
+
+    const std::size_t nKnots = lutPtKnots.size();
+    lutValues.assign(nPhiBins * nKnots * kNLutQuantities, 0.);
+    lutHasGraph.assign(nPhiBins * kNLutQuantities, 0);
+    for (int iPhiBin = 0; iPhiBin < nPhiBins; ++iPhiBin) {
+      for (int iQuantity = 0; iQuantity < kNLutQuantities; ++iQuantity) {
+        const TGraphErrors* graph = getLutGraph(iQuantity, iPhiBin);
+        if (!graph) {
+          continue;
+        }
+        lutHasGraph[iPhiBin * kNLutQuantities + iQuantity] = 1;
+        for (std::size_t iKnot = 0; iKnot < nKnots; ++iKnot) {
+          lutValues[(iPhiBin * nKnots + iKnot) * kNLutQuantities + iQuantity] = evalGraph(lutPtKnots[iKnot], graph);
+        }
+      }
+    }
+    LOG(info) << "[TrackTuner] Correction graphs tabulated in " << nPhiBins << " phi bins x " << nKnots << " pT knots";
+  }
+
+  /// evaluate all the tabulated quantities at a given pT in a given phi bin
+  void evalLookupTables(double pt, int phiBin, std::array<double, kNLutQuantities>& values) const
+  {
+    const std::size_t nKnots = lutPtKnots.size();
+    if (nKnots == 0) {
+      values.fill(0.);
+      return;
+    }
+    const double* table = lutValues.data() + phiBin * nKnots * kNLutQuantities;
+    const auto up = std::upper_bound(lutPtKnots.begin(), lutPtKnots.end(), pt) - lutPtKnots.begin();
+    if (up == 0 || static_cast<std::size_t>(up) == nKnots || lutPtKnots[up - 1] == pt) {
+      // clamped or exactly on a knot
+      const double* row = table + (up == 0 ? 0 : up - 1) * kNLutQuantities;
+      std::copy(row, row + kNLutQuantities, values.begin());
+      return;
+    }
+    const double* rowLow = table + (up - 1) * kNLutQuantities;
+    const double* rowUp = rowLow + kNLutQuantities;
+    const double frac = (pt - lutPtKnots[up - 1]) / (lutPtKnots[up] - lutPtKnots[up - 1]);
+    for (int iQuantity = 0; iQuantity < kNLutQuantities; ++iQuantity) {
+      values[iQuantity] = rowLow[iQuantity] + frac * (rowUp[iQuantity] - rowLow[iQuantity]);
+    }
+  }
+
+  /// tabulated value of a quantity, failing as evalGraph() if its graph was not loaded
+  double getLutValue(std::array<double, kNLutQuantities> const& values, int quantity, int phiBin) const
+  {
+    if (!lutHasGraph[phiBin * kNLutQuantities + quantity]) {
+      LOG(fatal) << "\t evalGraph fails !\n";
+      return 0.;
+    }
+    return values[quantity];
+  }
+
   template <typename T1, typename T2, typename T3, typename T4, typename H>
   void tuneTrackParams(T1 const& mcparticle, T2& trackParCov, T3 const& matCorr, T4 dcaInfoCov, H hQA)
   {
@@ -748,11 +877,14 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
       phiMC += o2::constants::math::TwoPI;                                    // 2 * std::numbers::pi;//
     int phiBin = phiMC / (o2::constants::math::TwoPI + 0.0000001) * nPhiBins; // 0.0000001 just a numerical protection
 
-    dcaXYResMC = evalGraph(ptMC, grDcaXYResVsPtPionMC[phiBin].get());
-    dcaXYResData = evalGraph(ptMC, grDcaXYResVsPtPionData[phiBin].get());
+    std::array<double, kNLutQuantities> lut{};
+    evalLookupTables(ptMC, phiBin, lut);
+
+    dcaXYResMC = getLutValue(lut, kDcaXYResMC, phiBin);
+    dcaXYResData = getLutValue(lut, kDcaXYResData, phiBin);
 
-    dcaZResMC = evalGraph(ptMC, grDcaZResVsPtPionMC[phiBin].get());
-    dcaZResData = evalGraph(ptMC, grDcaZResVsPtPionData[phiBin].get());
+    dcaZResMC = getLutValue(lut, kDcaZResMC, phiBin);
+    dcaZResData = getLutValue(lut, kDcaZResData, phiBin);
 
     // Local Q/Pt resolution: either the constant configurable value, or evaluated per-track from graphs
     double smearQOverPtMC = qOverPtMC;
@@ -763,8 +895,8 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
         if (!grOneOverPtPionData.get() || !grOneOverPtPionMC.get()) {
           LOG(fatal) << "### q/pt smearing: input graphs not correctly retrieved. Aborting.";
         }
-        smearQOverPtMC = std::max(0.0, evalGraph(ptMC, grOneOverPtPionMC.get()));
-        smearQOverPtData = std::max(0.0, evalGraph(ptMC, grOneOverPtPionData.get()));
+        smearQOverPtMC = std::max(0.0, getLutValue(lut, kOneOverPtMC, phiBin));
+        smearQOverPtData = std::max(0.0, getLutValue(lut, kOneOverPtData, phiBin));
         if (debugInfo) {
           LOG(info) << "### q/pt graph-based smearing: pT=" << ptMC
                     << " sigma(1/pT)_MC=" << smearQOverPtMC
@@ -776,14 +908,14 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
 
     if (updateTrackDCAs) {
 
-      dcaXYMeanMC = evalGraph(ptMC, grDcaXYMeanVsPtPionMC[phiBin].get());
-      dcaXYMeanData = evalGraph(ptMC, grDcaXYMeanVsPtPionData[phiBin].get());
+      dcaXYMeanMC = getLutValue(lut, kDcaXYMeanMC, phiBin);
+      dcaXYMeanData = getLutValue(lut, kDcaXYMeanData, phiBin);
 
-      dcaXYPullMC = evalGraph(ptMC, grDcaXYPullVsPtPionMC[phiBin].get());
-      dcaXYPullData = evalGraph(ptMC, grDcaXYPullVsPtPionData[phiBin].get());
+      dcaXYPullMC = getLutValue(lut, kDcaXYPullMC, phiBin);
+      dcaXYPullData = getLutValue(lut, kDcaXYPullData, phiBin);
 
-      dcaZPullMC = evalGraph(ptMC, grDcaZPullVsPtPionMC[phiBin].get());
-      dcaZPullData = evalGraph(ptMC, grDcaZPullVsPtPionData[phiBin].get());
+      dcaZPullMC = getLutValue(lut, kDcaZPullMC, phiBin);
+      dcaZPullData = getLutValue(lut, kDcaZPullData, phiBin);
     }
     //  Unit conversion, is it required ??
     dcaXYResMC *= 1.e-4;
@@ -1152,6 +1284,15 @@ struct TrackTuner : o2::framework::ConfigurableGroup {
     }
   } // tuneTrackParams() ends here
 
+  /// batch version of tuneTrackParams(): tracks[i] and dcaInfoCovs[i] are tuned according to mcParticles[i]
+  template <typename TMcParticles, typename T3, typename H>
+  void tuneTracks(TMcParticles const& mcParticles, std::span<o2::track::TrackParametrizationWithError<float>> tracks, T3 const& matCorr, std::span<o2::dataformats::DCA> dcaInfoCovs, H hQA)
+  {
+    for (std::size_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
+      tuneTrackParams(mcParticles[iTrack], tracks[iTrack], matCorr, &dcaInfoCovs[iTrack], hQA);
+    }
+  }
+
   // to be declared
   // ---------------
   // int getPhiBin(double phi) const
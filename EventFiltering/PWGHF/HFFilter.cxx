@@ -483,6 +483,7 @@ struct HfFilter { // Main struct for HF triggers
                aod::V0PhotonsKF const& photons,
                aod::V0Legs const&)
   {
+    bool isTpcPidEvaluated{false}; // recalibrated TPC PID of the tracks of this dataframe
     for (const auto& collision : collisions) {
 
       // all processed collisions
@@ -533,6 +534,13 @@ struct HfFilter { // Main struct for HF triggers
         }
 
         currentRun = bc.runNumber();
+        isTpcPidEvaluated = false;
+      }
+
+      // TPC PID recalibrations evaluated once for all the tracks, then shared by all the selections
+      if (setTPCCalib > 0 && !isTpcPidEvaluated) {
+        helper.evaluateTpcPid(tracks);
+        isTpcPidEvaluated = true;
       }
 
       std::vector<std::vector<int64_t>> indicesDau2Prong{}, indicesDau2ProngPrompt{};
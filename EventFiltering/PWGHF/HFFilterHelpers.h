@@ -26,6 +26,7 @@
 //
 #include "PWGHF/Core/SelectorCuts.h"
 //
+#include "Common/Core/PID/TPCRecalibrationProvider.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 
@@ -42,7 +43,6 @@
 #include <Framework/HistogramRegistry.h>
 #include <Framework/HistogramSpec.h>
 #include <Framework/Logger.h>
-#include <MathUtils/BetheBlochAleph.h>
 
 #include <Math/GenVector/Boost.h>
 #include <Math/Vector4D.h> // IWYU pragma: keep (do not replace with Math/Vector4Dfwd.h)
@@ -738,6 +738,8 @@ class HfFilterHelper
   // PID
   void setValuesBB(o2::ccdb::CcdbApi& ccdbApi, aod::BCsWithTimestamps::iterator const& bunchCrossing, const std::array<std::string, 8>& ccdbPaths);
   void setTpcRecalibMaps(o2::framework::Service<o2::ccdb::BasicCCDBManager> const& ccdb, aod::BCsWithTimestamps::iterator const& bunchCrossing, const std::string& ccdbPath);
+  template <typename T>
+  void evaluateTpcPid(const T& tracks);
 
  private:
   // selections
@@ -751,6 +753,7 @@ class HfFilterHelper
   float getTPCPostCalib(const float tpcPin, const float tpcNCls, const float eta, const float tpcNSigma, const int& pidSpecies);
   template <typename T>
   float getTPCPostCalib(const T& track, const int& pidSpecies);
+  float getTPCSplineMass(const int& pidSpecies);
 
   // helpers
   template <typename T1, typename T2>
@@ -863,9 +866,10 @@ class HfFilterHelper
   float mThresholdPtTOFForPrSigmaCPr{1.0f}; // pT threshold above which TOF is required for SigmaC-Proton trigger
 
   // PID recalibrations
-  int mTpcPidCalibrationOption{0};                          // Option for TPC PID calibration (0 -> AO2D, 1 -> postcalibrations, 2 -> alternative bethe bloch parametrisation)
-  std::array<TH3F*, 8> mHistMapPiPrKaDe{};                  // Map for TPC PID postcalibrations for pions, kaon, protons and deuterons
-  std::array<std::vector<double>, 8> mBetheBlochPiKaPrDe{}; // Bethe-Bloch parametrisations for pions, antipions, kaons, antikaons, protons, antiprotons, deuterons, antideuterons in TPC
+  int mTpcPidCalibrationOption{0};                                                       // Option for TPC PID calibration (0 -> AO2D, 1 -> postcalibrations, 2 -> alternative bethe bloch parametrisation)
+  o2::pid::tpc::RecalibrationProvider mTpcRecalibration{};                               // Bethe-Bloch parametrisations (slots as ccdbPaths of setValuesBB) and postcalibration maps (slots for pions, kaons, protons and deuterons) for TPC PID
+  std::array<int, kAntiDe + 1> mTpcSplineColumns{-1, -1, -1, -1, -1, -1, -1, -1, -1};    // column of the per-track buffer of mTpcRecalibration for each PIDSpecies with the Bethe-Bloch recalibration, -1 if not evaluated
+  std::array<int, kAntiDe + 1> mTpcPostCalibColumns{-1, -1, -1, -1, -1, -1, -1, -1, -1}; // column of the per-track buffer of mTpcRecalibration for each PIDSpecies with the postcalibration maps, -1 if not evaluated
   // Ds cuts from track-index-skim-creator
   std::vector<double> mPtBinsPreselDsToKKPi{};           // pT bins for pre-selections for Ds from track-index-skim-creator
   o2::framework::LabeledArray<double> mPreselDsToKKPi{}; // pre-selections for Ds from track-index-skim-creator
@@ -1977,13 +1981,14 @@ inline void HfFilterHelper::setValuesBB(o2::ccdb::CcdbApi& ccdbApi, aod::BCsWith
     }
 
     TAxis* axis = hSpline->GetXaxis();
-    mBetheBlochPiKaPrDe[iSpecie] = {static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb1"))),
-                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb2"))),
-                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb3"))),
-                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb4"))),
-                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb5"))),
-                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("Resolution")))};
-  }
+    mTpcRecalibration.setBetheBlochParams(iSpecie, {static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb1"))),
+                                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb2"))),
+                                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb3"))),
+                                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb4"))),
+                                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("bb5"))),
+                                                    static_cast<double>(hSpline->GetBinContent(axis->FindBin("Resolution")))});
+  }
+  mTpcRecalibration.clearColumns();
 }
 
 /// load the TPC PID recalibration maps from the CCDB
@@ -1998,18 +2003,54 @@ inline void HfFilterHelper::setTpcRecalibMaps(o2::framework::Service<o2::ccdb::B
   }
   std::array<std::string, 8> mapNames = {"mean_map_pion", "sigma_map_pion", "mean_map_kaon", "sigma_map_kaon", "mean_map_proton", "sigma_map_proton", "mean_map_deuteron", "sigma_map_deuteron"};
 
-  for (size_t iMap = 0; iMap < mapNames.size(); iMap++) {
-    mHistMapPiPrKaDe[iMap] = nullptr;
-  }
-
-  for (size_t iMap = 0; iMap < mapNames.size(); iMap++) {
+  mTpcRecalibration.resetPostCalibMaps();
+  mTpcRecalibration.clearColumns();
 
-    mHistMapPiPrKaDe[iMap] = reinterpret_cast<TH3F*>(calibList->FindObject(mapNames[iMap].data()));
-    if (!mHistMapPiPrKaDe[iMap]) {
-      LOG(fatal) << "Cannot find histogram: " << mapNames[iMap].data();
+  // the maps are copied into flat tables, mean and sigma of each species share the slot
+  for (size_t iMap = 0; iMap < mapNames.size(); iMap += 2) {
+    auto histMean = reinterpret_cast<TH3F*>(calibList->FindObject(mapNames[iMap].data()));
+    auto histSigma = reinterpret_cast<TH3F*>(calibList->FindObject(mapNames[iMap + 1].data()));
+    if (!histMean || !histSigma) {
+      LOG(fatal) << "Cannot find histogram: " << (histMean ? mapNames[iMap + 1] : mapNames[iMap]).data();
       return;
     }
+    mTpcRecalibration.setPostCalibMaps(iMap / 2, histMean, histSigma);
+  }
+}
+
+/// evaluate the recalibrated TPC nsigma of all tracks of the dataframe in one pass
+/// the track-based getTPCSplineCalib and getTPCPostCalib then read them from the buffer
+/// \param tracks is the unfiltered track table, so that track.globalIndex() is the row of the buffer
+template <typename T>
+inline void HfFilterHelper::evaluateTpcPid(const T& tracks)
+{
+  if (mTpcPidCalibrationOption != 1 && mTpcPidCalibrationOption != 2) {
+    return;
+  }
+
+  // columns registered once per run, after the parametrisations have been loaded
+  if (mTpcRecalibration.nColumns() == 0) {
+    mTpcSplineColumns.fill(-1);
+    mTpcPostCalibColumns.fill(-1);
+    if (mTpcPidCalibrationOption == 1) {
+      mTpcPostCalibColumns[kPi] = mTpcRecalibration.addColumn(o2::pid::tpc::RecalibrationProvider::Method::PostCalibration, 0);
+      mTpcPostCalibColumns[kKa] = mTpcRecalibration.addColumn(o2::pid::tpc::RecalibrationProvider::Method::PostCalibration, 1);
+      mTpcPostCalibColumns[kPr] = mTpcRecalibration.addColumn(o2::pid::tpc::RecalibrationProvider::Method::PostCalibration, 2);
+    } else {
+      for (const int species : {kPi, kAntiPi, kKa, kAntiKa, kPr, kAntiPr, kDe}) {
+        mTpcSplineColumns[species] = mTpcRecalibration.addColumn(o2::pid::tpc::RecalibrationProvider::Method::BetheBloch, species, getTPCSplineMass(species));
+      }
+    }
   }
+
+  mTpcRecalibration.evaluate(tracks, [](const auto& track, const int slot) -> float {
+    if (slot == 0) {
+      return track.tpcNSigmaPi();
+    } else if (slot == 1) {
+      return track.tpcNSigmaKa();
+    }
+    return track.tpcNSigmaPr();
+  });
 }
 
 /// Basic selection of proton candidates for Lc
@@ -2599,6 +2640,10 @@ inline bool HfFilterHelper::isSelectedXiBachBach(T const& trackParCasc, std::arr
 template <typename T>
 inline float HfFilterHelper::getTPCSplineCalib(const T& track, const int& pidSpecies)
 {
+  if (pidSpecies >= 0 && pidSpecies <= kAntiDe && mTpcSplineColumns[pidSpecies] >= 0 && mTpcRecalibration.hasRow(track.globalIndex())) {
+    return mTpcRecalibration.nSigma(track.globalIndex(), mTpcSplineColumns[pidSpecies]);
+  }
+
   float tpcPin = track.tpcInnerParam();
   float dEdx = track.tpcSignal();
 
@@ -2612,24 +2657,30 @@ inline float HfFilterHelper::getTPCSplineCalib(const T& track, const int& pidSpe
 /// \return updated nsigma value for TPC PID
 inline float HfFilterHelper::getTPCSplineCalib(const float tpcPin, const float dEdx, const int& pidSpecies)
 {
-  float mMassPar{0.};
+  float mMassPar = getTPCSplineMass(pidSpecies);
+  if (mMassPar <= 0.f) {
+    return 999.;
+  }
+
+  return mTpcRecalibration.betheBlochNSigma(pidSpecies, mMassPar, tpcPin, dEdx);
+}
+
+/// Mass hypothesis for the beta-gamma scaling of the TPC spline
+/// \param pidSpecies is the particle species to be considered
+/// \return mass of the species
+inline float HfFilterHelper::getTPCSplineMass(const int& pidSpecies)
+{
   if (pidSpecies == kPi || pidSpecies == kAntiPi) {
-    mMassPar = massPi;
+    return massPi;
   } else if (pidSpecies == kKa || pidSpecies == kAntiKa) {
-    mMassPar = massKa;
+    return massKa;
   } else if (pidSpecies == kPr || pidSpecies == kAntiPr) {
-    mMassPar = massProton;
+    return massProton;
   } else if (pidSpecies == kDe || pidSpecies == kAntiDe) {
-    mMassPar = massDeuteron;
-  } else {
-    LOGP(fatal, "TPC recalibrated Nsigma requested for unknown particle species, return 999");
-    return 999.;
+    return massDeuteron;
   }
-
-  auto bgScaling = 1 / mMassPar;
-  double expBethe = common::BetheBlochAleph(static_cast<double>(tpcPin * bgScaling), mBetheBlochPiKaPrDe[pidSpecies][0], mBetheBlochPiKaPrDe[pidSpecies][1], mBetheBlochPiKaPrDe[pidSpecies][2], mBetheBlochPiKaPrDe[pidSpecies][3], mBetheBlochPiKaPrDe[pidSpecies][4]);
-  double expSigma = expBethe * mBetheBlochPiKaPrDe[pidSpecies][5];
-  return static_cast<float>((dEdx - expBethe) / expSigma);
+  LOGP(fatal, "TPC recalibrated Nsigma requested for unknown particle species, return 999");
+  return -1.f;
 }
 
 /// compute TPC postcalibrated nsigma based on calibration histograms from CCDB
@@ -2641,35 +2692,18 @@ inline float HfFilterHelper::getTPCSplineCalib(const float tpcPin, const float d
 /// \return the corrected Nsigma value for the PID species
 inline float HfFilterHelper::getTPCPostCalib(const float tpcPin, const float tpcNCls, const float eta, const float tpcNSigma, const int& pidSpecies)
 {
-  int iHist{0};
+  int iMap{0};
   if (pidSpecies == kPi) {
-    iHist = 0;
+    iMap = 0;
   } else if (pidSpecies == kKa) {
-    iHist = 2;
+    iMap = 1;
   } else if (pidSpecies == kPr) {
-    iHist = 4;
+    iMap = 2;
   } else {
     LOG(fatal) << "Wrong PID Species be selected, please check!";
   }
 
-  if (!mHistMapPiPrKaDe[iHist] || !mHistMapPiPrKaDe[iHist + 1]) {
-    LOGP(warn, "Postcalibration TPC PID histograms not set. Use default Nsigma values.");
-  }
-
-  auto binTPCNCls = mHistMapPiPrKaDe[iHist]->GetXaxis()->FindBin(tpcNCls);
-  binTPCNCls = (binTPCNCls == 0 ? 1 : binTPCNCls);
-  binTPCNCls = std::min(mHistMapPiPrKaDe[iHist]->GetXaxis()->GetNbins(), binTPCNCls);
-  auto binPin = mHistMapPiPrKaDe[iHist]->GetYaxis()->FindBin(tpcPin);
-  binPin = (binPin == 0 ? 1 : binPin);
-  binPin = std::min(mHistMapPiPrKaDe[iHist]->GetYaxis()->GetNbins(), binPin);
-  auto binEta = mHistMapPiPrKaDe[iHist]->GetZaxis()->FindBin(eta);
-  binEta = (binEta == 0 ? 1 : binEta);
-  binEta = std::min(mHistMapPiPrKaDe[iHist]->GetZaxis()->GetNbins(), binEta);
-
-  auto mean = mHistMapPiPrKaDe[iHist]->GetBinContent(binTPCNCls, binPin, binEta);
-  auto width = mHistMapPiPrKaDe[iHist + 1]->GetBinContent(binTPCNCls, binPin, binEta);
-
-  return (tpcNSigma - mean) / width;
+  return mTpcRecalibration.postCalibNSigma(iMap, tpcPin, tpcNCls, eta, tpcNSigma);
 }
 
 /// compute TPC postcalibrated nsigma based on calibration histograms from CCDB
@@ -2679,6 +2713,10 @@ inline float HfFilterHelper::getTPCPostCalib(const float tpcPin, const float tpc
 template <typename T>
 inline float HfFilterHelper::getTPCPostCalib(const T& track, const int& pidSpecies)
 {
+  if (pidSpecies >= 0 && pidSpecies <= kAntiDe && mTpcPostCalibColumns[pidSpecies] >= 0 && mTpcRecalibration.hasRow(track.globalIndex())) {
+    return mTpcRecalibration.nSigma(track.globalIndex(), mTpcPostCalibColumns[pidSpecies]);
+  }
+
   float tpcNCls = track.tpcNClsFound();
   float tpcPin = track.tpcInnerParam();
   float eta = track.eta();
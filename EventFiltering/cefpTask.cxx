@@ -39,9 +39,12 @@
 
 #include <Rtypes.h>
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include <random>
 #include <string>
@@ -85,6 +88,24 @@ bool readJsonFile(std::string& config, Document& d)
   return true;
 }
 
+/// Max number of columns for triggers is 128 (two decision words)
+constexpr uint64_t kMaxTriggerColumns{128};
+
+/// Read up to 64 bits of an Arrow (LSB-first) bitmap starting at an arbitrary bit offset
+uint64_t readBitmapWord(const uint8_t* bitmap, int64_t bitOffset, int64_t nBits)
+{
+  const uint8_t* first{bitmap + (bitOffset >> 3)};
+  const int shift{static_cast<int>(bitOffset & 7)};
+  const int64_t nBytes{(shift + nBits + 7) >> 3};
+  uint64_t word{0ull};
+  std::memcpy(&word, first, std::min<int64_t>(nBytes, 8));
+  word >>= shift;
+  if (nBytes > 8) {
+    word |= static_cast<uint64_t>(first[8]) << (64 - shift);
+  }
+  return nBits < 64 ? word & ((1ull << nBits) - 1) : word;
+}
+
 std::unordered_map<std::string, std::unordered_map<std::string, float>> mDownscaling;
 static const std::vector<std::string> downscalingName{"Downscaling"};
 static const float defaultDownscaling[128][1]{
@@ -326,6 +347,11 @@ struct centralEventFilterTask {
     auto mFiltered{scalers.get<TH1>(HIST("mFiltered"))};
     auto mCovariance{scalers.get<TH2>(HIST("mCovariance"))};
 
+    /// Per-dataframe counters, flushed to the histograms once at the end of the dataframe
+    std::array<uint64_t, kMaxTriggerColumns> triggerCounts{};
+    std::array<uint64_t, kMaxTriggerColumns> filterCounts{};
+    std::vector<uint64_t> covarianceCounts(kMaxTriggerColumns * kMaxTriggerColumns, 0ull);
+
     int64_t nEvents{collTabPtr->num_rows()};
     std::vector<std::array<uint64_t, 2>> outTrigger, outDecision;
     for (auto& tableName : mDownscaling) {
@@ -347,62 +373,82 @@ struct centralEventFilterTask {
       auto schema{tablePtr->schema()};
       for (auto& colName : tableName.second) {
         uint64_t bin{static_cast<uint64_t>(mScalers->GetXaxis()->FindBin(colName.first.data()))};
-        double binCenter{mScalers->GetXaxis()->GetBinCenter(bin)};
-        uint64_t decisionBin{(bin - 2) / 64};
-        uint64_t triggerBit{BIT((bin - 2) % 64)};
+        uint64_t columnIndex{bin - 2};
+        uint64_t decisionBin{columnIndex / 64};
+        uint64_t triggerBit{BIT(columnIndex % 64)};
         auto column{tablePtr->GetColumnByName(colName.first)};
         double downscaling{cfgDisableDownscalings.value ? 1. : colName.second};
         if (column) {
-          int entry = 0;
+          int64_t entry = 0;
           for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
             auto chunk{column->chunk(iC)};
             auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(chunk);
-            for (int64_t iS{startCollision}; iS < chunk->length(); ++iS) {
-              if (boolArray->Value(iS)) {
-                mScalers->Fill(binCenter);
-                outTrigger[entry][decisionBin] |= triggerBit;
+            const uint8_t* values{boolArray->values()->data()};
+            const uint8_t* validity{boolArray->null_count() > 0 ? boolArray->null_bitmap_data() : nullptr};
+            const int64_t offset{boolArray->offset()};
+            for (int64_t iW{startCollision}; iW < chunk->length(); iW += 64) {
+              const int64_t nBits{std::min<int64_t>(64, chunk->length() - iW)};
+              uint64_t word{readBitmapWord(values, offset + iW, nBits)};
+              if (validity) {
+                word &= readBitmapWord(validity, offset + iW, nBits);
+              }
+              triggerCounts[columnIndex] += std::popcount(word);
+              /// Set bits are visited in increasing row order, so the random sequence is the same as a row-by-row scan
+              while (word) {
+                const int64_t iS{entry + std::countr_zero(word)};
+                word &= word - 1;
+                outTrigger[iS][decisionBin] |= triggerBit;
                 if (mUniformGenerator(mGeneratorEngine) < downscaling) {
-                  mFiltered->Fill(binCenter);
-                  outDecision[entry][decisionBin] |= triggerBit;
+                  filterCounts[columnIndex]++;
+                  outDecision[iS][decisionBin] |= triggerBit;
                 }
               }
-              entry++;
+              entry += nBits;
             }
           }
         }
       }
     }
-    mScalers->SetBinContent(1, mScalers->GetBinContent(1) + nEvents - startCollision);
-    mFiltered->SetBinContent(1, mFiltered->GetBinContent(1) + nEvents - startCollision);
 
+    uint64_t nTriggered{0ull}, nSelected{0ull};
+    std::array<uint32_t, kMaxTriggerColumns> firedColumns{};
     for (uint64_t iE{0}; iE < outTrigger.size(); ++iE) {
       const auto& triggerWord{outTrigger[iE]};
-      bool triggered{false}, selected{false};
+      uint32_t nFired{0};
       for (uint64_t iD{0}; iD < triggerWord.size(); ++iD) {
-        for (int iB{0}; iB < 64; ++iB) {
-          if (!(triggerWord[iD] & BIT(iB))) {
-            continue;
-          }
-          uint64_t xIndex{iD * 64 + iB};
-          for (uint64_t jD{0}; jD < triggerWord.size(); ++jD) {
-            for (int jB{0}; jB < 64; ++jB) {
-              uint64_t yIndex{jD * 64 + jB};
-              if (xIndex <= yIndex && triggerWord[jD] & BIT(jB)) {
-                mCovariance->Fill(iD * 64 + iB, jD * 64 + jB);
-              }
-            }
-          }
+        for (uint64_t word{triggerWord[iD]}; word; word &= word - 1) {
+          firedColumns[nFired++] = iD * 64 + std::countr_zero(word);
         }
-        triggered = triggered || triggerWord[iD];
-        selected = selected || outDecision[iE][iD];
       }
-      if (triggered) {
-        mScalers->Fill(mScalers->GetNbinsX() - 1);
+      for (uint32_t iF{0}; iF < nFired; ++iF) {
+        uint64_t* covarianceRow{covarianceCounts.data() + firedColumns[iF] * kMaxTriggerColumns};
+        for (uint32_t jF{iF}; jF < nFired; ++jF) {
+          covarianceRow[firedColumns[jF]]++;
+        }
       }
-      if (selected) {
-        mFiltered->Fill(mFiltered->GetNbinsX() - 1);
+      nTriggered += nFired > 0;
+      nSelected += (outDecision[iE][0] | outDecision[iE][1]) != 0;
+    }
+
+    /// Flush the dataframe counters to the histograms
+    auto addToBin = [](TH1* hist, int bin, uint64_t counts) {
+      if (counts) {
+        hist->SetBinContent(bin, hist->GetBinContent(bin) + counts);
+        hist->SetEntries(hist->GetEntries() + counts);
+      }
+    };
+    mScalers->SetBinContent(1, mScalers->GetBinContent(1) + nEvents - startCollision);
+    mFiltered->SetBinContent(1, mFiltered->GetBinContent(1) + nEvents - startCollision);
+    const int nCols{mCovariance->GetNbinsX()};
+    for (int iCol{0}; iCol < nCols; ++iCol) {
+      addToBin(mScalers.get(), iCol + 2, triggerCounts[iCol]);
+      addToBin(mFiltered.get(), iCol + 2, filterCounts[iCol]);
+      for (int jCol{iCol}; jCol < nCols; ++jCol) {
+        addToBin(mCovariance.get(), mCovariance->GetBin(iCol + 1, jCol + 1), covarianceCounts[iCol * kMaxTriggerColumns + jCol]);
       }
     }
+    addToBin(mScalers.get(), mScalers->GetNbinsX(), nTriggered);
+    addToBin(mFiltered.get(), mFiltered->GetNbinsX(), nSelected);
 
     if (outDecision.size() != static_cast<uint64_t>(nEvents)) {
       LOGF(fatal, "Inconsistent number of rows across Collision table and CEFP decision vector.");
@@ -23,9 +23,11 @@
 #include <TLorentzVector.h>
 #include <TVector3.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -149,6 +151,9 @@ TVector3 GetQLCMSFrom4vectors(TLorentzVector& first4momentum, TLorentzVector& se
 
 //====================================================================================
 
+// TPC radii used for the average dphi* and the average separation
+constexpr std::array<float, 9> TPCradiiAvg = {0.85, 1.05, 1.25, 1.45, 1.65, 1.85, 2.05, 2.25, 2.45};
+
 template <typename TrackType>
 class FemtoPair
 {
@@ -243,7 +248,7 @@ class FemtoPair
   float _magfield1 = 0.0, _magfield2 = 0.0;
   int _PDG1 = 0, _PDG2 = 0;
   bool _isidentical = true;
-  std::array<float, 9> TPCradii = {0.85, 1.05, 1.25, 1.45, 1.65, 1.85, 2.05, 2.25, 2.45};
+  std::array<float, 9> TPCradii = TPCradiiAvg;
 };
 
 template <typename TrackType>
@@ -432,6 +437,333 @@ float FemtoPair<TrackType>::GetGammaOut() const
 
   return fourmomentasum.Gamma();
 }
+//====================================================================================
+
+/// Same operations as TLorentzVector::Boost(bx, by, bz)
+inline void BoostFourMomentum(double& x, double& y, double& z, double& t, const double bx, const double by, const double bz)
+{
+  double b2 = bx * bx + by * by + bz * bz;
+  double gamma = 1.0 / std::sqrt(1.0 - b2);
+  double bp = bx * x + by * y + bz * z;
+  double gamma2 = b2 > 0 ? (gamma - 1.0) / b2 : 0.0;
+
+  x = x + gamma2 * bp * bx + gamma * bx * t;
+  y = y + gamma2 * bp * by + gamma * by * t;
+  z = z + gamma2 * bp * bz + gamma * bz * t;
+  t = gamma * (t + bp);
+}
+
+/// Same operations as TVector3::Phi()
+inline double PhiOfVector(const double x, const double y)
+{
+  return x == 0.0 && y == 0.0 ? 0.0 : std::atan2(y, x);
+}
+
+/// Same operations as TVector3::RotateZ(angle)
+inline void RotateVectorZ(double& x, double& y, const double angle)
+{
+  double s = std::sin(angle);
+  double c = std::cos(angle);
+  double xx = x;
+  x = c * xx - s * y;
+  y = s * xx + c * y;
+}
+
+/// phi* difference wrapped as in FemtoPair::GetPhiStarDiff
+inline float WrapPhiStarDiff(const float dphi)
+{
+  return std::fabs(dphi) > o2::constants::math::PI ? (1.0 - 2.0 * o2::constants::math::PI / std::fabs(dphi)) * dphi : dphi;
+}
+
+/// Selected tracks stored as structure of arrays and grouped by collision, as input of the FemtoPairKernel.
+/// The four-momenta are built with the same operations as TLorentzVector::SetPtEtaPhiM and phi* is evaluated once
+/// per track at the configured radii, using the magnetic field of the collision of the track.
+class FemtoTrackArrays
+{
+ public:
+  FemtoTrackArrays() = default;
+
+  /// \param radii are the TPC radii at which phi* is stored
+  void SetRadii(std::vector<float> const& radii)
+  {
+    _radii = radii;
+    phiStar.resize(radii.size());
+  }
+  std::vector<float> const& GetRadii() const { return _radii; }
+
+  void Clear()
+  {
+    collisionId.clear();
+    px.clear();
+    py.clear();
+    eta.clear();
+    theta.clear();
+    x.clear();
+    y.clear();
+    z.clear();
+    e.clear();
+    for (auto& phiStarAtRadius : phiStar) {
+      phiStarAtRadius.clear();
+    }
+    _offsets.clear();
+  }
+
+  std::size_t Size() const { return px.size(); }
+
+  /// Adds a track; to be called for all the tracks before GroupByCollision()
+  template <typename TrackType>
+  void Add(const int64_t collId, TrackType const& track, const double mass, const float magField)
+  {
+    collisionId.push_back(collId);
+    px.push_back(track.px());
+    py.push_back(track.py());
+    eta.push_back(track.eta());
+    theta.push_back(THETA(track.eta()));
+
+    double pt = std::fabs(static_cast<double>(track.pt()));
+    double phi = track.phi();
+    double trackX = pt * std::cos(phi);
+    double trackY = pt * std::sin(phi);
+    double trackZ = pt * std::sinh(static_cast<double>(track.eta()));
+    x.push_back(trackX);
+    y.push_back(trackY);
+    z.push_back(trackZ);
+    e.push_back(mass >= 0 ? std::sqrt(trackX * trackX + trackY * trackY + trackZ * trackZ + mass * mass) : std::sqrt(std::max((trackX * trackX + trackY * trackY + trackZ * trackZ - mass * mass), 0.)));
+
+    for (std::size_t iRadius = 0; iRadius < _radii.size(); iRadius++) {
+      phiStar[iRadius].push_back(track.phiStar(magField, _radii[iRadius]));
+    }
+  }
+
+  /// Orders the tracks by collision, keeping the order in which they were added within a collision
+  void GroupByCollision()
+  {
+    const std::size_t nTracks = Size();
+    int64_t maxCollisionId = -1;
+    for (const auto& collId : collisionId) {
+      maxCollisionId = std::max(maxCollisionId, collId);
+    }
+    _offsets.assign(maxCollisionId + 2, 0);
+    for (const auto& collId : collisionId) {
+      _offsets[collId + 1]++;
+    }
+    for (std::size_t iColl = 1; iColl < _offsets.size(); iColl++) {
+      _offsets[iColl] += _offsets[iColl - 1];
+    }
+    bool isGrouped = true;
+    for (std::size_t iTrack = 1; iTrack < nTracks && isGrouped; iTrack++) {
+      isGrouped = collisionId[iTrack - 1] <= collisionId[iTrack];
+    }
+    if (isGrouped) {
+      return;
+    }
+    std::vector<std::size_t> order(nTracks);
+    std::vector<std::size_t> next(_offsets.begin(), _offsets.end() - 1);
+    for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
+      order[next[collisionId[iTrack]]++] = iTrack;
+    }
+    Permute(collisionId, order);
+    Permute(px, order);
+    Permute(py, order);
+    Permute(eta, order);
+    Permute(theta, order);
+    Permute(x, order);
+    Permute(y, order);
+    Permute(z, order);
+    Permute(e, order);
+    for (auto& phiStarAtRadius : phiStar) {
+      Permute(phiStarAtRadius, order);
+    }
+  }
+
+  /// First track of a collision
+  std::size_t Begin(const int64_t collId) const { return collId + 1 < static_cast<int64_t>(_offsets.size()) ? _offsets[collId] : 0; }
+  /// One past the last track of a collision
+  std::size_t End(const int64_t collId) const { return collId + 1 < static_cast<int64_t>(_offsets.size()) ? _offsets[collId + 1] : 0; }
+  std::size_t Size(const int64_t collId) const { return End(collId) - Begin(collId); }
+
+  std::vector<int64_t> collisionId;
+  std::vector<float> px, py; // as in the track table, for kT
+  std::vector<float> eta;
+  std::vector<double> theta;
+  std::vector<double> x, y, z, e;         // four-momentum
+  std::vector<std::vector<float>> phiStar; // [radius][track]
+
+ private:
+  template <typename T>
+  static void Permute(std::vector<T>& values, std::vector<std::size_t> const& order)
+  {
+    std::vector<T> permuted(values.size());
+    for (std::size_t iTrack = 0; iTrack < order.size(); iTrack++) {
+      permuted[iTrack] = values[order[iTrack]];
+    }
+    values.swap(permuted);
+  }
+
+  std::vector<float> _radii;
+  std::vector<std::size_t> _offsets; // first track of each collision, indexed by collision ID
+};
+
+/// Observables of the pairs formed by one track of a first set with a range of tracks of a second set.
+/// They are computed in one pass over the arrays with plain arithmetic, following the same operations as FemtoPair
+/// with TLorentzVector, and only for the requested groups of observables.
+class FemtoPairKernel
+{
+ public:
+  enum Observables : uint8_t {
+    kPhiStarDiff = 0x1,    // dphi* at the first radius of the track arrays
+    kAvgPhiStarDiff = 0x2, // dphi* averaged over the radii of the track arrays following the first one
+    kAvgSep = 0x4,         // average separation over the radii following the first one
+    kMt = 0x8,
+    kQLCMS = 0x10,
+    kGammaOut = 0x20
+  };
+
+  FemtoPairKernel() = default;
+
+  void SetIdentical(const bool isidentical) { _isidentical = isidentical; }
+  void SetObservables(const uint8_t observables) { _observables = observables; }
+  void SetPDG(const int PDG1, const int PDG2)
+  {
+    _PDG1 = PDG1;
+    _PDG2 = PDG2;
+  }
+
+  /// Computes the observables of the pairs (first[i], second[j]) for j in [begin, end)
+  void Process(FemtoTrackArrays const& first, const std::size_t i, FemtoTrackArrays const& second, const std::size_t begin, const std::size_t end)
+  {
+    const std::size_t nPairs = end > begin ? end - begin : 0;
+    Resize(nPairs);
+
+    if (_PDG1 * _PDG2 == 0) { // no pair kinematics without the masses, the pairs are rejected as in FemtoPair
+      Reject();
+      return;
+    }
+
+    const float px1 = first.px[i], py1 = first.py[i], eta1 = first.eta[i];
+    for (std::size_t k = 0; k < nPairs; k++) {
+      const float px = px1 + second.px[begin + k];
+      const float py = py1 + second.py[begin + k];
+      kT[k] = 0.5 * std::sqrt(px * px + py * py);
+      etaDiff[k] = eta1 - second.eta[begin + k];
+    }
+
+    const std::size_t nRadii = first.phiStar.size();
+    if ((_observables & kPhiStarDiff) && nRadii > 0) {
+      const float phiStar1 = first.phiStar[0][i];
+      const float* phiStar2 = second.phiStar[0].data() + begin;
+      for (std::size_t k = 0; k < nPairs; k++) {
+        phiStarDiff[k] = WrapPhiStarDiff(phiStar1 - phiStar2[k]);
+      }
+    }
+    if (_observables & (kAvgPhiStarDiff | kAvgSep)) {
+      std::fill(avgPhiStarDiff.begin(), avgPhiStarDiff.end(), 0.f);
+      std::fill(avgSep.begin(), avgSep.end(), 0.f);
+      const double theta1 = first.theta[i];
+      const float* radii = first.GetRadii().data();
+      for (std::size_t iRadius = 1; iRadius < nRadii; iRadius++) {
+        const float radius = radii[iRadius];
+        const float phiStar1 = first.phiStar[iRadius][i];
+        const float* phiStar2 = second.phiStar[iRadius].data() + begin;
+        for (std::size_t k = 0; k < nPairs; k++) {
+          const float dphi = WrapPhiStarDiff(phiStar1 - phiStar2[k]);
+          avgPhiStarDiff[k] += dphi;
+          const float dtheta = theta1 - second.theta[begin + k];
+          const float dRtrans = 2.0 * radius * std::sin(0.5 * dphi);
+          const float dRlong = 2.0 * radius * std::sin(0.5 * dtheta);
+          avgSep[k] += std::sqrt(dRtrans * dRtrans + dRlong * dRlong);
+        }
+      }
+      const std::size_t nAvgRadii = nRadii > 0 ? nRadii - 1 : 0;
+      for (std::size_t k = 0; k < nPairs; k++) {
+        avgPhiStarDiff[k] = avgPhiStarDiff[k] / nAvgRadii;
+        avgSep[k] = 100.0 * avgSep[k] / nAvgRadii;
+      }
+    }
+
+    const double x1 = first.x[i], y1 = first.y[i], z1 = first.z[i], e1 = first.e[i];
+    for (std::size_t k = 0; k < nPairs; k++) {
+      const std::size_t j = begin + k;
+      double sumX = x1 + second.x[j], sumY = y1 + second.y[j], sumZ = z1 + second.z[j], sumE = e1 + second.e[j];
+      double difX = x1 - second.x[j], difY = y1 - second.y[j], difZ = z1 - second.z[j], difE = e1 - second.e[j];
+
+      if (_isidentical) {
+        double mag2 = difE * difE - (difX * difX + difY * difY + difZ * difZ);
+        kStar[k] = 0.5 * std::sqrt(std::fabs(mag2));
+      } else {
+        double x = difX, y = difY, z = difZ, t = difE;
+        BoostFourMomentum(x, y, z, t, (-1) * (sumX / sumE), (-1) * (sumY / sumE), (-1) * (sumZ / sumE));
+        kStar[k] = 0.5 * std::fabs(std::sqrt(x * x + y * y + z * z));
+      }
+
+      if (_observables & kMt) {
+        double mt2 = sumE * sumE - sumZ * sumZ;
+        mT[k] = 0.5 * (mt2 < 0.0 ? -std::sqrt(-mt2) : std::sqrt(mt2));
+      }
+      if (_observables & kQLCMS) {
+        double x = difX, y = difY, z = difZ, t = difE;
+        BoostFourMomentum(x, y, z, t, 0.0, 0.0, (-1) * (sumZ / sumE)); // boost to LCMS
+        RotateVectorZ(x, y, (-1) * PhiOfVector(sumX, sumY));           // rotate so the X axis is along pair's kT
+        qOut[k] = x;
+        qSide[k] = y;
+        qLong[k] = z;
+      }
+      if (_observables & kGammaOut) {
+        double x = sumX, y = sumY, z = sumZ, t = sumE;
+        BoostFourMomentum(x, y, z, t, 0.0, 0.0, (-1) * (sumZ / sumE)); // boost to LCMS
+        RotateVectorZ(x, y, (-1) * PhiOfVector(x, y));                 // rotate so the X axis is along pair's kT
+        double beta = std::sqrt(x * x + y * y + z * z) / t;
+        gammaOut[k] = 1.0 / std::sqrt(1 - beta * beta);
+      }
+    }
+  }
+
+  std::vector<float> kT;
+  std::vector<float> etaDiff;
+  std::vector<float> phiStarDiff;
+  std::vector<float> avgPhiStarDiff;
+  std::vector<float> avgSep;
+  std::vector<float> kStar;
+  std::vector<float> mT;
+  std::vector<double> qOut, qSide, qLong;
+  std::vector<float> gammaOut;
+
+ private:
+  void Resize(const std::size_t nPairs)
+  {
+    kT.resize(nPairs);
+    etaDiff.resize(nPairs);
+    phiStarDiff.resize(nPairs);
+    avgPhiStarDiff.resize(nPairs);
+    avgSep.resize(nPairs);
+    kStar.resize(nPairs);
+    mT.resize(nPairs);
+    qOut.resize(nPairs);
+    qSide.resize(nPairs);
+    qLong.resize(nPairs);
+    gammaOut.resize(nPairs);
+  }
+
+  /// sets the observables of all the pairs to the values FemtoPair returns for an invalid pair
+  void Reject()
+  {
+    std::fill(kT.begin(), kT.end(), -1000.f);
+    std::fill(etaDiff.begin(), etaDiff.end(), -1000.f);
+    std::fill(phiStarDiff.begin(), phiStarDiff.end(), -1000.f);
+    std::fill(avgPhiStarDiff.begin(), avgPhiStarDiff.end(), -100.f);
+    std::fill(avgSep.begin(), avgSep.end(), -100.f);
+    std::fill(kStar.begin(), kStar.end(), -1000.f);
+    std::fill(mT.begin(), mT.end(), -1000.f);
+    std::fill(qOut.begin(), qOut.end(), -1000.);
+    std::fill(qSide.begin(), qSide.end(), -1000.);
+    std::fill(qLong.begin(), qLong.end(), -1000.);
+    std::fill(gammaOut.begin(), gammaOut.end(), -1000.f);
+  }
+
+  bool _isidentical = true;
+  uint8_t _observables = 0;
+  int _PDG1 = 0, _PDG2 = 0;
+};
 } // namespace o2::aod::singletrackselector
 
 #endif // PWGCF_FEMTO3D_CORE_FEMTO3DPAIRTASK_H_
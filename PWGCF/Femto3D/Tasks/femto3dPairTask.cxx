@@ -33,13 +33,13 @@
 #include <TH2.h>
 #include <TH3.h>
 #include <TString.h>
-#include <TVector3.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <ctime>
-#include <map>
 #include <memory>
 #include <random>
 #include <utility>
@@ -123,6 +123,8 @@ struct FemtoCorrelations {
   Configurable<unsigned int> _MEreductionFactor{"MEreductionFactor", 1, "only one (pseudo)randomly choosen event out per pair $value events will be processed and contribute to the final mixing (if < 2 -> all the possible event pairs (per vertex&cent bin) will be processed); implemented for the sake of efficiency; look at the source code;"};
 
   bool IsIdentical;
+  double mass_1 = 0, mass_2 = 0;
+  uint8_t observablesSE, observablesME; // pair observables computed by the kernel, besides kT, k* and the eta difference
 
   std::pair<int, std::vector<float>> TPCcuts_1;
   std::pair<int, std::vector<float>> TOFcuts_1;
@@ -134,14 +136,18 @@ struct FemtoCorrelations {
   // using FilteredTracks = soa::Join<aod::SingleTrackSels, aod::SinglePIDPis, aod::SinglePIDKas, aod::SinglePIDPrs, aod::SinglePIDDes, aod::SinglePIDTrs, aod::SinglePIDHes>; // main
   using FilteredTracks = soa::Join<aod::SingleTrackSels, aod::SinglePIDPrs, aod::SinglePIDDes>; // tmp solution till the HL is fixed
 
-  typedef std::shared_ptr<soa::Filtered<FilteredTracks>::iterator> trkType;
-  typedef std::shared_ptr<soa::Filtered<FilteredCollisions>::iterator> colType;
+  struct MixingEvent {
+    std::pair<int, float> bin; // vertex & mult bin
+    int64_t collisionId;
+    float magField;
+    int mult;
+  };
 
-  std::map<int64_t, std::vector<trkType>> selectedtracks_1;
-  std::map<int64_t, std::vector<trkType>> selectedtracks_2;
-  std::map<std::pair<int, float>, std::vector<colType>> mixbins;
+  o2::aod::singletrackselector::FemtoTrackArrays selectedtracks_1; // selected particles1 grouped by eventID
+  o2::aod::singletrackselector::FemtoTrackArrays selectedtracks_2; // selected particles2 grouped by eventID
+  std::vector<MixingEvent> mixbins;                                // events to mix, sorted by vertex & mult bin
 
-  std::unique_ptr<o2::aod::singletrackselector::FemtoPair<trkType>> Pair = std::make_unique<o2::aod::singletrackselector::FemtoPair<trkType>>();
+  o2::aod::singletrackselector::FemtoPairKernel PairKernel;
 
   Filter pFilter = o2::aod::singletrackselector::p > _min_P&& o2::aod::singletrackselector::p < _max_P;
   Filter etaFilter = nabs(o2::aod::singletrackselector::eta) < _eta;
@@ -193,9 +199,27 @@ struct FemtoCorrelations {
 
     IsIdentical = (_sign_1 * _particlePDG_1 == _sign_2 * _particlePDG_2);
 
-    Pair->SetIdentical(IsIdentical);
-    Pair->SetPDG1(_particlePDG_1);
-    Pair->SetPDG2(_particlePDG_2);
+    // phi* is stored at the radius of the dphi* cut, then at the radii of the average dphi* and separation
+    std::vector<float> radii{_radiusTPC.value};
+    radii.insert(radii.end(), o2::aod::singletrackselector::TPCradiiAvg.begin(), o2::aod::singletrackselector::TPCradiiAvg.end());
+    selectedtracks_1.SetRadii(radii);
+    selectedtracks_2.SetRadii(radii);
+
+    if (_particlePDG_1 != 0 && _particlePDG_2 != 0) {
+      mass_1 = particle_mass(_particlePDG_1);
+      mass_2 = particle_mass(_particlePDG_2);
+    }
+
+    using o2::aod::singletrackselector::FemtoPairKernel;
+    uint8_t observablesDoubleTrack = 0;
+    if (_fillDetaDphi > -1 || (_deta > 0 && _dphi > 0))
+      observablesDoubleTrack |= (_dPhiMode.value == 0 ? FemtoPairKernel::kPhiStarDiff : FemtoPairKernel::kAvgPhiStarDiff);
+    if (_avgSepTPC > 0)
+      observablesDoubleTrack |= FemtoPairKernel::kAvgSep;
+    observablesSE = observablesDoubleTrack | FemtoPairKernel::kMt | (_fill3dCF ? FemtoPairKernel::kQLCMS : 0);
+    observablesME = observablesDoubleTrack | (_fill3dCF ? FemtoPairKernel::kQLCMS : 0) | (_fill3dCF && _fill3dAddHistos == 2 ? FemtoPairKernel::kGammaOut : 0);
+    PairKernel.SetIdentical(IsIdentical);
+    PairKernel.SetPDG(_particlePDG_1, _particlePDG_2);
 
     TPCcuts_1 = std::make_pair(_particlePDG_1, _tpcNSigma_1);
     TOFcuts_1 = std::make_pair(_particlePDG_1, _tofNSigma_1);
@@ -300,121 +324,107 @@ struct FemtoCorrelations {
     }
   }
 
-  template <typename Type>
-  void mixTracks(Type const& tracks, unsigned int multBin)
-  { // template for identical particles from the same collision
-    if (multBin > SEhistos_1D.size())
-      LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (1D)");
-    if (_fill3dCF && multBin > SEhistos_3D.size())
-      LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (3D)");
+  template <int SE_or_ME>
+  void fillPairs(unsigned int multBin)
+  { // last value: 0 -- SE; 1 -- ME; fills the histograms with the pairs computed by the PairKernel
+    for (std::size_t k = 0; k < PairKernel.kT.size(); k++) {
+      float pair_kT = PairKernel.kT[k];
 
-    for (unsigned int ii = 0; ii < tracks.size(); ii++) { // nested loop for all the combinations
-      for (unsigned int iii = ii + 1; iii < tracks.size(); iii++) {
-
-        Pair->SetPair(tracks[ii], tracks[iii]);
-        float pair_kT = Pair->GetKt();
+      if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
+        continue;
 
-        if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
-          continue;
+      unsigned int kTbin = o2::aod::singletrackselector::getBinIndex<unsigned int>(pair_kT, _kTbins);
+      if (kTbin > SEhistos_1D[multBin].size())
+        LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (1D)");
+      if (_fill3dCF && kTbin > SEhistos_3D[multBin].size())
+        LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (3D)");
 
-        unsigned int kTbin = o2::aod::singletrackselector::getBinIndex<unsigned int>(pair_kT, _kTbins);
-        if (kTbin > SEhistos_1D[multBin].size())
-          LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (1D)");
-        if (_fill3dCF && kTbin > SEhistos_3D[multBin].size())
-          LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (3D)");
+      const float pair_dEta = PairKernel.etaDiff[k];
+      const float pair_dPhiStar = _dPhiMode.value == 0 ? PairKernel.phiStarDiff[k] : PairKernel.avgPhiStarDiff[k];
 
-        if (_fillDetaDphi % 2 == 0)
-          DoubleTrack_SE_histos_BC[multBin][kTbin]->Fill(_dPhiMode.value == 0 ? Pair->GetPhiStarDiff(_radiusTPC) : Pair->GetAvgPhiStarDiff(), Pair->GetEtaDiff());
+      if (_fillDetaDphi % 2 == 0) {
+        if (!SE_or_ME)
+          DoubleTrack_SE_histos_BC[multBin][kTbin]->Fill(pair_dPhiStar, pair_dEta);
+        else
+          DoubleTrack_ME_histos_BC[multBin][kTbin]->Fill(pair_dPhiStar, pair_dEta);
+      }
 
-        if (_deta > 0 && _dphi > 0 && (_dPhiMode.value == 0 ? Pair->IsClosePair(_deta, _dphi, _radiusTPC) : Pair->IsClosePair(_deta, _dphi)))
-          continue;
-        if (_avgSepTPC > 0 && Pair->IsClosePair(_avgSepTPC))
+      if (_deta > 0 && _dphi > 0) {
+        const float relEtaDiff = pair_dEta / _deta.value;
+        const float relPhiStarDiff = pair_dPhiStar / _dphi.value;
+        if ((relEtaDiff * relEtaDiff + relPhiStarDiff * relPhiStarDiff) < 1.0f)
           continue;
+      }
+      if (_avgSepTPC > 0 && PairKernel.avgSep[k] < _avgSepTPC.value)
+        continue;
 
-        if (_fillDetaDphi > 0)
-          DoubleTrack_SE_histos_AC[multBin][kTbin]->Fill(_dPhiMode.value == 0 ? Pair->GetPhiStarDiff(_radiusTPC) : Pair->GetAvgPhiStarDiff(), Pair->GetEtaDiff());
+      if (_fillDetaDphi > 0) {
+        if (!SE_or_ME)
+          DoubleTrack_SE_histos_AC[multBin][kTbin]->Fill(pair_dPhiStar, pair_dEta);
+        else
+          DoubleTrack_ME_histos_AC[multBin][kTbin]->Fill(pair_dPhiStar, pair_dEta);
+      }
 
+      if (!SE_or_ME) {
+        SEhistos_1D[multBin][kTbin]->Fill(PairKernel.kStar[k]);
         kThistos[multBin][kTbin]->Fill(pair_kT);
-        mThistos[multBin][kTbin]->Fill(Pair->GetMt());       // test
-        SEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar()); // close pair rejection and fillig the SE histo
+        mThistos[multBin][kTbin]->Fill(PairKernel.mT[k]); // test
 
         if (_fill3dCF) {
           std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-          TVector3 qLCMS = std::pow(-1, (mt() % 2)) * Pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
-          SEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
+          const double sign = std::pow(-1, (mt() % 2)); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
+          SEhistos_3D[multBin][kTbin]->Fill(sign * PairKernel.qOut[k], sign * PairKernel.qSide[k], sign * PairKernel.qLong[k]);
+        }
+      } else {
+        MEhistos_1D[multBin][kTbin]->Fill(PairKernel.kStar[k]);
+
+        if (_fill3dCF) {
+          std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
+          const double sign = std::pow(-1, (mt() % 2)); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
+          MEhistos_3D[multBin][kTbin]->Fill(sign * PairKernel.qOut[k], sign * PairKernel.qSide[k], sign * PairKernel.qLong[k]);
+          if (_fill3dAddHistos == 1)
+            Add3dHistos[multBin][kTbin]->Fill(sign * PairKernel.qOut[k], sign * PairKernel.qSide[k], sign * PairKernel.qLong[k], PairKernel.kStar[k]);
+          else if (_fill3dAddHistos == 2)
+            Add3dHistos[multBin][kTbin]->Fill(sign * PairKernel.qOut[k], sign * PairKernel.qSide[k], sign * PairKernel.qLong[k], PairKernel.gammaOut[k]);
         }
-        Pair->ResetPair();
       }
     }
   }
 
-  template <int SE_or_ME, typename Type>
-  void mixTracks(Type const& tracks1, Type const& tracks2, unsigned int multBin)
-  { // last value: 0 -- SE; 1 -- ME
+  void mixTracks(MixingEvent const& col, unsigned int multBin)
+  { // identical particles from the same collision
     if (multBin > SEhistos_1D.size())
       LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (1D)");
     if (_fill3dCF && multBin > SEhistos_3D.size())
       LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (3D)");
+    if (col.magField * col.magField == 0) // no valid pair kinematics without the magnetic field
+      return;
+
+    const std::size_t begin = selectedtracks_1.Begin(col.collisionId);
+    const std::size_t end = selectedtracks_1.End(col.collisionId);
+    PairKernel.SetObservables(observablesSE);
+    for (std::size_t ii = begin; ii < end; ii++) { // nested loop for all the combinations
+      PairKernel.Process(selectedtracks_1, ii, selectedtracks_1, ii + 1, end);
+      fillPairs<0>(multBin);
+    }
+  }
 
-    for (auto ii : tracks1) {
-      for (auto iii : tracks2) {
-
-        Pair->SetPair(ii, iii);
-        float pair_kT = Pair->GetKt();
-
-        if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
-          continue;
-
-        unsigned int kTbin = o2::aod::singletrackselector::getBinIndex<unsigned int>(pair_kT, _kTbins);
-        if (kTbin > SEhistos_1D[multBin].size())
-          LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (1D)");
-        if (_fill3dCF && kTbin > SEhistos_3D[multBin].size())
-          LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (3D)");
-
-        if (_fillDetaDphi % 2 == 0) {
-          if (!SE_or_ME)
-            DoubleTrack_SE_histos_BC[multBin][kTbin]->Fill(_dPhiMode.value == 0 ? Pair->GetPhiStarDiff(_radiusTPC) : Pair->GetAvgPhiStarDiff(), Pair->GetEtaDiff());
-          else
-            DoubleTrack_ME_histos_BC[multBin][kTbin]->Fill(_dPhiMode.value == 0 ? Pair->GetPhiStarDiff(_radiusTPC) : Pair->GetAvgPhiStarDiff(), Pair->GetEtaDiff());
-        }
-
-        if (_deta > 0 && _dphi > 0 && (_dPhiMode.value == 0 ? Pair->IsClosePair(_deta, _dphi, _radiusTPC) : Pair->IsClosePair(_deta, _dphi)))
-          continue;
-        if (_avgSepTPC > 0 && Pair->IsClosePair(_avgSepTPC))
-          continue;
-
-        if (_fillDetaDphi > 0) {
-          if (!SE_or_ME)
-            DoubleTrack_SE_histos_AC[multBin][kTbin]->Fill(_dPhiMode.value == 0 ? Pair->GetPhiStarDiff(_radiusTPC) : Pair->GetAvgPhiStarDiff(), Pair->GetEtaDiff());
-          else
-            DoubleTrack_ME_histos_AC[multBin][kTbin]->Fill(_dPhiMode.value == 0 ? Pair->GetPhiStarDiff(_radiusTPC) : Pair->GetAvgPhiStarDiff(), Pair->GetEtaDiff());
-        }
-
-        if (!SE_or_ME) {
-          SEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar());
-          kThistos[multBin][kTbin]->Fill(pair_kT);
-          mThistos[multBin][kTbin]->Fill(Pair->GetMt()); // test
-
-          if (_fill3dCF) {
-            std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-            TVector3 qLCMS = std::pow(-1, (mt() % 2)) * Pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
-            SEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
-          }
-        } else {
-          MEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar());
-
-          if (_fill3dCF) {
-            std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-            TVector3 qLCMS = std::pow(-1, (mt() % 2)) * Pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
-            MEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
-            if (_fill3dAddHistos == 1)
-              Add3dHistos[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z(), Pair->GetKstar());
-            else if (_fill3dAddHistos == 2)
-              Add3dHistos[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z(), Pair->GetGammaOut());
-          }
-        }
-        Pair->ResetPair();
-      }
+  template <int SE_or_ME>
+  void mixTracks(o2::aod::singletrackselector::FemtoTrackArrays const& tracks1, MixingEvent const& col1, o2::aod::singletrackselector::FemtoTrackArrays const& tracks2, MixingEvent const& col2, unsigned int multBin)
+  { // last value: 0 -- SE; 1 -- ME
+    if (multBin > SEhistos_1D.size())
+      LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (1D)");
+    if (_fill3dCF && multBin > SEhistos_3D.size())
+      LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (3D)");
+    if (col1.magField * col2.magField == 0) // no valid pair kinematics without the magnetic field
+      return;
+
+    const std::size_t begin2 = tracks2.Begin(col2.collisionId);
+    const std::size_t end2 = tracks2.End(col2.collisionId);
+    PairKernel.SetObservables(SE_or_ME ? observablesME : observablesSE);
+    for (std::size_t ii = tracks1.Begin(col1.collisionId); ii < tracks1.End(col1.collisionId); ii++) {
+      PairKernel.Process(tracks1, ii, tracks2, begin2, end2);
+      fillPairs<SE_or_ME>(multBin);
     }
   }
 
@@ -450,7 +460,7 @@ struct FemtoCorrelations {
         continue;
 
       if (track.sign() == _sign_1 && (track.p() < _PIDtrshld_1 ? o2::aod::singletrackselector::TPCselection<true>(track, TPCcuts_1, _itsNSigma_1.value) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_1, _tpcNSigmaResidual_1.value))) { // filling the map: eventID <-> selected particles1
-        selectedtracks_1[track.singleCollSelId()].push_back(std::make_shared<soa::Filtered<FilteredTracks>::iterator>(track));
+        selectedtracks_1.Add(track.singleCollSelId(), track, mass_1, track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().magField());
 
         pHisto_first->Fill(track.p());
         ITShisto_first->Fill(track.p(), o2::aod::singletrackselector::getITSNsigma(track, _particlePDG_1));
@@ -461,7 +471,7 @@ struct FemtoCorrelations {
       if (IsIdentical) {
         continue;
       } else if (track.sign() != _sign_2 && !TOFselection(track, std::make_pair(_particlePDGtoReject, _rejectWithinNsigmaTOF)) && (track.p() < _PIDtrshld_2 ? o2::aod::singletrackselector::TPCselection<true>(track, TPCcuts_2, _itsNSigma_2.value) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_2, _tpcNSigmaResidual_2.value))) { // filling the map: eventID <-> selected particles2 if (see condition above ^)
-        selectedtracks_2[track.singleCollSelId()].push_back(std::make_shared<soa::Filtered<FilteredTracks>::iterator>(track));
+        selectedtracks_2.Add(track.singleCollSelId(), track, mass_2, track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().magField());
 
         pHisto_second->Fill(track.p());
         ITShisto_second->Fill(track.p(), o2::aod::singletrackselector::getITSNsigma(track, _particlePDG_2));
@@ -470,6 +480,10 @@ struct FemtoCorrelations {
       }
     }
 
+    selectedtracks_1.GroupByCollision();
+    if (!IsIdentical)
+      selectedtracks_2.GroupByCollision();
+
     for (const auto& collision : collisions) {
       if (collision.multPerc() < *_centBins.value.begin() || collision.multPerc() >= *(_centBins.value.end() - 1))
         continue;
@@ -490,103 +504,63 @@ struct FemtoCorrelations {
         continue;
       if (_requestIsGoodITSLayersAll && !collision.isGoodITSLayersAll())
         continue;
-      if (selectedtracks_1.find(collision.globalIndex()) == selectedtracks_1.end()) {
+      if (selectedtracks_1.Size(collision.globalIndex()) == 0) {
         if (IsIdentical)
           continue;
-        else if (selectedtracks_2.find(collision.globalIndex()) == selectedtracks_2.end())
+        else if (selectedtracks_2.Size(collision.globalIndex()) == 0)
           continue;
       }
       int vertexBinToMix = std::floor((collision.posZ() + _vertexZ) / (2 * _vertexZ / _vertexNbinsToMix));
       float centBinToMix = o2::aod::singletrackselector::getBinIndex<float>(collision.multPerc(), _centBins, _multNsubBins);
 
-      mixbins[std::pair<int, float>{vertexBinToMix, centBinToMix}].push_back(std::make_shared<soa::Filtered<FilteredCollisions>::iterator>(collision));
+      mixbins.push_back(MixingEvent{std::pair<int, float>{vertexBinToMix, centBinToMix}, collision.globalIndex(), collision.magField(), collision.mult()});
     }
+    std::stable_sort(mixbins.begin(), mixbins.end(), [](const MixingEvent& a, const MixingEvent& b) { return a.bin < b.bin; });
 
     //====================================== mixing starts here ======================================
 
-    if (IsIdentical) { //====================================== mixing identical ======================================
-
-      for (auto i = mixbins.begin(); i != mixbins.end(); i++) { // iterating over all vertex&mult bins
-        unsigned int EvPerBin = (i->second).size();
-
-        for (unsigned int indx1 = 0; indx1 < EvPerBin; indx1++) { // loop over all the events in each vertex&mult bin
+    std::size_t binBegin = 0;
+    while (binBegin < mixbins.size()) { // iterating over all vertex&mult bins
+      std::size_t binEnd = binBegin + 1;
+      while (binEnd < mixbins.size() && !(mixbins[binBegin].bin < mixbins[binEnd].bin))
+        binEnd++;
 
-          auto col1 = (i->second)[indx1];
+      for (std::size_t indx1 = binBegin; indx1 < binEnd; indx1++) { // loop over all the events in each vertex&mult bin
 
-          Pair->SetMagField1(col1->magField());
-          Pair->SetMagField2(col1->magField());
+        auto const& col1 = mixbins[indx1];
 
-          unsigned int centBin = std::floor((i->first).second);
-          MultHistos[centBin]->Fill(col1->mult());
+        unsigned int centBin = std::floor(col1.bin.second);
+        MultHistos[centBin]->Fill(col1.mult);
 
-          if (selectedtracks_1[col1->index()].size() > 1) {
-            MultHistos_pair[centBin]->Fill(col1->mult());
+        if (IsIdentical) { //====================================== mixing identical ======================================
+          if (selectedtracks_1.Size(col1.collisionId) > 1) {
+            MultHistos_pair[centBin]->Fill(col1.mult);
           }
 
-          mixTracks(selectedtracks_1[col1->index()], centBin); // mixing SE identical
-
-          for (unsigned int indx2 = indx1 + 1; indx2 < EvPerBin; indx2++) { // nested loop for all the combinations of collisions in a chosen mult/vertex bin
-            if (_MEreductionFactor.value > 1) {
-              std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-              if ((mt() % (_MEreductionFactor.value + 1)) < _MEreductionFactor.value)
-                continue;
-            }
-
-            auto col2 = (i->second)[indx2];
-
-            Pair->SetMagField2(col2->magField());
-            mixTracks<1>(selectedtracks_1[col1->index()], selectedtracks_1[col2->index()], centBin); // mixing ME identical, in <> brackets: 0 -- SE; 1 -- ME
-          }
+          mixTracks(col1, centBin); // mixing SE identical
+        } else { //====================================== mixing non-identical ======================================
+          mixTracks<0>(selectedtracks_1, col1, selectedtracks_2, col1, centBin); // mixing SE non-identical, in <> brackets: 0 -- SE; 1 -- ME
         }
-      }
-
-    } else { //====================================== mixing non-identical ======================================
-
-      for (auto i = mixbins.begin(); i != mixbins.end(); i++) { // iterating over all vertex&mult bins
-        unsigned int EvPerBin = (i->second).size();
-
-        for (unsigned int indx1 = 0; indx1 < EvPerBin; indx1++) { // loop over all the events in each vertex&mult bin
-
-          auto col1 = (i->second)[indx1];
 
-          Pair->SetMagField1(col1->magField());
-          Pair->SetMagField2(col1->magField());
-
-          unsigned int centBin = std::floor((i->first).second);
-          MultHistos[centBin]->Fill(col1->mult());
-
-          mixTracks<0>(selectedtracks_1[col1->index()], selectedtracks_2[col1->index()], centBin); // mixing SE non-identical, in <> brackets: 0 -- SE; 1 -- ME
-
-          for (unsigned int indx2 = indx1 + 1; indx2 < EvPerBin; indx2++) { // nested loop for all the combinations of collisions in a chosen mult/vertex bin
-            if (_MEreductionFactor.value > 1) {
-              std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-              if (mt() % (_MEreductionFactor.value + 1) < _MEreductionFactor.value)
-                continue;
-            }
+        for (std::size_t indx2 = indx1 + 1; indx2 < binEnd; indx2++) { // nested loop for all the combinations of collisions in a chosen mult/vertex bin
+          if (_MEreductionFactor.value > 1) {
+            std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
+            if ((mt() % (_MEreductionFactor.value + 1)) < _MEreductionFactor.value)
+              continue;
+          }
 
-            auto col2 = (i->second)[indx2];
+          auto const& col2 = mixbins[indx2];
 
-            Pair->SetMagField2(col2->magField());
-            mixTracks<1>(selectedtracks_1[col1->index()], selectedtracks_2[col2->index()], centBin); // mixing ME non-identical, in <> brackets: 0 -- SE; 1 -- ME
-          }
+          mixTracks<1>(selectedtracks_1, col1, IsIdentical ? selectedtracks_1 : selectedtracks_2, col2, centBin); // mixing ME, in <> brackets: 0 -- SE; 1 -- ME
         }
       }
-
-    } //====================================== end of mixing non-identical ======================================
-
-    // clearing up
-    for (auto i = selectedtracks_1.begin(); i != selectedtracks_1.end(); i++)
-      (i->second).clear();
-    selectedtracks_1.clear();
-
-    if (!IsIdentical) {
-      for (auto i = selectedtracks_2.begin(); i != selectedtracks_2.end(); i++)
-        (i->second).clear();
-      selectedtracks_2.clear();
+      binBegin = binEnd;
     }
 
-    for (auto i = mixbins.begin(); i != mixbins.end(); i++)
-      (i->second).clear();
+    // clearing up
+    selectedtracks_1.Clear();
+    if (!IsIdentical)
+      selectedtracks_2.Clear();
     mixbins.clear();
   }
 };
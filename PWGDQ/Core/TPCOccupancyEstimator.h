@@ -0,0 +1,295 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TPCOccupancyEstimator.h
+/// \brief Sliding-window TPC occupancy estimators (contributors, mean and median time of the pile-up in a
+///        short and a long time window around each collision, separately for the A and C sides)
+
+#ifndef PWGDQ_CORE_TPCOCCUPANCYESTIMATOR_H_
+#define PWGDQ_CORE_TPCOCCUPANCYESTIMATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// TPC occupancy estimators, per collision of the dataframe (indexed by the collision global index)
+struct TPCOccupancyEstimates {
+  std::vector<float> oMeanTimeShortA;
+  std::vector<float> oMeanTimeShortC;
+  std::vector<float> oMeanTimeLongA;
+  std::vector<float> oMeanTimeLongC;
+  std::vector<float> oMedianTimeShortA;
+  std::vector<float> oMedianTimeShortC;
+  std::vector<float> oMedianTimeLongA;
+  std::vector<float> oMedianTimeLongC;
+  std::vector<int> oContribShortA;
+  std::vector<int> oContribShortC;
+  std::vector<int> oContribLongA;
+  std::vector<int> oContribLongC;
+
+  // grow to nCollisions entries, the new ones set to 0
+  void resize(std::size_t nCollisions)
+  {
+    oMeanTimeShortA.resize(nCollisions, 0);
+    oMeanTimeShortC.resize(nCollisions, 0);
+    oMeanTimeLongA.resize(nCollisions, 0);
+    oMeanTimeLongC.resize(nCollisions, 0);
+    oMedianTimeShortA.resize(nCollisions, 0);
+    oMedianTimeShortC.resize(nCollisions, 0);
+    oMedianTimeLongA.resize(nCollisions, 0);
+    oMedianTimeLongC.resize(nCollisions, 0);
+    oContribShortA.resize(nCollisions, 0);
+    oContribShortC.resize(nCollisions, 0);
+    oContribLongA.resize(nCollisions, 0);
+    oContribLongC.resize(nCollisions, 0);
+  }
+  void reset(std::size_t nCollisions)
+  {
+    oMeanTimeShortA.assign(nCollisions, 0);
+    oMeanTimeShortC.assign(nCollisions, 0);
+    oMeanTimeLongA.assign(nCollisions, 0);
+    oMeanTimeLongC.assign(nCollisions, 0);
+    oMedianTimeShortA.assign(nCollisions, 0);
+    oMedianTimeShortC.assign(nCollisions, 0);
+    oMedianTimeLongA.assign(nCollisions, 0);
+    oMedianTimeLongC.assign(nCollisions, 0);
+    oContribShortA.assign(nCollisions, 0);
+    oContribShortC.assign(nCollisions, 0);
+    oContribLongA.assign(nCollisions, 0);
+    oContribLongC.assign(nCollisions, 0);
+  }
+};
+
+// Computes the TPC occupancy estimators for all the collisions of a dataframe.
+// The collisions are added once and sorted by BC into flat arrays. The [past, future) windows of every collision are
+// then found with pointers moving forward only, and the number of contributors comes from prefix sums of the
+// multiplicities on each side. The mean and median times are accumulated over the window slice in BC order,
+// such that the results are the same as when summing the collisions BC by BC.
+class TPCOccupancyEstimator
+{
+ public:
+  TPCOccupancyEstimator() = default;
+
+  // window sizes in BC intervals
+  void setWindows(int64_t bcShortPast, int64_t bcShortFuture, int64_t bcLongPast, int64_t bcLongFuture, bool excludeShort)
+  {
+    fBcShortPast = bcShortPast;
+    fBcShortFuture = bcShortFuture;
+    fBcLongPast = bcLongPast;
+    fBcLongFuture = bcLongFuture;
+    fExcludeShort = excludeShort;
+  }
+  // BC spacing in micro-seconds and drift velocity in cm / mus
+  void setTimeScale(double bcUS, double vdrift)
+  {
+    fBcUS = bcUS;
+    fVdrift = vdrift;
+  }
+
+  void clear()
+  {
+    fCollisions.clear();
+  }
+  void reserve(std::size_t nCollisions)
+  {
+    fCollisions.reserve(nCollisions);
+  }
+  // NOTE: collisions with the same BC must be added in the order in which they should be summed
+  void add(int64_t collisionIndex, int64_t bc, float vtxZ, int32_t multPos, int32_t multNeg)
+  {
+    fCollisions.push_back({bc, collisionIndex, vtxZ, multPos, multNeg});
+  }
+
+  // Fills the estimators of the added collisions, the output must already be sized to hold all collision indices
+  void compute(TPCOccupancyEstimates& out)
+  {
+    const std::size_t n = fCollisions.size();
+    sortByBC();
+
+    std::size_t pastShort = 0, futureShort = 0, pastLong = 0, futureLong = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      const int64_t bc = fBC[i];
+      // first sorted entry with a BC not lower than the window edge; the future edges are excluded
+      while (pastShort < n && fBC[pastShort] < bc - fBcShortPast) {
+        pastShort++;
+      }
+      while (futureShort < n && fBC[futureShort] < bc + fBcShortFuture) {
+        futureShort++;
+      }
+      while (pastLong < n && fBC[pastLong] < bc - fBcLongPast) {
+        pastLong++;
+      }
+      while (futureLong < n && fBC[futureLong] < bc + fBcLongFuture) {
+        futureLong++;
+      }
+      const std::size_t longLow = pastLong;
+      const std::size_t longHigh = std::max(futureLong, longLow);
+      // only the collisions inside the long window are considered for the short one
+      const std::size_t shortLow = std::clamp(pastShort, longLow, longHigh);
+      const std::size_t shortHigh = std::clamp(futureShort, shortLow, longHigh);
+      const bool selfInLong = (i >= longLow && i < longHigh);
+      const bool selfInShort = (i >= shortLow && i < shortHigh);
+
+      const int64_t collision = fCollisionIndex[i];
+      int64_t contribShortA = windowSum(fPrefixMultPos, shortLow, shortHigh) - (selfInShort ? fMultPos[i] : 0);
+      int64_t contribShortC = windowSum(fPrefixMultNeg, shortLow, shortHigh) - (selfInShort ? fMultNeg[i] : 0);
+      int64_t contribLongA = windowSum(fPrefixMultPos, longLow, longHigh) - (selfInLong ? fMultPos[i] : 0);
+      int64_t contribLongC = windowSum(fPrefixMultNeg, longLow, longHigh) - (selfInLong ? fMultNeg[i] : 0);
+      if (fExcludeShort) {
+        contribLongA -= contribShortA;
+        contribLongC -= contribShortC;
+      }
+      out.oContribShortA[collision] = contribShortA;
+      out.oContribShortC[collision] = contribShortC;
+      out.oContribLongA[collision] = contribLongA;
+      out.oContribLongC[collision] = contribLongC;
+      out.oMeanTimeShortA[collision] = 0.0;
+      out.oMeanTimeShortC[collision] = 0.0;
+      out.oMeanTimeLongA[collision] = 0.0;
+      out.oMeanTimeLongC[collision] = 0.0;
+      out.oMedianTimeShortA[collision] = 0.0;
+      out.oMedianTimeShortC[collision] = 0.0;
+      out.oMedianTimeLongA[collision] = 0.0;
+      out.oMedianTimeLongC[collision] = 0.0;
+      // without contributors all the times stay at 0
+      if (contribShortA == 0 && contribShortC == 0 && contribLongA == 0 && contribLongC == 0) {
+        continue;
+      }
+
+      fTimesShortA.clear();
+      fTimesShortC.clear();
+      fTimesLongA.clear();
+      fTimesLongC.clear();
+      float meanTimeShortA = 0.0, meanTimeShortC = 0.0, meanTimeLongA = 0.0, meanTimeLongC = 0.0;
+      for (std::size_t j = longLow; j < longHigh; j++) {
+        if (j == i) {
+          continue;
+        }
+        // delta time due to the different BCs and to the difference in longitudinal position
+        float dt = (fBC[j] - bc) * fBcUS;
+        float dtDrift = (fVtxZ[j] - fVtxZ[i]) / fVdrift;
+        bool isShort = (j >= shortLow && j < shortHigh);
+
+        if (!(fExcludeShort && isShort)) {
+          meanTimeLongA += fMultPos[j] * (dt + dtDrift);
+          meanTimeLongC += fMultNeg[j] * (dt - dtDrift);
+          fTimesLongA.emplace_back(dt + dtDrift, fMultPos[j]);
+          fTimesLongC.emplace_back(dt - dtDrift, fMultNeg[j]);
+        }
+        if (isShort) {
+          meanTimeShortA += fMultPos[j] * (dt + dtDrift);
+          meanTimeShortC += fMultNeg[j] * (dt - dtDrift);
+          fTimesShortA.emplace_back(dt + dtDrift, fMultPos[j]);
+          fTimesShortC.emplace_back(dt - dtDrift, fMultNeg[j]);
+        }
+      }
+      // normalize to obtain the mean time
+      out.oMeanTimeShortA[collision] = (contribShortA > 0 ? meanTimeShortA / static_cast<int>(contribShortA) : meanTimeShortA);
+      out.oMeanTimeShortC[collision] = (contribShortC > 0 ? meanTimeShortC / static_cast<int>(contribShortC) : meanTimeShortC);
+      out.oMeanTimeLongA[collision] = (contribLongA > 0 ? meanTimeLongA / static_cast<int>(contribLongA) : meanTimeLongA);
+      out.oMeanTimeLongC[collision] = (contribLongC > 0 ? meanTimeLongC / static_cast<int>(contribLongC) : meanTimeLongC);
+      out.oMedianTimeShortA[collision] = medianTime(fTimesShortA, contribShortA);
+      out.oMedianTimeShortC[collision] = medianTime(fTimesShortC, contribShortC);
+      out.oMedianTimeLongA[collision] = medianTime(fTimesLongA, contribLongA);
+      out.oMedianTimeLongC[collision] = medianTime(fTimesLongC, contribLongC);
+    }
+  }
+
+ private:
+  struct Collision {
+    int64_t bc;
+    int64_t index;
+    float vtxZ;
+    int32_t multPos;
+    int32_t multNeg;
+  };
+
+  static int64_t windowSum(const std::vector<int64_t>& prefix, std::size_t low, std::size_t high)
+  {
+    return prefix[high] - prefix[low];
+  }
+
+  // stable sort by BC, then split into flat arrays and build the prefix sums of the multiplicities
+  void sortByBC()
+  {
+    std::stable_sort(fCollisions.begin(), fCollisions.end(), [](const Collision& a, const Collision& b) { return a.bc < b.bc; });
+    const std::size_t n = fCollisions.size();
+    fBC.resize(n);
+    fCollisionIndex.resize(n);
+    fVtxZ.resize(n);
+    fMultPos.resize(n);
+    fMultNeg.resize(n);
+    fPrefixMultPos.resize(n + 1);
+    fPrefixMultNeg.resize(n + 1);
+    fPrefixMultPos[0] = 0;
+    fPrefixMultNeg[0] = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      fBC[i] = fCollisions[i].bc;
+      fCollisionIndex[i] = fCollisions[i].index;
+      fVtxZ[i] = fCollisions[i].vtxZ;
+      fMultPos[i] = fCollisions[i].multPos;
+      fMultNeg[i] = fCollisions[i].multNeg;
+      fPrefixMultPos[i + 1] = fPrefixMultPos[i] + fMultPos[i];
+      fPrefixMultNeg[i + 1] = fPrefixMultNeg[i] + fMultNeg[i];
+    }
+  }
+
+  // Time at which the cumulative multiplicity, in increasing time order, exceeds half of the contributors.
+  // Contributions with exactly the same time count once, with the multiplicity of the last one in summing order.
+  static float medianTime(std::vector<std::pair<float, int32_t>>& times, int64_t contrib)
+  {
+    if (contrib <= 0 || times.empty()) {
+      return 0.0;
+    }
+    std::stable_sort(times.begin(), times.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    float sumMult = 0.0;
+    for (std::size_t k = 0; k < times.size(); k++) {
+      // skip to the last entry with the same time
+      std::size_t last = k;
+      while (last + 1 < times.size() && !(times[k].first < times[last + 1].first)) {
+        last++;
+      }
+      sumMult += times[last].second;
+      if (sumMult > static_cast<int>(contrib) / 2.0) {
+        return times[k].first;
+      }
+      k = last;
+    }
+    return 0.0;
+  }
+
+  int64_t fBcShortPast = 0;
+  int64_t fBcShortFuture = 0;
+  int64_t fBcLongPast = 0;
+  int64_t fBcLongFuture = 0;
+  bool fExcludeShort = true;
+  double fBcUS = 0.025;
+  double fVdrift = 2.5;
+
+  std::vector<Collision> fCollisions;
+  // flat arrays, sorted by BC
+  std::vector<int64_t> fBC;
+  std::vector<int64_t> fCollisionIndex;
+  std::vector<float> fVtxZ;
+  std::vector<int32_t> fMultPos;
+  std::vector<int32_t> fMultNeg;
+  std::vector<int64_t> fPrefixMultPos;
+  std::vector<int64_t> fPrefixMultNeg;
+  // (time, multiplicity) of the contributors in the windows of the current collision
+  std::vector<std::pair<float, int32_t>> fTimesShortA;
+  std::vector<std::pair<float, int32_t>> fTimesShortC;
+  std::vector<std::pair<float, int32_t>> fTimesLongA;
+  std::vector<std::pair<float, int32_t>> fTimesLongC;
+};
+
+#endif // PWGDQ_CORE_TPCOCCUPANCYESTIMATOR_H_
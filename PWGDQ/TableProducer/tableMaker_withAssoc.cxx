@@ -24,6 +24,7 @@
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/MuonMatchingMlResponse.h"
+#include "PWGDQ/Core/TPCOccupancyEstimator.h"
 #include "PWGDQ/Core/VarManager.h"
 #include "PWGDQ/DataModel/ReducedInfoTables.h"
 
@@ -79,6 +80,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
@@ -184,6 +186,40 @@ namespace dqtablemaker_helpers
 inline float* varValues() { return static_cast<float*>(VarManager::fgValues); }
 inline TString* varNames() { return static_cast<TString*>(VarManager::fgVariableNames); }
 inline TString* varUnits() { return static_cast<TString*>(VarManager::fgVariableUnits); }
+
+// old -> new index translation used for the skimming of one dataframe, stored densely over the original table
+// Entries which were not skimmed hold kNotSkimmed
+struct DenseIndexMap {
+  static constexpr uint32_t kNotSkimmed = std::numeric_limits<uint32_t>::max();
+
+  void reset(std::size_t nEntries)
+  {
+    fNewIndex.assign(nEntries, kNotSkimmed);
+    fNSkimmed = 0;
+  }
+  bool contains(int64_t oldIndex) const
+  {
+    return oldIndex >= 0 && static_cast<std::size_t>(oldIndex) < fNewIndex.size() && fNewIndex[oldIndex] != kNotSkimmed;
+  }
+  // NOTE: the entry must be contained
+  uint32_t operator[](int64_t oldIndex) const { return fNewIndex[oldIndex]; }
+  void set(int64_t oldIndex, uint32_t newIndex)
+  {
+    if (static_cast<std::size_t>(oldIndex) >= fNewIndex.size()) {
+      fNewIndex.resize(oldIndex + 1, kNotSkimmed);
+    }
+    if (fNewIndex[oldIndex] == kNotSkimmed) {
+      fNSkimmed++;
+    }
+    fNewIndex[oldIndex] = newIndex;
+  }
+  bool empty() const { return fNSkimmed == 0; }
+  std::size_t size() const { return fNewIndex.size(); } // number of entries of the original table, skimmed or not
+
+ private:
+  std::vector<uint32_t> fNewIndex;
+  std::size_t fNSkimmed = 0;
+};
 } // namespace dqtablemaker_helpers
 
 struct TableMaker {
@@ -338,15 +374,15 @@ struct TableMaker {
   bool fDoDetailedQA = false; // Bool to set detailed QA true, if QA is set true
   int fCurrentRun = -1;       // needed to detect if the run changed and trigger update of calibrations etc.
 
-  // maps used to store index info; NOTE: std::map are sorted in ascending order by default (needed for track to collision indices)
-  std::map<uint32_t, uint32_t> fCollIndexMap;             // key: old collision index, value: skimmed collision index
-  std::map<uint32_t, uint32_t> fTrackIndexMap;            // key: old track global index, value: new track global index
-  std::map<uint32_t, uint32_t> fFwdTrackIndexMap;         // key: fwd-track global index, value: new fwd-track global index
-  std::map<uint32_t, uint32_t> fFwdTrackIndexMapReversed; // key: new fwd-track global index, value: fwd-track global index
-  std::map<uint32_t, uint8_t> fFwdTrackFilterMap;         // key: fwd-track global index, value: fwd-track filter map
-  std::map<uint32_t, uint32_t> fMftIndexMap;              // key: MFT tracklet global index, value: new MFT tracklet global index
+  // index maps, dense over the tables of the dataframe; NOTE: collisions are looped in ascending order of the old index (needed for track to collision indices)
+  dqtablemaker_helpers::DenseIndexMap fCollIndexMap;     // old collision index -> skimmed collision index
+  dqtablemaker_helpers::DenseIndexMap fTrackIndexMap;    // old track global index -> new track global index
+  dqtablemaker_helpers::DenseIndexMap fFwdTrackIndexMap; // fwd-track global index -> new fwd-track global index
+  std::vector<uint32_t> fFwdTrackIndexMapReversed;       // fwd-track global index of the muons skimmed for the current collision, in order of the new index
+  std::vector<uint8_t> fFwdTrackFilterMap;               // fwd-track global index -> fwd-track filter map
+  dqtablemaker_helpers::DenseIndexMap fMftIndexMap;      // MFT tracklet global index -> new MFT tracklet global index
 
-  std::map<uint32_t, bool> fBestMatch;
+  std::vector<bool> fBestMatch; // fwd-track global index -> best MCH-MFT match
   std::unordered_map<int64_t, int32_t> map_mfttrackcovs;
 
   o2::analysis::MlResponseMFTMuonMatch<float> matchingMlResponse;
@@ -392,49 +428,97 @@ struct TableMaker {
   Zorro zorro;
   parameters::GRPLHCIFData* mLHCIFdata = nullptr;
 
+  TPCOccupancyEstimates fOccup;          // TPC occupancy estimators, per collision of the dataframe (indexed by the collision global index)
+  TPCOccupancyEstimator fOccupEstimator; // engine computing fOccup
+
+  // variables to store quantities needed for tagging collision merging candidates, per collision of the dataframe (indexed by the collision global index)
   struct {
-    std::map<int32_t, float> oMeanTimeShortA;
-    std::map<int32_t, float> oMeanTimeShortC;
-    std::map<int32_t, float> oMeanTimeLongA;
-    std::map<int32_t, float> oMeanTimeLongC;
-    std::map<int32_t, float> oMedianTimeShortA;
-    std::map<int32_t, float> oMedianTimeShortC;
-    std::map<int32_t, float> oMedianTimeLongA;
-    std::map<int32_t, float> oMedianTimeLongC;
-    std::map<int32_t, int> oContribShortA;
-    std::map<int32_t, int> oContribShortC;
-    std::map<int32_t, int> oContribLongA;
-    std::map<int32_t, int> oContribLongC;
-  } fOccup;
-
-  // variables to store quantities needed for tagging collision merging candidates
-  struct {
-    std::map<int32_t, float> bimodalityCoeffDCAz;               // Bimodality coefficient of the DCAz distribution of tracks associated to a collision
-    std::map<int32_t, float> bimodalityCoeffDCAzBinned;         // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned
-    std::map<int32_t, float> bimodalityCoeffDCAzBinnedTrimmed1; // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned and trimmed 1
-    std::map<int32_t, float> bimodalityCoeffDCAzBinnedTrimmed2; // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned and trimmed 2
-    std::map<int32_t, float> bimodalityCoeffDCAzBinnedTrimmed3; // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned and trimmed 3
-    std::map<int32_t, float> meanDCAz;
-    std::map<int32_t, float> meanDCAzBinnedTrimmed1;
-    std::map<int32_t, float> meanDCAzBinnedTrimmed2;
-    std::map<int32_t, float> meanDCAzBinnedTrimmed3;
-    std::map<int32_t, float> rmsDCAz;
-    std::map<int32_t, float> rmsDCAzBinnedTrimmed1;
-    std::map<int32_t, float> rmsDCAzBinnedTrimmed2;
-    std::map<int32_t, float> rmsDCAzBinnedTrimmed3;
-    std::map<int32_t, float> skewnessDCAz;
-    std::map<int32_t, float> kurtosisDCAz;
-    std::map<int32_t, float> fraction100umDCAz; // fraction of tracks with |DCAz|>100um
-    std::map<int32_t, float> fraction200umDCAz; // fraction of tracks with |DCAz|>200um
-    std::map<int32_t, float> fraction500umDCAz; // fraction of tracks with |DCAz|>500um
-    std::map<int32_t, float> fraction1mmDCAz;   // fraction of tracks with |DCAz|>1mm
-    std::map<int32_t, float> fraction2mmDCAz;   // fraction of tracks with |DCAz|>2mm
-    std::map<int32_t, float> fraction5mmDCAz;   // fraction of tracks with |DCAz|>5mm
-    std::map<int32_t, float> fraction10mmDCAz;  // fraction of tracks with |DCAz|>10mm
-    std::map<int32_t, int> nPeaksDCAz;          // number of peaks in the DCAz distribution of tracks associated to a collision
-    std::map<int32_t, int> nPeaksDCAzTrimmed1;  // number of peaks in the binned DCAz distribution (trimmed 1)
-    std::map<int32_t, int> nPeaksDCAzTrimmed2;  // number of peaks in the binned DCAz distribution (trimmed 2)
-    std::map<int32_t, int> nPeaksDCAzTrimmed3;  // number of peaks in the binned DCAz distribution (trimmed 3)
+    std::vector<float> bimodalityCoeffDCAz;               // Bimodality coefficient of the DCAz distribution of tracks associated to a collision
+    std::vector<float> bimodalityCoeffDCAzBinned;         // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned
+    std::vector<float> bimodalityCoeffDCAzBinnedTrimmed1; // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned and trimmed 1
+    std::vector<float> bimodalityCoeffDCAzBinnedTrimmed2; // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned and trimmed 2
+    std::vector<float> bimodalityCoeffDCAzBinnedTrimmed3; // Bimodality coefficient of the DCAz distribution of tracks associated to a collision, binned and trimmed 3
+    std::vector<float> meanDCAz;
+    std::vector<float> meanDCAzBinnedTrimmed1;
+    std::vector<float> meanDCAzBinnedTrimmed2;
+    std::vector<float> meanDCAzBinnedTrimmed3;
+    std::vector<float> rmsDCAz;
+    std::vector<float> rmsDCAzBinnedTrimmed1;
+    std::vector<float> rmsDCAzBinnedTrimmed2;
+    std::vector<float> rmsDCAzBinnedTrimmed3;
+    std::vector<float> skewnessDCAz;
+    std::vector<float> kurtosisDCAz;
+    std::vector<float> fraction100umDCAz; // fraction of tracks with |DCAz|>100um
+    std::vector<float> fraction200umDCAz; // fraction of tracks with |DCAz|>200um
+    std::vector<float> fraction500umDCAz; // fraction of tracks with |DCAz|>500um
+    std::vector<float> fraction1mmDCAz;   // fraction of tracks with |DCAz|>1mm
+    std::vector<float> fraction2mmDCAz;   // fraction of tracks with |DCAz|>2mm
+    std::vector<float> fraction5mmDCAz;   // fraction of tracks with |DCAz|>5mm
+    std::vector<float> fraction10mmDCAz;  // fraction of tracks with |DCAz|>10mm
+    std::vector<int> nPeaksDCAz;          // number of peaks in the DCAz distribution of tracks associated to a collision
+    std::vector<int> nPeaksDCAzTrimmed1;  // number of peaks in the binned DCAz distribution (trimmed 1)
+    std::vector<int> nPeaksDCAzTrimmed2;  // number of peaks in the binned DCAz distribution (trimmed 2)
+    std::vector<int> nPeaksDCAzTrimmed3;  // number of peaks in the binned DCAz distribution (trimmed 3)
+
+    // grow to nCollisions entries, the new ones set to 0
+    void resize(std::size_t nCollisions)
+    {
+      bimodalityCoeffDCAz.resize(nCollisions, 0);
+      bimodalityCoeffDCAzBinned.resize(nCollisions, 0);
+      bimodalityCoeffDCAzBinnedTrimmed1.resize(nCollisions, 0);
+      bimodalityCoeffDCAzBinnedTrimmed2.resize(nCollisions, 0);
+      bimodalityCoeffDCAzBinnedTrimmed3.resize(nCollisions, 0);
+      meanDCAz.resize(nCollisions, 0);
+      meanDCAzBinnedTrimmed1.resize(nCollisions, 0);
+      meanDCAzBinnedTrimmed2.resize(nCollisions, 0);
+      meanDCAzBinnedTrimmed3.resize(nCollisions, 0);
+      rmsDCAz.resize(nCollisions, 0);
+      rmsDCAzBinnedTrimmed1.resize(nCollisions, 0);
+      rmsDCAzBinnedTrimmed2.resize(nCollisions, 0);
+      rmsDCAzBinnedTrimmed3.resize(nCollisions, 0);
+      skewnessDCAz.resize(nCollisions, 0);
+      kurtosisDCAz.resize(nCollisions, 0);
+      fraction100umDCAz.resize(nCollisions, 0);
+      fraction200umDCAz.resize(nCollisions, 0);
+      fraction500umDCAz.resize(nCollisions, 0);
+      fraction1mmDCAz.resize(nCollisions, 0);
+      fraction2mmDCAz.resize(nCollisions, 0);
+      fraction5mmDCAz.resize(nCollisions, 0);
+      fraction10mmDCAz.resize(nCollisions, 0);
+      nPeaksDCAz.resize(nCollisions, 0);
+      nPeaksDCAzTrimmed1.resize(nCollisions, 0);
+      nPeaksDCAzTrimmed2.resize(nCollisions, 0);
+      nPeaksDCAzTrimmed3.resize(nCollisions, 0);
+    }
+    void reset(std::size_t nCollisions)
+    {
+      bimodalityCoeffDCAz.assign(nCollisions, 0);
+      bimodalityCoeffDCAzBinned.assign(nCollisions, 0);
+      bimodalityCoeffDCAzBinnedTrimmed1.assign(nCollisions, 0);
+      bimodalityCoeffDCAzBinnedTrimmed2.assign(nCollisions, 0);
+      bimodalityCoeffDCAzBinnedTrimmed3.assign(nCollisions, 0);
+      meanDCAz.assign(nCollisions, 0);
+      meanDCAzBinnedTrimmed1.assign(nCollisions, 0);
+      meanDCAzBinnedTrimmed2.assign(nCollisions, 0);
+      meanDCAzBinnedTrimmed3.assign(nCollisions, 0);
+      rmsDCAz.assign(nCollisions, 0);
+      rmsDCAzBinnedTrimmed1.assign(nCollisions, 0);
+      rmsDCAzBinnedTrimmed2.assign(nCollisions, 0);
+      rmsDCAzBinnedTrimmed3.assign(nCollisions, 0);
+      skewnessDCAz.assign(nCollisions, 0);
+      kurtosisDCAz.assign(nCollisions, 0);
+      fraction100umDCAz.assign(nCollisions, 0);
+      fraction200umDCAz.assign(nCollisions, 0);
+      fraction500umDCAz.assign(nCollisions, 0);
+      fraction1mmDCAz.assign(nCollisions, 0);
+      fraction2mmDCAz.assign(nCollisions, 0);
+      fraction5mmDCAz.assign(nCollisions, 0);
+      fraction10mmDCAz.assign(nCollisions, 0);
+      nPeaksDCAz.assign(nCollisions, 0);
+      nPeaksDCAzTrimmed1.assign(nCollisions, 0);
+      nPeaksDCAzTrimmed2.assign(nCollisions, 0);
+      nPeaksDCAzTrimmed3.assign(nCollisions, 0);
+    }
   } fCollMergingTag;
 
   void init(o2::framework::InitContext& context)
@@ -720,25 +804,8 @@ struct TableMaker {
   void computeOccupancyEstimators(TEvents const& collisions, Partition<TTracks> const& tracksPosPart, Partition<TTracks> const& tracksNegPart, Preslice<TTracks>& presliceTracks, TBCs const&)
   {
 
-    // clear the occupancy maps for this time frame
-    fOccup.oMeanTimeLongA.clear();
-    fOccup.oMeanTimeLongC.clear();
-    fOccup.oMeanTimeShortA.clear();
-    fOccup.oMeanTimeShortC.clear();
-    fOccup.oMedianTimeLongA.clear();
-    fOccup.oMedianTimeLongC.clear();
-    fOccup.oMedianTimeShortA.clear();
-    fOccup.oMedianTimeShortC.clear();
-    fOccup.oContribLongA.clear();
-    fOccup.oContribLongC.clear();
-    fOccup.oContribShortA.clear();
-    fOccup.oContribShortC.clear();
-
-    std::map<int64_t, int64_t> oBC;                      // key: collision index; value: global BC
-    std::map<int64_t, std::vector<int64_t>> oBCreversed; // key: global BC, value: list of collisions attached to this BC
-    std::map<int64_t, float> oVtxZ;                      // key: collision index; value: vtx-z position
-    std::map<int64_t, int32_t> collMultPos;              // key: collision index; value: tpc multiplicity on the A side
-    std::map<int64_t, int32_t> collMultNeg;              // key: collision index; value: tpc multiplicity on the C side
+    // clear the occupancy estimators for this time frame
+    fOccup.reset(collisions.size());
 
     const double bcUS = o2::constants::lhc::LHCBunchSpacingNS / 1000.0;               // BC spacing in micro-seconds
     const double vdrift = 2.5;                                                        // cm / mus
@@ -746,149 +813,22 @@ struct TableMaker {
     int32_t bcShortFuture = std::lrint(fConfigVariousOptions.fTPCShortFuture / bcUS); // (close in time collisions) 8 micro-seconds in BC intervals
     int32_t bcLongPast = std::lrint(fConfigVariousOptions.fTPCLongPast / bcUS);       // (wide time range collisions) past 40 micro-seconds in BC intervals
     int32_t bcLongFuture = std::lrint(fConfigVariousOptions.fTPCLongFuture / bcUS);   // // (wide time range collisions) future 100 micro-seconds in BC intervals
+    fOccupEstimator.setWindows(bcShortPast, bcShortFuture, bcLongPast, bcLongFuture, fConfigVariousOptions.fExcludeShort);
+    fOccupEstimator.setTimeScale(bcUS, vdrift);
+    fOccupEstimator.clear();
+    fOccupEstimator.reserve(collisions.size());
 
     // Loop over collisions and extract needed info (BC, vtxZ, multiplicity separately in A and C sides)
     for (const auto& collision : collisions) {
-
       auto bcEvSel = collision.template foundBC_as<TBCs>();
-      int64_t bc = bcEvSel.globalBC();
-      oBC[collision.globalIndex()] = bc;
-      oVtxZ[collision.globalIndex()] = collision.posZ();
-
-      // if more than one collision per bunch, add that collision to the list for that bunch
-      if (!oBCreversed.contains(bc)) {
-        std::vector<int64_t> evs = {collision.globalIndex()};
-        oBCreversed[bc] = evs;
-      } else {
-        auto& evs = oBCreversed[bc];
-        evs.push_back(collision.globalIndex());
-      }
-
       // make a slice for this collision and get the number of tracks
       auto thisCollTrackPos = tracksPosPart.sliceBy(presliceTracks, collision.globalIndex());
       auto thisCollTrackNeg = tracksNegPart.sliceBy(presliceTracks, collision.globalIndex());
-      collMultPos[collision.globalIndex()] = thisCollTrackPos.size();
-      collMultNeg[collision.globalIndex()] = thisCollTrackNeg.size();
+      fOccupEstimator.add(collision.globalIndex(), bcEvSel.globalBC(), collision.posZ(), thisCollTrackPos.size(), thisCollTrackNeg.size());
     }
 
-    // loop over collisions and sum the multiplicity in the past and future
-    for (const auto& [collision, bc] : oBC) {
-
-      int64_t pastShortBC = oBCreversed.lower_bound(bc - bcShortPast)->first;
-      int64_t futureShortBC = oBCreversed.lower_bound(bc + bcShortFuture)->first;
-      int64_t pastLongBC = oBCreversed.lower_bound(bc - bcLongPast)->first;
-      int64_t futureLongBC = oBCreversed.lower_bound(bc + bcLongFuture)->first;
-
-      fOccup.oContribLongA[collision] = 0;
-      fOccup.oContribLongC[collision] = 0;
-      fOccup.oMeanTimeLongA[collision] = 0.0;
-      fOccup.oMeanTimeLongC[collision] = 0.0;
-      fOccup.oContribShortA[collision] = 0;
-      fOccup.oContribShortC[collision] = 0;
-      fOccup.oMeanTimeShortA[collision] = 0.0;
-      fOccup.oMeanTimeShortC[collision] = 0.0;
-      std::map<float, int> oTimeMapShortA;
-      std::map<float, int> oTimeMapShortC;
-      std::map<float, int> oTimeMapLongA;
-      std::map<float, int> oTimeMapLongC;
-      // loop over the BCs in the past and future wrt this one
-      for (auto bcIt = oBCreversed.find(pastLongBC); bcIt != oBCreversed.find(futureLongBC); ++bcIt) {
-        int64_t thisBC = bcIt->first;
-        auto colls = bcIt->second;
-        // delta time due to the different BCs
-        float dt = (thisBC - bc) * bcUS;
-        // check if this collision is also within the short time range
-        bool isShort = (thisBC >= pastShortBC && thisBC < futureShortBC);
-        // loop over all collisions in this BC
-        for (const auto& thisColl : colls) {
-          // skip if this is the same collision
-          if (thisColl == collision) {
-            continue;
-          }
-          // compute the delta time due to the difference in longitudinal position
-          float dtDrift = (oVtxZ[thisColl] - oVtxZ[collision]) / vdrift;
-
-          if (!(fConfigVariousOptions.fExcludeShort && isShort)) {
-            // sum the collision multiplicity on A and C sides
-            fOccup.oContribLongA[collision] += collMultPos[thisColl];
-            fOccup.oContribLongC[collision] += collMultNeg[thisColl];
-            // compute the multiplicity weighted average time
-            fOccup.oMeanTimeLongA[collision] += collMultPos[thisColl] * (dt + dtDrift);
-            fOccup.oMeanTimeLongC[collision] += collMultNeg[thisColl] * (dt - dtDrift);
-            // fill the time map
-            oTimeMapLongA[dt + dtDrift] = collMultPos[thisColl];
-            oTimeMapLongC[dt - dtDrift] = collMultNeg[thisColl];
-          }
-
-          if (isShort) {
-            fOccup.oContribShortA[collision] += collMultPos[thisColl];
-            fOccup.oContribShortC[collision] += collMultNeg[thisColl];
-            fOccup.oMeanTimeShortA[collision] += collMultPos[thisColl] * (dt + dtDrift);
-            fOccup.oMeanTimeShortC[collision] += collMultNeg[thisColl] * (dt - dtDrift);
-            oTimeMapShortA[dt + dtDrift] = collMultPos[thisColl];
-            oTimeMapShortC[dt - dtDrift] = collMultNeg[thisColl];
-          }
-        }
-      }
-      // normalize to obtain the mean time
-      if (fOccup.oContribLongA[collision] > 0) {
-        fOccup.oMeanTimeLongA[collision] /= fOccup.oContribLongA[collision];
-      }
-      if (fOccup.oContribLongC[collision] > 0) {
-        fOccup.oMeanTimeLongC[collision] /= fOccup.oContribLongC[collision];
-      }
-      if (fOccup.oContribShortA[collision] > 0) {
-        fOccup.oMeanTimeShortA[collision] /= fOccup.oContribShortA[collision];
-      }
-      if (fOccup.oContribShortC[collision] > 0) {
-        fOccup.oMeanTimeShortC[collision] /= fOccup.oContribShortC[collision];
-      }
-      // iterate over the time maps to obtain the median time
-      fOccup.oMedianTimeLongA[collision] = 0.0;
-      float sumMult = 0.0;
-      if (!oTimeMapLongA.empty()) {
-        for (const auto& [dt, mult] : oTimeMapLongA) {
-          sumMult += mult;
-          if (sumMult > fOccup.oContribLongA[collision] / 2.0) {
-            fOccup.oMedianTimeLongA[collision] = dt;
-            break;
-          }
-        }
-      }
-      fOccup.oMedianTimeLongC[collision] = 0.0;
-      sumMult = 0.0;
-      if (!oTimeMapLongC.empty()) {
-        for (const auto& [dt, mult] : oTimeMapLongC) {
-          sumMult += mult;
-          if (sumMult > fOccup.oContribLongC[collision] / 2.0) {
-            fOccup.oMedianTimeLongC[collision] = dt;
-            break;
-          }
-        }
-      }
-      fOccup.oMedianTimeShortA[collision] = 0.0;
-      sumMult = 0.0;
-      if (!oTimeMapShortA.empty()) {
-        for (const auto& [dt, mult] : oTimeMapShortA) {
-          sumMult += mult;
-          if (sumMult > fOccup.oContribShortA[collision] / 2.0) {
-            fOccup.oMedianTimeShortA[collision] = dt;
-            break;
-          }
-        }
-      }
-      fOccup.oMedianTimeShortC[collision] = 0.0;
-      sumMult = 0.0;
-      if (!oTimeMapShortC.empty()) {
-        for (const auto& [dt, mult] : oTimeMapShortC) {
-          sumMult += mult;
-          if (sumMult > fOccup.oContribShortC[collision] / 2.0) {
-            fOccup.oMedianTimeShortC[collision] = dt;
-            break;
-          }
-        }
-      }
-    } // end loop over collisions
+    // sum the multiplicity in the past and future of each collision
+    fOccupEstimator.compute(fOccup);
   }
 
   // Function to compute the mu for pileup estimation, taken from EM code
@@ -911,39 +851,14 @@ struct TableMaker {
   void computeCollMergingTag(TEvents const& collisions, TTracks const& tracks, Preslice<TTracks>& presliceTracks)
   {
     // This function uses the standard track-collision association to compute quantities related to collision merging
-    // clear the maps for this time frame
-    fCollMergingTag.bimodalityCoeffDCAz.clear();
-    fCollMergingTag.bimodalityCoeffDCAzBinned.clear();
-    fCollMergingTag.bimodalityCoeffDCAzBinnedTrimmed1.clear();
-    fCollMergingTag.bimodalityCoeffDCAzBinnedTrimmed2.clear();
-    fCollMergingTag.bimodalityCoeffDCAzBinnedTrimmed3.clear();
-    fCollMergingTag.meanDCAz.clear();
-    fCollMergingTag.meanDCAzBinnedTrimmed1.clear();
-    fCollMergingTag.meanDCAzBinnedTrimmed2.clear();
-    fCollMergingTag.meanDCAzBinnedTrimmed3.clear();
-    fCollMergingTag.rmsDCAz.clear();
-    fCollMergingTag.rmsDCAzBinnedTrimmed1.clear();
-    fCollMergingTag.rmsDCAzBinnedTrimmed2.clear();
-    fCollMergingTag.rmsDCAzBinnedTrimmed3.clear();
-    fCollMergingTag.skewnessDCAz.clear();
-    fCollMergingTag.kurtosisDCAz.clear();
-    fCollMergingTag.fraction100umDCAz.clear();
-    fCollMergingTag.fraction200umDCAz.clear();
-    fCollMergingTag.fraction500umDCAz.clear();
-    fCollMergingTag.fraction1mmDCAz.clear();
-    fCollMergingTag.fraction2mmDCAz.clear();
-    fCollMergingTag.fraction5mmDCAz.clear();
-    fCollMergingTag.fraction10mmDCAz.clear();
-    fCollMergingTag.nPeaksDCAz.clear();
-    fCollMergingTag.nPeaksDCAzTrimmed1.clear();
-    fCollMergingTag.nPeaksDCAzTrimmed2.clear();
-    fCollMergingTag.nPeaksDCAzTrimmed3.clear();
+    // clear the quantities for this time frame
+    fCollMergingTag.reset(collisions.size());
 
     for (const auto& collision : collisions) {
       // make a slice for this collision and compute the DCAz based event quantities
       auto thisCollTracks = tracks.sliceBy(presliceTracks, collision.globalIndex());
       VarManager::FillEventTracks(thisCollTracks); // fill the VarManager arrays with the information of the tracks associated to this collision, needed for the cuts and histograms
-      // add the computed variables to the maps with the collision index as key
+      // add the computed variables at the collision index
       fCollMergingTag.bimodalityCoeffDCAz[collision.globalIndex()] = VarManager::fgValues[VarManager::kDCAzBimodalityCoefficient];
       fCollMergingTag.bimodalityCoeffDCAzBinned[collision.globalIndex()] = VarManager::fgValues[VarManager::kDCAzBimodalityCoefficientBinned];
       fCollMergingTag.bimodalityCoeffDCAzBinnedTrimmed1[collision.globalIndex()] = VarManager::fgValues[VarManager::kDCAzBimodalityCoefficientBinnedTrimmed1];
@@ -983,7 +898,10 @@ struct TableMaker {
     //      The collision-track associations which point to an event that is not selected for writing are discarded!
 
     VarManager::FillTimeFrame(collisions);
-    fCollIndexMap.clear();
+    fCollIndexMap.reset(collisions.size());
+    // collisions not covered by the occupancy and merging tag computations read as 0
+    fOccup.resize(collisions.size());
+    fCollMergingTag.resize(collisions.size());
     int multTPC = -1.0;
     float multFV0A = -1.0;
     float multFV0C = -1.0;
@@ -1265,7 +1183,7 @@ struct TableMaker {
                              fCollMergingTag.nPeaksDCAzTrimmed2[collision.globalIndex()], fCollMergingTag.nPeaksDCAzTrimmed3[collision.globalIndex()]);
 
       //
-      fCollIndexMap[collision.globalIndex()] = outTables.event.lastIndex();
+      fCollIndexMap.set(collision.globalIndex(), outTables.event.lastIndex());
     }
   }
 
@@ -1292,7 +1210,7 @@ struct TableMaker {
       // If the original collision of this track was not selected for skimming, then we skip this track.
       //  Normally, the filter-pp is selecting all collisions which contain the tracks which contributed to the triggering
       //    of an event, so this is rejecting possibly a few tracks unrelated to the trigger, originally associated with collisions distant in time.
-      if (fCollIndexMap.find(track.collisionId()) == fCollIndexMap.end()) {
+      if (!fCollIndexMap.contains(track.collisionId())) {
         continue;
       }
 
@@ -1316,7 +1234,7 @@ struct TableMaker {
           trackTempFilterMap |= (static_cast<uint32_t>(1) << i);
           // NOTE: the QA is filled here just for the first occurence of this track.
           //    So if there are histograms of quantities which depend on the collision association, these will not be accurate
-          if (fConfigHistOutput.fConfigQA && (fTrackIndexMap.find(track.globalIndex()) == fTrackIndexMap.end())) {
+          if (fConfigHistOutput.fConfigQA && !fTrackIndexMap.contains(track.globalIndex())) {
             fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut)->GetName()), dqtablemaker_helpers::varValues());
           }
           (dynamic_cast<TH1D*>(fStatsList->At(kStatsTracks)))->Fill(static_cast<float>(i));
@@ -1328,7 +1246,7 @@ struct TableMaker {
 
       // If this track is already present in the index map, it means it was already skimmed,
       // so we just store the association and we skip the track
-      if (fTrackIndexMap.find(track.globalIndex()) != fTrackIndexMap.end()) {
+      if (fTrackIndexMap.contains(track.globalIndex())) {
         outTables.trackBarrelAssoc(fCollIndexMap[collision.globalIndex()], fTrackIndexMap[track.globalIndex()]);
         continue;
       }
@@ -1423,7 +1341,7 @@ struct TableMaker {
                                  -999.0);
       }
 
-      fTrackIndexMap[track.globalIndex()] = outTables.trackBasic.lastIndex();
+      fTrackIndexMap.set(track.globalIndex(), outTables.trackBasic.lastIndex());
 
       // write the skimmed collision - track association
       outTables.trackBarrelAssoc(fCollIndexMap[collision.globalIndex()], fTrackIndexMap[track.globalIndex()]);
@@ -1451,7 +1369,7 @@ struct TableMaker {
         // TODO: We are not writing the DCA at the moment, because this depend on the collision association
         outTables.mftTrackExtra(track.mftClusterSizesAndTrackFlags(), track.sign(), 0.0, 0.0, track.nClusters());
 
-        fMftIndexMap[track.globalIndex()] = outTables.mftTrack.lastIndex();
+        fMftIndexMap.set(track.globalIndex(), outTables.mftTrack.lastIndex());
       }
       outTables.mftAssoc(fCollIndexMap[collision.globalIndex()], fMftIndexMap[track.globalIndex()]);
     }
@@ -1533,7 +1451,7 @@ struct TableMaker {
       // get the muon
       auto muon = muons.rawIteratorAt(assoc.fwdtrackId());
       if (fConfigVariousOptions.fKeepBestMatch && static_cast<int>(muon.trackType()) < 2) {
-        if (fBestMatch.find(muon.globalIndex()) == fBestMatch.end()) {
+        if (!fBestMatch[muon.globalIndex()]) {
           continue;
         }
       }
@@ -1586,7 +1504,7 @@ struct TableMaker {
           // NOTE: the QA is filled here just for the first occurence of this muon, which means the current association
           //     will be skipped from histograms if this muon was already filled in the skimming map.
           //    So if there are histograms of quantities which depend on the collision association, these histograms will not be completely accurate
-          if (fConfigHistOutput.fConfigQA && (fFwdTrackIndexMap.find(muon.globalIndex()) == fFwdTrackIndexMap.end())) {
+          if (fConfigHistOutput.fConfigQA && !fFwdTrackIndexMap.contains(muon.globalIndex())) {
             fHistMan->FillHistClass(Form("Muons_%s", (*cut)->GetName()), dqtablemaker_helpers::varValues());
           }
           (dynamic_cast<TH1D*>(fStatsList->At(kStatsMuons)))->Fill(static_cast<float>(i));
@@ -1600,15 +1518,15 @@ struct TableMaker {
       trackFilteringTag = trackTempFilterMap; // BIT0-7:  user selection cuts
 
       // update the index map if this is a new muon (it can already exist in the map from a different collision association)
-      if (fFwdTrackIndexMap.find(muon.globalIndex()) == fFwdTrackIndexMap.end()) {
+      if (!fFwdTrackIndexMap.contains(muon.globalIndex())) {
         counter++;
-        fFwdTrackIndexMap[muon.globalIndex()] = offset + counter;
-        fFwdTrackIndexMapReversed[offset + counter] = muon.globalIndex();
-        fFwdTrackFilterMap[muon.globalIndex()] = trackFilteringTag;                                                    // store here the filtering tag so we don't repeat the cuts in the second iteration
-        if (muon.has_matchMCHTrack() && (fFwdTrackIndexMap.find(muon.matchMCHTrackId()) == fFwdTrackIndexMap.end())) { // write also the matched MCH track
+        fFwdTrackIndexMap.set(muon.globalIndex(), offset + counter);
+        fFwdTrackIndexMapReversed.push_back(muon.globalIndex());
+        fFwdTrackFilterMap[muon.globalIndex()] = trackFilteringTag;                             // store here the filtering tag so we don't repeat the cuts in the second iteration
+        if (muon.has_matchMCHTrack() && !fFwdTrackIndexMap.contains(muon.matchMCHTrackId())) { // write also the matched MCH track
           counter++;
-          fFwdTrackIndexMap[muon.matchMCHTrackId()] = offset + counter;
-          fFwdTrackIndexMapReversed[offset + counter] = muon.matchMCHTrackId();
+          fFwdTrackIndexMap.set(muon.matchMCHTrackId(), offset + counter);
+          fFwdTrackIndexMapReversed.push_back(muon.matchMCHTrackId());
           fFwdTrackFilterMap[muon.matchMCHTrackId()] = trackFilteringTag; // store here the filtering tag so we don't repeat the cuts in the second iteration
         }
       } else {
@@ -1620,7 +1538,7 @@ struct TableMaker {
 
     // Now we have the full index map of selected muons so we can proceed with writing the muon tables
     // Special care needed for the MCH and MFT indices
-    for (const auto& [skimIdx, origIdx] : fFwdTrackIndexMapReversed) {
+    for (const auto& origIdx : fFwdTrackIndexMapReversed) {
       // get the muon
       auto muon = muons.rawIteratorAt(origIdx);
       uint32_t reducedEventIdx = fCollIndexMap[collision.globalIndex()];
@@ -1631,10 +1549,10 @@ struct TableMaker {
       uint32_t mchIdx = -1;
       uint32_t mftIdx = -1;
       if (muon.trackType() == static_cast<uint8_t>(0) || muon.trackType() == static_cast<uint8_t>(2)) { // MCH-MID (2) or global (0)
-        if (fFwdTrackIndexMap.find(muon.matchMCHTrackId()) != fFwdTrackIndexMap.end()) {
+        if (fFwdTrackIndexMap.contains(muon.matchMCHTrackId())) {
           mchIdx = fFwdTrackIndexMap[muon.matchMCHTrackId()];
         }
-        if (fMftIndexMap.find(muon.matchMFTTrackId()) != fMftIndexMap.end()) {
+        if (fMftIndexMap.contains(muon.matchMFTTrackId())) {
           mftIdx = fMftIndexMap[muon.matchMFTTrackId()];
         }
       }
@@ -1767,7 +1685,7 @@ struct TableMaker {
     }
 
     if constexpr (static_cast<bool>(TTrackFillMap)) {
-      fTrackIndexMap.clear();
+      fTrackIndexMap.reset(tracksBarrel.size());
       outTables.trackBarrelInfo.reserve(tracksBarrel.size());
       outTables.trackBasic.reserve(tracksBarrel.size());
       outTables.trackBarrel.reserve(tracksBarrel.size());
@@ -1777,7 +1695,7 @@ struct TableMaker {
     }
 
     if constexpr (static_cast<bool>(TMFTFillMap)) {
-      fMftIndexMap.clear();
+      fMftIndexMap.reset(mftTracks.size());
       map_mfttrackcovs.clear();
       outTables.mftTrack.reserve(mftTracks.size());
       outTables.mftTrackExtra.reserve(mftTracks.size());
@@ -1785,9 +1703,9 @@ struct TableMaker {
     }
 
     if constexpr (static_cast<bool>(TMuonFillMap)) {
-      fFwdTrackIndexMap.clear();
-      fFwdTrackFilterMap.clear();
-      fBestMatch.clear();
+      fFwdTrackIndexMap.reset(muons.size());
+      fFwdTrackFilterMap.assign(muons.size(), 0);
+      fBestMatch.assign(muons.size(), false);
       outTables.muonBasic.reserve(muons.size());
       outTables.muonExtra.reserve(muons.size());
       outTables.muonInfo.reserve(muons.size());
@@ -1802,7 +1720,10 @@ struct TableMaker {
     }
 
     // loop over selected collisions, group the compatible associations, and run the skimming
-    for (auto const& [origIdx, skimIdx] : fCollIndexMap) {
+    for (std::size_t origIdx = 0; origIdx < fCollIndexMap.size(); origIdx++) {
+      if (!fCollIndexMap.contains(origIdx)) {
+        continue;
+      }
       auto collision = collisions.rawIteratorAt(origIdx);
       // group the barrel track associations for this collision
       if constexpr (static_cast<bool>(TTrackFillMap)) {
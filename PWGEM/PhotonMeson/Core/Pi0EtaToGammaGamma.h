@@ -25,12 +25,10 @@
 #include "PWGEM/PhotonMeson/DataModel/EventTables.h"
 #include "PWGEM/PhotonMeson/DataModel/GammaTablesRedux.h"
 #include "PWGEM/PhotonMeson/DataModel/gammaTables.h"
-#include "PWGEM/PhotonMeson/Utils/EMPhoton.h"
 #include "PWGEM/PhotonMeson/Utils/EventHistograms.h"
 #include "PWGEM/PhotonMeson/Utils/NMHistograms.h"
 #include "PWGEM/PhotonMeson/Utils/PairUtilities.h"
-// Dilepton headers
-#include "PWGEM/Dilepton/Utils/EventMixingHandler.h"
+#include "PWGEM/PhotonMeson/Utils/PhotonPairKernel.h"
 
 #include "Common/CCDB/TriggerAliases.h"
 #include "Common/DataModel/Centrality.h"
@@ -66,7 +64,6 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <map>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -284,13 +281,19 @@ struct Pi0EtaToGammaGamma {
   o2::framework::Partition<o2::soa::Filtered<o2::soa::Join<o2::aod::EMPrimaryElectronsFromDalitz, o2::aod::EMPrimaryElectronDaEMEventIds, o2::aod::EMPrimaryElectronsPrefilterBitDerived>>> positrons = o2::aod::emprimaryelectron::sign > int8_t(0) && dileptoncuts.cfg_min_pt_track < o2::aod::track::pt&& nabs(o2::aod::track::eta) < dileptoncuts.cfg_max_eta_track;
   o2::framework::Partition<o2::soa::Filtered<o2::soa::Join<o2::aod::EMPrimaryElectronsFromDalitz, o2::aod::EMPrimaryElectronDaEMEventIds, o2::aod::EMPrimaryElectronsPrefilterBitDerived>>> electrons = o2::aod::emprimaryelectron::sign < int8_t(0) && dileptoncuts.cfg_min_pt_track < o2::aod::track::pt && nabs(o2::aod::track::eta) < dileptoncuts.cfg_max_eta_track;
 
-  o2::aod::pwgem::dilepton::utils::EventMixingHandler<std::tuple<int, int, int, int>, std::pair<int, int>, o2::aod::pwgem::photonmeson::utils::EMPhoton>* emh1 = nullptr;
-  o2::aod::pwgem::dilepton::utils::EventMixingHandler<std::tuple<int, int, int, int>, std::pair<int, int>, o2::aod::pwgem::photonmeson::utils::EMPhoton>* emh2 = nullptr;
   //---------------------------------------------------------------------------
-
-  std::vector<int> used_photonIds_per_col;                   // <ndf, trackId>
-  std::vector<std::pair<int, int>> used_dileptonIds_per_col; // <ndf, trackId>
-  std::map<std::pair<int, int>, uint64_t> map_mixed_eventId_to_globalBC;
+  // photon pairing
+  // same kinds pairing: both photons from the same table, only the first list of photons is used in the mixing
+  static constexpr bool isSameKindPairing = pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMPCM || pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPHOSPHOS || pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC;
+
+  o2::aod::pwgem::photonmeson::utils::pairkernel::SelectedPhotons selected_photons1; // selected photons in this collision
+  o2::aod::pwgem::photonmeson::utils::pairkernel::SelectedPhotons selected_photons2; // selected photons (or dileptons) in this collision, unused in same kinds pairing
+  std::vector<uint8_t> is_in_pool1;                                                  // whether the photon of selected_photons1 was added to mix_photons1
+  std::vector<uint8_t> is_in_pool2;                                                  // whether the photon of selected_photons2 was added to mix_photons2
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonRecords mix_photons1;        // photons of this collision to be mixed, i.e. used in at least one pair
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonRecords mix_photons2;
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PairKinematics pair_kinematics;
+  o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonMixingPool mixing_pool; // ring buffer of the last ndepth collisions per mixing bin
 
   std::vector<float> zvtx_bin_edges;
   std::vector<float> cent_bin_edges;
@@ -421,8 +424,14 @@ struct Pi0EtaToGammaGamma {
     occ_bin_edges = std::vector<float>(ConfOccupancyBins.value.begin(), ConfOccupancyBins.value.end());
     occ_bin_edges.erase(occ_bin_edges.begin());
 
-    emh1 = new o2::aod::pwgem::dilepton::utils::EventMixingHandler<std::tuple<int, int, int, int>, std::pair<int, int>, o2::aod::pwgem::photonmeson::utils::EMPhoton>(ndepth);
-    emh2 = new o2::aod::pwgem::dilepton::utils::EventMixingHandler<std::tuple<int, int, int, int>, std::pair<int, int>, o2::aod::pwgem::photonmeson::utils::EMPhoton>(ndepth);
+    // each mixing axis needs at least one bin, otherwise there is no mixing bin to pool the events in
+    for (const auto& [name, edges] : {std::make_pair("ConfVtxBins", &zvtx_bin_edges), std::make_pair("ConfCentBins", &cent_bin_edges), std::make_pair("ConfEPBins", &ep_bin_edges), std::make_pair("ConfOccupancyBins", &occ_bin_edges)}) {
+      if (edges->size() < 2) {
+        LOG(fatal) << name << " must contain at least two bin edges after VARIABLE_WIDTH, got " << edges->size();
+      }
+    }
+
+    mixing_pool.init(nMixingBins(), ndepth);
 
     o2::aod::pwgem::photonmeson::utils::eventhistogram::addEventHistograms(&fRegistry);
     if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMDalitzEE) {
@@ -495,20 +504,6 @@ struct Pi0EtaToGammaGamma {
     mRunNumber = collision.runNumber();
   }
 
-  ~Pi0EtaToGammaGamma()
-  {
-    delete emh1;
-    emh1 = nullptr;
-    delete emh2;
-    emh2 = nullptr;
-
-    used_photonIds_per_col.clear();
-    used_photonIds_per_col.shrink_to_fit();
-    used_dileptonIds_per_col.clear();
-    used_dileptonIds_per_col.shrink_to_fit();
-    map_mixed_eventId_to_globalBC.clear();
-  }
-
   void DefineEMEventCut()
   {
     fEMEventCut = EMPhotonEventCut("fEMEventCut", "fEMEventCut");
@@ -731,6 +726,106 @@ struct Pi0EtaToGammaGamma {
     }
   }
 
+  /// \brief number of mixing bins, (zvtx, centrality, event plane, occupancy)
+  int nMixingBins() const
+  {
+    return (static_cast<int>(zvtx_bin_edges.size()) - 1) * (static_cast<int>(cent_bin_edges.size()) - 1) * (static_cast<int>(ep_bin_edges.size()) - 1) * (static_cast<int>(occ_bin_edges.size()) - 1);
+  }
+
+  int getMixingBin(int zbin, int centbin, int epbin, int occbin) const
+  {
+    return ((zbin * (static_cast<int>(cent_bin_edges.size()) - 1) + centbin) * (static_cast<int>(ep_bin_edges.size()) - 1) + epbin) * (static_cast<int>(occ_bin_edges.size()) - 1) + occbin;
+  }
+
+  /// \brief max. photon energy asymmetry of a pair
+  /// \param pt pair pT
+  float getAlphaMesonCut(double pt) const
+  {
+    float alphaCut = 999.f;
+    switch (static_cast<AlphaMesonCutOption>(cfgAlphaMesonCut.value)) {
+      case AlphaMesonCutOption::Off:
+        break;
+      case AlphaMesonCutOption::SpecificValue:
+        alphaCut = cfgAlphaMeson;
+        break;
+      case AlphaMesonCutOption::PTDependent: {
+        alphaCut = cfgAlphaMesonA * std::tanh(cfgAlphaMesonB * pt);
+        break;
+      }
+      default:
+        LOGF(error, "Invalid option for alpha meson cut. No alpha cut will be applied.");
+    }
+    return alphaCut;
+  }
+
+  /// \brief select the photons of a collision once, before the pairing
+  /// \tparam TDetectorTag tag for TPhotons type to select the proper cut function and arguments
+  /// \tparam TLegs V0 leg table type (only for PCM)
+  /// \param photons photons of the collision
+  /// \param matchedTracks table of matched global tracks to EMCal clusters (optional)
+  /// \param matchedSecondaries table of matched secondary tracks to EMCal clusters (optional)
+  /// \param selected output flat photon records
+  template <typename TDetectorTag, typename TLegs, typename TPhotons, typename TMatchedTracks, typename TMatchedSecondaries>
+  void selectPhotons(TPhotons const& photons, TMatchedTracks const& matchedTracks, TMatchedSecondaries const& matchedSecondaries, o2::aod::pwgem::photonmeson::utils::pairkernel::SelectedPhotons& selected)
+  {
+    for (const auto& g : photons) {
+      if constexpr (std::is_same_v<TDetectorTag, EMCTag>) {
+        // For the EMCal case we need to get the primary and secondary matched tracks
+        auto matchedTracksPerCluster = matchedTracks.sliceByCached(TDetectorTag::perClusterMT(), g.globalIndex(), cache);
+        auto matchedSecondariesPerCluster = matchedSecondaries.sliceByCached(TDetectorTag::perClusterMS(), g.globalIndex(), cache);
+        if (!TDetectorTag::applyCut(*this, g, matchedTracksPerCluster, matchedSecondariesPerCluster)) {
+          continue;
+        }
+      } else {
+        if (!TDetectorTag::applyCut(*this, g)) {
+          continue;
+        }
+      }
+
+      uint8_t classBits = 0;
+      if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMPCM) {
+        if (cfgDoPhotonClassPairCut.value) {
+          auto pos = g.template posTrack_as<TLegs>();
+          auto neg = g.template negTrack_as<TLegs>();
+          classBits = o2::aod::pwgem::photonmeson::utils::pairkernel::getPhotonClassBits(o2::aod::pwgem::photonmeson::utils::pairutil::getV0PhotonLegCounts(pos, neg), mPhotonClassSelA, mPhotonClassSelB);
+        }
+      }
+
+      float wphoton = 1.f;
+      if constexpr (requires { g.omegaMBWeight(); }) {
+        wphoton = g.omegaMBWeight();
+      }
+
+      selected.add(o2::aod::pwgem::photonmeson::utils::pairkernel::getFourMomentum(g.pt(), g.eta(), g.phi(), 0.), g.e(), wphoton, classBits);
+    }
+  }
+
+  /// \brief fill mixed-event pairs of the photons of this collision with the photons of a collision from the pool
+  void fillMixedPairs(o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonRecords const& photons1, o2::aod::pwgem::photonmeson::utils::pairkernel::PhotonRecords const& photons2, float weight)
+  {
+    for (std::size_t i1 = 0; i1 < photons1.size(); i1++) {
+      o2::aod::pwgem::photonmeson::utils::pairkernel::computePairKinematics(photons1, i1, photons2, 0, photons2.size(), pair_kinematics);
+      for (std::size_t i2 = 0; i2 < photons2.size(); i2++) {
+        if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMPCM) {
+          if (cfgDoPhotonClassPairCut.value && !o2::aod::pwgem::photonmeson::utils::pairkernel::isPairPhotonClassSelected(photons1.classBits[i1], photons2.classBits[i2])) {
+            continue;
+          }
+        }
+        if (std::fabs(pair_kinematics.rapidity[i2]) > maxY) {
+          continue;
+        }
+        if constexpr (isSameKindPairing) {
+          // as photon has mass= 0 e = p
+          float alphaMeson = std::fabs(photons1.e[i1] - photons2.e[i2]) / (photons1.e[i1] + photons2.e[i2]);
+          if (alphaMeson > getAlphaMesonCut(pair_kinematics.pt[i2])) {
+            continue;
+          }
+        }
+        fRegistry.fill(HIST("Pair/mix/hs"), pair_kinematics.mass[i2], pair_kinematics.pt[i2], weight);
+      }
+    }
+  }
+
   /// \brief function to run the photon pairing
   /// \tparam TDetectorTag1 tag for TPhotons1 type to select the proper cut function and arguments
   /// \tparam TDetectorTag2 tag for TPhotons2 type to select the proper cut function and arguments
@@ -819,8 +914,12 @@ struct Pi0EtaToGammaGamma {
 
       // LOGF(info, "collision.globalIndex() = %d, collision.posZ() = %f, centrality = %f, ep2 = %f, collision.trackOccupancyInTimeRange() = %d, zbin = %d, centbin = %d, epbin = %d, occbin = %d", collision.globalIndex(), collision.posZ(), centrality, ep2, collision.trackOccupancyInTimeRange(), zbin, centbin, epbin, occbin);
 
-      std::tuple<int, int, int, int> key_bin = std::make_tuple(zbin, centbin, epbin, occbin);
-      std::pair<int, int64_t> key_df_collision = std::make_pair(ndf, collision.globalIndex());
+      const int mixbin = getMixingBin(zbin, centbin, epbin, occbin);
+
+      selected_photons1.clear();
+      selected_photons2.clear();
+      mix_photons1.clear();
+      mix_photons2.clear();
 
       if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMDalitzEE) {
         auto photons1_per_collision = photons1.sliceByCached(TDetectorTag1::perCollision(), collision.globalIndex(), cache);
@@ -840,310 +939,138 @@ struct Pi0EtaToGammaGamma {
 
           auto pos1 = g1.template posTrack_as<TLegs>();
           auto ele1 = g1.template negTrack_as<TLegs>();
-          ROOT::Math::PtEtaPhiMVector v_gamma(g1.pt(), g1.eta(), g1.phi(), 0.);
+          selected_photons1.add(o2::aod::pwgem::photonmeson::utils::pairkernel::getFourMomentum(g1.pt(), g1.eta(), g1.phi(), 0.), g1.e(), 1.f, 0, pos1.trackId(), ele1.trackId());
+        } // end of g1 loop
 
-          for (const auto& [pos2, ele2] : o2::soa::combinations(TCombinationPolicy(positrons_per_collision, electrons_per_collision))) {
+        // dileptons are selected once and then paired with each photon
+        for (const auto& [pos2, ele2] : o2::soa::combinations(TCombinationPolicy(positrons_per_collision, electrons_per_collision))) {
+          if (pos2.trackId() == ele2.trackId()) { // this is protection against pairing identical 2 tracks.
+            continue;
+          }
 
-            if (pos2.trackId() == ele2.trackId()) { // this is protection against pairing identical 2 tracks.
+          if constexpr (std::is_same_v<TDetectorTag2, DalitzEETag>) {
+            if (!TDetectorTag2::applyCut(*this, pos2, ele2, d_bz)) {
               continue;
             }
-            if (pos1.trackId() == pos2.trackId() || ele1.trackId() == ele2.trackId()) {
+          } else {
+            if (!TDetectorTag1::applyCut(*this, pos2, ele2, d_bz)) {
               continue;
             }
+          }
 
-            if constexpr (std::is_same_v<TDetectorTag2, DalitzEETag>) {
-              if (!TDetectorTag2::applyCut(*this, pos2, ele2, d_bz)) {
-                continue;
-              }
-            } else {
-              if (!TDetectorTag1::applyCut(*this, pos2, ele2, d_bz)) {
-                continue;
-              }
+          auto v_pos = o2::aod::pwgem::photonmeson::utils::pairkernel::getFourMomentum(pos2.pt(), pos2.eta(), pos2.phi(), o2::constants::physics::MassElectron);
+          auto v_ele = o2::aod::pwgem::photonmeson::utils::pairkernel::getFourMomentum(ele2.pt(), ele2.eta(), ele2.phi(), o2::constants::physics::MassElectron);
+          std::array<double, 4> v_ee = {v_pos[0] + v_ele[0], v_pos[1] + v_ele[1], v_pos[2] + v_ele[2], v_pos[3] + v_ele[3]};
+          selected_photons2.add(v_ee, v_ee[0], 1.f, 0, pos2.trackId(), ele2.trackId());
+        } // end of dielectron loop
+
+        is_in_pool1.assign(selected_photons1.size(), 0);
+        is_in_pool2.assign(selected_photons2.size(), 0);
+        for (std::size_t i1 = 0; i1 < selected_photons1.size(); i1++) {
+          o2::aod::pwgem::photonmeson::utils::pairkernel::computePairKinematics(selected_photons1.records, i1, selected_photons2.records, 0, selected_photons2.size(), pair_kinematics);
+          for (std::size_t i2 = 0; i2 < selected_photons2.size(); i2++) {
+            if (selected_photons1.legIds[0][i1] == selected_photons2.legIds[0][i2] || selected_photons1.legIds[1][i1] == selected_photons2.legIds[1][i2]) {
+              continue;
             }
-            // if (!cut2.template IsSelectedTrack<false>(pos2, collision) || !cut2.template IsSelectedTrack<false>(ele2, collision)) {
-            //   continue;
-            // }
-
-            // if (!cut2.IsSelectedPair(pos2, ele2, d_bz)) {
-            //   continue;
-            // }
-
-            ROOT::Math::PtEtaPhiMVector v_pos(pos2.pt(), pos2.eta(), pos2.phi(), o2::constants::physics::MassElectron);
-            ROOT::Math::PtEtaPhiMVector v_ele(ele2.pt(), ele2.eta(), ele2.phi(), o2::constants::physics::MassElectron);
-            ROOT::Math::PtEtaPhiMVector v_ee = v_pos + v_ele;
-            ROOT::Math::PtEtaPhiMVector veeg = v_gamma + v_pos + v_ele;
-            if (std::fabs(veeg.Rapidity()) > maxY) {
+            if (std::fabs(pair_kinematics.rapidity[i2]) > maxY) {
               continue;
             }
 
-            fRegistry.fill(HIST("Pair/same/hs"), veeg.M(), veeg.Pt(), weight);
-
-            std::pair<int, int> tuple_tmp_id2 = std::make_pair(pos2.trackId(), ele2.trackId());
-            if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g1.globalIndex()) == used_photonIds_per_col.end()) {
-              emh1->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::photonmeson::utils::EMPhoton(g1.pt(), g1.eta(), g1.phi(), 0));
-              used_photonIds_per_col.emplace_back(g1.globalIndex());
-            }
-            if (std::find(used_dileptonIds_per_col.begin(), used_dileptonIds_per_col.end(), tuple_tmp_id2) == used_dileptonIds_per_col.end()) {
-              emh2->AddTrackToEventPool(key_df_collision, o2::aod::pwgem::photonmeson::utils::EMPhoton(v_ee.Pt(), v_ee.Eta(), v_ee.Phi(), v_ee.M()));
-              used_dileptonIds_per_col.emplace_back(tuple_tmp_id2);
+            fRegistry.fill(HIST("Pair/same/hs"), pair_kinematics.mass[i2], pair_kinematics.pt[i2], weight);
+            if (cfgDoMix) {
+              if (!is_in_pool1[i1]) {
+                mix_photons1.add(selected_photons1.records, i1);
+                is_in_pool1[i1] = 1;
+              }
+              if (!is_in_pool2[i2]) {
+                mix_photons2.add(selected_photons2.records, i2);
+                is_in_pool2[i2] = 1;
+              }
             }
             ndiphoton++;
-          } // end of dielectron loop
-        } // end of g1 loop
+          }
+        } // end of pairing loop
       } else { // PCM-PCM, EMC-EMC, PHOS-PHOS, PCM-EMC and PCM-PHOS.
         auto photons1_per_collision = photons1.sliceByCached(TDetectorTag1::perCollision(), collision.globalIndex(), cache);
-        auto photons2_per_collision = photons2.sliceByCached(TDetectorTag2::perCollision(), collision.globalIndex(), cache);
-
-        for (const auto& [g1, g2] : o2::soa::combinations(TCombinationPolicy(photons1_per_collision, photons2_per_collision))) {
-          if constexpr (std::is_same_v<TDetectorTag1, EMCTag>) {
-            // For the EMCal case we need to get the primary and secondary matched tracks
-            auto matchedTracks1 = matchedTracks.sliceByCached(TDetectorTag1::perClusterMT(), g1.globalIndex(), cache);
-            auto matchedSecondaries1 = matchedSecondaries.sliceByCached(TDetectorTag1::perClusterMS(), g1.globalIndex(), cache);
-
-            if (!TDetectorTag1::applyCut(*this, g1, matchedTracks1, matchedSecondaries1)) {
-              continue;
+        selectPhotons<TDetectorTag1, TLegs>(photons1_per_collision, matchedTracks, matchedSecondaries, selected_photons1);
+        if constexpr (!isSameKindPairing) {
+          auto photons2_per_collision = photons2.sliceByCached(TDetectorTag2::perCollision(), collision.globalIndex(), cache);
+          selectPhotons<TDetectorTag2, TLegs>(photons2_per_collision, matchedTracks, matchedSecondaries, selected_photons2);
+        }
+
+        // in same kinds pairing, each pair is taken once (strictly upper index) and a photon is added to the pool only once
+        auto const& photons2_selected = isSameKindPairing ? selected_photons1 : selected_photons2;
+        is_in_pool1.assign(selected_photons1.size(), 0);
+        is_in_pool2.assign(selected_photons2.size(), 0);
+        auto& is_in_pool2_selected = isSameKindPairing ? is_in_pool1 : is_in_pool2;
+
+        for (std::size_t i1 = 0; i1 < selected_photons1.size(); i1++) {
+          const std::size_t first2 = isSameKindPairing ? i1 + 1 : 0;
+          o2::aod::pwgem::photonmeson::utils::pairkernel::computePairKinematics(selected_photons1.records, i1, photons2_selected.records, first2, photons2_selected.size(), pair_kinematics);
+          for (std::size_t i2 = first2; i2 < photons2_selected.size(); i2++) {
+            const std::size_t ipair = i2 - first2;
+            if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMPCM) {
+              if (cfgDoPhotonClassPairCut.value &&
+                  !o2::aod::pwgem::photonmeson::utils::pairkernel::isPairPhotonClassSelected(selected_photons1.records.classBits[i1], photons2_selected.records.classBits[i2])) {
+                continue;
+              }
             }
-          } else {
-            if (!TDetectorTag1::applyCut(*this, g1) || !TDetectorTag2::applyCut(*this, g2)) {
+            if (std::fabs(pair_kinematics.rapidity[ipair]) > maxY) {
               continue;
             }
-          }
 
-          if constexpr (std::is_same_v<TDetectorTag2, EMCTag>) {
-            auto matchedTracks2 = matchedTracks.sliceByCached(TDetectorTag2::perClusterMT(), g2.globalIndex(), cache);
-            auto matchedSecondaries2 = matchedSecondaries.sliceByCached(TDetectorTag2::perClusterMS(), g2.globalIndex(), cache);
-            if (!TDetectorTag2::applyCut(*this, g2, matchedTracks2, matchedSecondaries2)) {
+            const float e1 = selected_photons1.energies[i1];
+            const float e2 = photons2_selected.energies[i2];
+            float alphaMeson = std::fabs(e1 - e2) / (e1 + e2);
+            if (alphaMeson > getAlphaMesonCut(pair_kinematics.pt[ipair])) {
               continue;
             }
-          } else {
-            if (!TDetectorTag2::applyCut(*this, g2)) {
-              continue;
-            }
-          }
 
-          o2::aod::pwgem::photonmeson::utils::pairutil::V0PhotonLegCounts legCounts1{}, legCounts2{};
-          if constexpr (std::is_same_v<TDetectorTag1, PCMTag> && std::is_same_v<TDetectorTag2, PCMTag>) {
-            auto pos1 = g1.template posTrack_as<TLegs>();
-            auto neg1 = g1.template negTrack_as<TLegs>();
-            auto pos2 = g2.template posTrack_as<TLegs>();
-            auto neg2 = g2.template negTrack_as<TLegs>();
-            legCounts1 = o2::aod::pwgem::photonmeson::utils::pairutil::getV0PhotonLegCounts(pos1, neg1);
-            legCounts2 = o2::aod::pwgem::photonmeson::utils::pairutil::getV0PhotonLegCounts(pos2, neg2);
-            if (cfgDoPhotonClassPairCut.value &&
-                !o2::aod::pwgem::photonmeson::utils::pairutil::isPairPhotonClassSelected(legCounts1, legCounts2, mPhotonClassSelA, mPhotonClassSelB)) {
-              continue;
-            }
-          }
+            float wpair = weight * selected_photons1.weights[i1] * photons2_selected.weights[i2];
+            fRegistry.fill(HIST("Pair/same/hs"), pair_kinematics.mass[ipair], pair_kinematics.pt[ipair], wpair);
 
-          ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-          ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-          ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-          if (std::fabs(v12.Rapidity()) > maxY) {
-            continue;
-          }
-
-          float alphaMeson = std::fabs(g1.e() - g2.e()) / (g1.e() + g2.e());
-          float alphaCut = 999.f;
-          switch (static_cast<AlphaMesonCutOption>(cfgAlphaMesonCut.value)) {
-            case AlphaMesonCutOption::Off:
-              break;
-            case AlphaMesonCutOption::SpecificValue:
-              alphaCut = cfgAlphaMeson;
-              break;
-            case AlphaMesonCutOption::PTDependent: {
-              alphaCut = cfgAlphaMesonA * std::tanh(cfgAlphaMesonB * v12.pt());
-              break;
-            }
-            default:
-              LOGF(error, "Invalid option for alpha meson cut. No alpha cut will be applied.");
-          }
-          if (alphaMeson > alphaCut) {
-            continue;
-          }
-
-          float wpair = weight;
-
-          if constexpr (requires { g1.omegaMBWeight(); }) {
-            wpair *= g1.omegaMBWeight();
-          }
-          if constexpr (requires { g2.omegaMBWeight(); }) {
-            wpair *= g2.omegaMBWeight();
-          }
-
-          fRegistry.fill(HIST("Pair/same/hs"), v12.M(), v12.Pt(), wpair);
-
-          if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g1.globalIndex()) == used_photonIds_per_col.end()) {
-            auto emphoton1 = o2::aod::pwgem::photonmeson::utils::EMPhoton(g1.pt(), g1.eta(), g1.phi(), 0);
-            if constexpr (std::is_same_v<TDetectorTag1, PCMTag> && std::is_same_v<TDetectorTag2, PCMTag>) {
-              emphoton1.setLegCounts(legCounts1);
-            }
-            emh1->AddTrackToEventPool(key_df_collision, emphoton1);
-            used_photonIds_per_col.emplace_back(g1.globalIndex());
-          }
-          if (std::find(used_photonIds_per_col.begin(), used_photonIds_per_col.end(), g2.globalIndex()) == used_photonIds_per_col.end()) {
-            auto emphoton2 = o2::aod::pwgem::photonmeson::utils::EMPhoton(g2.pt(), g2.eta(), g2.phi(), 0);
-            if constexpr (std::is_same_v<TDetectorTag1, PCMTag> && std::is_same_v<TDetectorTag2, PCMTag>) {
-              emphoton2.setLegCounts(legCounts1);
+            if (cfgDoMix) {
+              if (!is_in_pool1[i1]) {
+                mix_photons1.add(selected_photons1.records, i1);
+                is_in_pool1[i1] = 1;
+              }
+              if (!is_in_pool2_selected[i2]) {
+                if constexpr (!isSameKindPairing) {
+                  mix_photons2.add(photons2_selected.records, i2);
+                }
+                is_in_pool2_selected[i2] = 1;
+              }
             }
-            emh2->AddTrackToEventPool(key_df_collision, emphoton2);
-            used_photonIds_per_col.emplace_back(g2.globalIndex());
+            ndiphoton++;
           }
-          ndiphoton++;
         } // end of pairing loop
       } // end of pairing in same event
 
-      used_photonIds_per_col.clear();
-      used_photonIds_per_col.shrink_to_fit();
-      used_dileptonIds_per_col.clear();
-      used_dileptonIds_per_col.shrink_to_fit();
-
       // event mixing
       if (!cfgDoMix || !(ndiphoton > 0)) {
         continue;
       }
 
-      // make a vector of selected photons in this collision.
-      auto selected_photons1_in_this_event = emh1->GetTracksPerCollision(key_df_collision);
-      auto selected_photons2_in_this_event = emh2->GetTracksPerCollision(key_df_collision);
-
-      auto collisionIds1_in_mixing_pool = emh1->GetCollisionIdsFromEventPool(key_bin);
-      auto collisionIds2_in_mixing_pool = emh2->GetCollisionIdsFromEventPool(key_bin);
-
-      if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMPCM || pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPHOSPHOS || pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kEMCEMC) { // same kinds pairing
-        for (const auto& mix_dfId_collisionId : collisionIds1_in_mixing_pool) {
-          int mix_dfId = mix_dfId_collisionId.first;
-          int64_t mix_collisionId = mix_dfId_collisionId.second;
-
-          if (collision.globalIndex() == mix_collisionId && ndf == mix_dfId) { // this never happens. only protection.
-            continue;
-          }
-
-          auto globalBC_mix = map_mixed_eventId_to_globalBC[mix_dfId_collisionId];
-          uint64_t diffBC = std::max(collision.globalBC(), globalBC_mix) - std::min(collision.globalBC(), globalBC_mix);
-          fRegistry.fill(HIST("Pair/mix/hDiffBC"), diffBC);
-          if (diffBC < ndiff_bc_mix) {
-            continue;
-          }
-
-          auto photons1_from_event_pool = emh1->GetTracksPerCollision(mix_dfId_collisionId);
-          // LOGF(info, "Do event mixing: current event (%d, %d), ngamma = %d | event pool (%d, %d), ngamma = %d", ndf, collision.globalIndex(), selected_photons1_in_this_event.size(), mix_dfId, mix_collisionId, photons1_from_event_pool.size());
-
-          for (const auto& g1 : selected_photons1_in_this_event) {
-            for (const auto& g2 : photons1_from_event_pool) {
-              if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMPCM) {
-                if (cfgDoPhotonClassPairCut.value) {
-                  if (!g1.hasLegCounts() || !g2.hasLegCounts() ||
-                      !o2::aod::pwgem::photonmeson::utils::pairutil::isPairPhotonClassSelected(g1.legCounts(), g2.legCounts(), mPhotonClassSelA, mPhotonClassSelB)) {
-                    continue;
-                  }
-                }
-              }
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (std::fabs(v12.Rapidity()) > maxY) {
-                continue;
-              }
-              // as photon has mass= 0 e = p
-              float alphaMeson = std::fabs(g1.p() - g2.p()) / (g1.p() + g2.p());
-              float alphaCut = 999.f;
-              switch (static_cast<AlphaMesonCutOption>(cfgAlphaMesonCut.value)) {
-                case AlphaMesonCutOption::Off:
-                  break;
-                case AlphaMesonCutOption::SpecificValue:
-                  alphaCut = cfgAlphaMeson;
-                  break;
-                case AlphaMesonCutOption::PTDependent: {
-                  alphaCut = cfgAlphaMesonA * std::tanh(cfgAlphaMesonB * v12.pt());
-                  break;
-                }
-                default:
-                  LOGF(error, "Invalid option for alpha meson cut. No alpha cut will be applied.");
-              }
-              if (alphaMeson > alphaCut) {
-                continue;
-              }
-
-              fRegistry.fill(HIST("Pair/mix/hs"), v12.M(), v12.Pt(), weight);
-            }
-          }
-        } // end of loop over mixed event pool
-
-      } else { // [photon1 from event1, photon2 from event2] and [photon1 from event2, photon2 from event1]
-        for (const auto& mix_dfId_collisionId : collisionIds2_in_mixing_pool) {
-          int mix_dfId = mix_dfId_collisionId.first;
-          int64_t mix_collisionId = mix_dfId_collisionId.second;
-
-          if (collision.globalIndex() == mix_collisionId && ndf == mix_dfId) { // this never happens. only protection.
-            continue;
-          }
-
-          auto globalBC_mix = map_mixed_eventId_to_globalBC[mix_dfId_collisionId];
-          uint64_t diffBC = std::max(collision.globalBC(), globalBC_mix) - std::min(collision.globalBC(), globalBC_mix);
-          fRegistry.fill(HIST("Pair/mix/hDiffBC"), diffBC);
-          if (diffBC < ndiff_bc_mix) {
-            continue;
-          }
-
-          auto photons2_from_event_pool = emh2->GetTracksPerCollision(mix_dfId_collisionId);
-          // LOGF(info, "Do event mixing: current event (%d, %d), ngamma = %d | event pool (%d, %d), nll = %d", ndf, collision.globalIndex(), selected_photons1_in_this_event.size(), mix_dfId, mix_collisionId, photons2_from_event_pool.size());
-
-          for (const auto& g1 : selected_photons1_in_this_event) {
-            for (const auto& g2 : photons2_from_event_pool) {
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMDalitzEE) { //[photon from event1, dilepton from event2] and [photon from event2, dilepton from event1]
-                v2.SetM(g2.mass());
-              }
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (std::fabs(v12.Rapidity()) > maxY) {
-                continue;
-              }
-              fRegistry.fill(HIST("Pair/mix/hs"), v12.M(), v12.Pt(), weight);
-            }
-          }
-        } // end of loop over mixed event pool
-        for (const auto& mix_dfId_collisionId : collisionIds1_in_mixing_pool) {
-          int mix_dfId = mix_dfId_collisionId.first;
-          int64_t mix_collisionId = mix_dfId_collisionId.second;
-
-          if (collision.globalIndex() == mix_collisionId && ndf == mix_dfId) { // this never happens. only protection.
-            continue;
-          }
-
-          auto globalBC_mix = map_mixed_eventId_to_globalBC[mix_dfId_collisionId];
-          uint64_t diffBC = std::max(collision.globalBC(), globalBC_mix) - std::min(collision.globalBC(), globalBC_mix);
-          fRegistry.fill(HIST("Pair/mix/hDiffBC"), diffBC);
-          if (diffBC < ndiff_bc_mix) {
-            continue;
-          }
-
-          auto photons1_from_event_pool = emh1->GetTracksPerCollision(mix_dfId_collisionId);
-          // LOGF(info, "Do event mixing: current event (%d, %d), nll = %d | event pool (%d, %d), ngamma = %d", ndf, collision.globalIndex(), selected_photons2_in_this_event.size(), mix_dfId, mix_collisionId, photons1_from_event_pool.size());
-
-          for (const auto& g1 : selected_photons2_in_this_event) {
-            for (const auto& g2 : photons1_from_event_pool) {
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              if constexpr (pairtype == o2::aod::pwgem::photonmeson::photonpair::PairType::kPCMDalitzEE) { //[photon from event1, dilepton from event2] and [photon from event2, dilepton from event1]
-                v1.SetM(g1.mass());
-              }
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (std::fabs(v12.Rapidity()) > maxY) {
-                continue;
-              }
-              fRegistry.fill(HIST("Pair/mix/hs"), v12.M(), v12.Pt(), weight);
-            }
-          }
-        } // end of loop over mixed event pool
-      }
-
-      if (ndiphoton > 0) {
-        emh1->AddCollisionIdAtLast(key_bin, key_df_collision);
-        emh2->AddCollisionIdAtLast(key_bin, key_df_collision);
-        map_mixed_eventId_to_globalBC[key_df_collision] = collision.globalBC();
-      }
-
+      for (int imix = 0; imix < mixing_pool.nEvents(mixbin); imix++) {
+        auto const& mixed_event = mixing_pool.getEvent(mixbin, imix);
+        uint64_t diffBC = std::max(collision.globalBC(), mixed_event.globalBC) - std::min(collision.globalBC(), mixed_event.globalBC);
+        fRegistry.fill(HIST("Pair/mix/hDiffBC"), diffBC);
+        if constexpr (!isSameKindPairing) {
+          fRegistry.fill(HIST("Pair/mix/hDiffBC"), diffBC); // once per combination of photon lists
+        }
+        if (diffBC < ndiff_bc_mix) {
+          continue;
+        }
+
+        if constexpr (isSameKindPairing) {
+          fillMixedPairs(mix_photons1, mixed_event.photons1, weight);
+        } else { // [photon1 from event1, photon2 from event2] and [photon1 from event2, photon2 from event1]
+          fillMixedPairs(mix_photons1, mixed_event.photons2, weight);
+          fillMixedPairs(mix_photons2, mixed_event.photons1, weight);
+        }
+      } // end of loop over mixed event pool
+
+      mixing_pool.addEvent(mixbin, collision.globalBC(), mix_photons1, mix_photons2);
     } // end of collision loop
   }
 
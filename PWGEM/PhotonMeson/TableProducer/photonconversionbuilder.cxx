@@ -69,7 +69,6 @@
 #include <array>
 #include <cmath>
 #include <cstdint>
-#include <map>
 #include <set>
 #include <string>
 #include <tuple>
@@ -903,9 +902,6 @@ struct PhotonConversionBuilder {
     if (!checkAP(v0photoncandidate.getAlpha(), v0photoncandidate.getQt(), max_alpha_ap, max_qt_ap)) { // store only photon conversions
       return;
     }
-    pca_map[std::make_tuple(v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex())] = v0photoncandidate.getPCA();
-    cospa_map[std::make_tuple(v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex())] = v0photoncandidate.getCosPA();
-
     const auto score = getScoreV0(v0photoncandidate.getCosPA(), v0photoncandidate.getPCA(), deduplicationScoreWeight);
     V0CandidateHelper v0Helper(v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex(), v0photoncandidate.getCosPA(), v0photoncandidate.getPCA(), score);
     vecV0Dedup.emplace_back(v0Helper);
@@ -1005,13 +1001,23 @@ struct PhotonConversionBuilder {
   }
 
   Preslice<aod::V0s> perCollision = o2::aod::v0::collisionId;
-  std::map<std::tuple<int64_t, int64_t, int64_t, int64_t>, float> pca_map;      // (v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex()) -> pca
-  std::map<std::tuple<int64_t, int64_t, int64_t, int64_t>, float> cospa_map;    // (v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex()) -> cospa
   std::vector<V0CandidateHelper> vecV0Dedup;                                    // vector with all V0Candidates that is used to sort them by score (see struct V0CandidateHelper for more details of content)
-  std::vector<std::pair<int64_t, int64_t>> stored_v0Ids;                        // (pos.globalIndex(), ele.globalIndex())
+  std::vector<std::pair<int, int>> v0DedupByPos;                                // (pos.globalIndex(), index in vecV0Dedup) sorted, for pairwise deduplication
+  std::vector<std::pair<int, int>> v0DedupByEle;                                // (ele.globalIndex(), index in vecV0Dedup) sorted, for pairwise deduplication
+  std::unordered_set<uint64_t> stored_v0Ids;                                    // (pos.globalIndex(), ele.globalIndex()) packed by legPairKey
   std::vector<std::tuple<int64_t, int64_t, int64_t, int64_t>> stored_fullv0Ids; // (v0.globalIndex(), collision.globalIndex(), pos.globalIndex(), ele.globalIndex())
   std::unordered_map<int64_t, int> nv0_map;                                     // map collisionId -> nv0
 
+  static uint64_t legPairKey(int posId, int eleId)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(posId)) << 32) | static_cast<uint32_t>(eleId);
+  }
+
+  static bool hasSameKey(const V0CandidateHelper& a, const V0CandidateHelper& b)
+  {
+    return a.v0ID == b.v0ID && a.colID == b.colID && a.posID == b.posID && a.eleID == b.eleID;
+  }
+
   template <bool isMC, bool isTriggerAnalysis, bool enableFilter, typename TCollisions, typename TV0s, typename TTracks, typename TBCs>
   void build(TCollisions const& collisions, TV0s const& v0s, TTracks const& tracks, TBCs const&)
   {
@@ -1049,61 +1055,71 @@ struct PhotonConversionBuilder {
       } // end of v0 loop
     } // end of collision loop
 
-    stored_v0Ids.reserve(pca_map.size());     // number of photon candidates per DF
-    stored_fullv0Ids.reserve(pca_map.size()); // number of photon candidates per DF
+    stored_v0Ids.reserve(vecV0Dedup.size());     // number of photon candidates per DF
+    stored_fullv0Ids.reserve(vecV0Dedup.size()); // number of photon candidates per DF
 
     // find minimal pca
     if (deduplicationMode == V0DeduplicationMode::Pairwise) {
-      for (const auto& [key, value] : pca_map) {
-        auto v0Id = std::get<0>(key);
-        auto collisionId = std::get<1>(key);
-        auto posId = std::get<2>(key);
-        auto eleId = std::get<3>(key);
-        float v0pca = value;
-        float cospa = cospa_map[key];
+      // candidates ordered by (v0, collision, pos, ele); a candidate can only be rejected by another one sharing a leg
+      std::stable_sort(vecV0Dedup.begin(), vecV0Dedup.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.v0ID, a.colID, a.posID, a.eleID) < std::tie(b.v0ID, b.colID, b.posID, b.eleID);
+      });
+      // keep only the last candidate filled with the same key
+      size_t nUnique = 0;
+      for (size_t iCand = 0; iCand < vecV0Dedup.size(); iCand++) {
+        if (iCand + 1 < vecV0Dedup.size() && hasSameKey(vecV0Dedup[iCand], vecV0Dedup[iCand + 1])) {
+          continue;
+        }
+        vecV0Dedup[nUnique++] = vecV0Dedup[iCand];
+      }
+      vecV0Dedup.resize(nUnique);
+
+      v0DedupByPos.clear();
+      v0DedupByEle.clear();
+      for (int iCand = 0; iCand < static_cast<int>(vecV0Dedup.size()); iCand++) {
+        v0DedupByPos.emplace_back(vecV0Dedup[iCand].posID, iCand);
+        v0DedupByEle.emplace_back(vecV0Dedup[iCand].eleID, iCand);
+      }
+      std::sort(v0DedupByPos.begin(), v0DedupByPos.end());
+      std::sort(v0DedupByEle.begin(), v0DedupByEle.end());
+
+      for (const auto& cand : vecV0Dedup) {
         bool is_closest_v0 = true;
         bool is_most_aligned_v0 = true;
 
-        for (const auto& [key_tmp, value_tmp] : pca_map) {
-          auto v0Id_tmp = std::get<0>(key_tmp);
-          auto collisionId_tmp = std::get<1>(key_tmp);
-          auto posId_tmp = std::get<2>(key_tmp);
-          auto eleId_tmp = std::get<3>(key_tmp);
-          float v0pca_tmp = value_tmp;
-          float cospa_tmp = cospa_map[key_tmp];
-
-          if (v0Id == v0Id_tmp) { // skip exactly the same v0
+        for (auto it = std::lower_bound(v0DedupByPos.begin(), v0DedupByPos.end(), std::make_pair(cand.posID, 0)); it != v0DedupByPos.end() && it->first == cand.posID; ++it) {
+          const auto& cand_tmp = vecV0Dedup[it->second];
+          if (cand.v0ID == cand_tmp.v0ID) { // skip exactly the same v0
             continue;
           }
-
-          if (collisionId != collisionId_tmp && eleId == eleId_tmp && posId == posId_tmp && cospa < cospa_tmp) { // same ele and pos, but attached to different collision
-            // LOGF(info, "!reject! | collision id = %d | posid1 = %d , eleid1 = %d , posid2 = %d , eleid2 = %d , cospa1 = %f , cospa2 = %f", collisionId, posId, eleId, posId_tmp, eleId_tmp, cospa, cospa_tmp);
+          if (cand.colID != cand_tmp.colID && cand.eleID == cand_tmp.eleID && cand.cosPA < cand_tmp.cosPA) { // same ele and pos, but attached to different collision
             is_most_aligned_v0 = false;
             break;
           }
-
-          if ((eleId == eleId_tmp || posId == posId_tmp) && v0pca > v0pca_tmp) {
-            // LOGF(info, "!reject! | collision id = %d | posid1 = %d , eleid1 = %d , posid2 = %d , eleid2 = %d , pca1 = %f , pca2 = %f", collisionId, posId, eleId, posId_tmp, eleId_tmp, v0pca, v0pca_tmp);
+          if (cand.pca > cand_tmp.pca) {
             is_closest_v0 = false;
             break;
           }
-        } // end of pca_map tmp loop
-
-        bool is_stored = std::find(stored_v0Ids.begin(), stored_v0Ids.end(), std::make_pair(posId, eleId)) != stored_v0Ids.end();
-        if (is_closest_v0 && is_most_aligned_v0 && !is_stored) {
-          // auto v0 = v0s.rawIteratorAt(v0Id);
-          // auto collision = collisions.rawIteratorAt(collisionId);
-          // auto pos = tracks.rawIteratorAt(posId);
-          // auto ele = tracks.rawIteratorAt(eleId);
-          // LOGF(info, "!accept! | collision id = %d | v0id1 = %d , posid1 = %d , eleid1 = %d , pca1 = %f , cospa = %f", collisionId, v0Id, posId, eleId, v0pca, cospa);
-
-          // fillV0Table<isMC, TCollisions, TTracks>(v0, true);
-          stored_v0Ids.emplace_back(std::make_pair(posId, eleId));
-          stored_fullv0Ids.emplace_back(std::make_tuple(v0Id, collisionId, posId, eleId));
-          nv0_map[collisionId]++;
+        } // end of candidates sharing pos
+
+        if (is_closest_v0 && is_most_aligned_v0) {
+          for (auto it = std::lower_bound(v0DedupByEle.begin(), v0DedupByEle.end(), std::make_pair(cand.eleID, 0)); it != v0DedupByEle.end() && it->first == cand.eleID; ++it) {
+            const auto& cand_tmp = vecV0Dedup[it->second];
+            if (cand.v0ID == cand_tmp.v0ID || cand.posID == cand_tmp.posID) { // same v0, or already compared above
+              continue;
+            }
+            if (cand.pca > cand_tmp.pca) {
+              is_closest_v0 = false;
+              break;
+            }
+          } // end of candidates sharing ele
+        }
+
+        if (is_closest_v0 && is_most_aligned_v0 && stored_v0Ids.insert(legPairKey(cand.posID, cand.eleID)).second) {
+          stored_fullv0Ids.emplace_back(std::make_tuple(cand.v0ID, cand.colID, cand.posID, cand.eleID));
+          nv0_map[cand.colID]++;
         }
-      } // end of pca_map loop
-      // LOGF(info, "pca_map.size() = %d", pca_map.size());
+      } // end of candidate loop
     } else {
       // Sort best candidates first, depending on score
       std::sort(vecV0Dedup.begin(), vecV0Dedup.end());
@@ -1127,7 +1143,7 @@ struct PhotonConversionBuilder {
         usedLegs[v0Cand.posID] = true;
         usedLegs[v0Cand.eleID] = true;
 
-        stored_v0Ids.emplace_back(v0Cand.posID, v0Cand.eleID);
+        stored_v0Ids.insert(legPairKey(v0Cand.posID, v0Cand.eleID));
 
         stored_fullv0Ids.emplace_back(
           v0Cand.v0ID,
@@ -1175,11 +1191,8 @@ struct PhotonConversionBuilder {
     //   // events_ngpcm(nv0_map[collision.globalIndex()]);
     // } // end of collision loop
 
-    pca_map.clear();
-    cospa_map.clear();
     nv0_map.clear();
     stored_v0Ids.clear();
-    stored_v0Ids.shrink_to_fit();
     stored_fullv0Ids.clear();
     stored_fullv0Ids.shrink_to_fit();
     vecV0Dedup.clear();
@@ -0,0 +1,233 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PhotonPairKernel.h
+/// \brief Flat photon records, pair kinematics kernel and ring-buffer mixing pools for the photon pairing.
+
+#ifndef PWGEM_PHOTONMESON_UTILS_PHOTONPAIRKERNEL_H_
+#define PWGEM_PHOTONMESON_UTILS_PHOTONPAIRKERNEL_H_
+
+#include "PWGEM/PhotonMeson/Utils/PairUtilities.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::aod::pwgem::photonmeson::utils::pairkernel
+{
+enum PhotonClassBit : uint8_t {
+  kClassA = 1 << 0, // photon passes the photon-class A selection
+  kClassB = 1 << 1, // photon passes the photon-class B selection
+};
+
+/// photon-class bits from the leg track composition
+inline uint8_t getPhotonClassBits(o2::aod::pwgem::photonmeson::utils::pairutil::V0PhotonLegCounts const& c,
+                                  o2::aod::pwgem::photonmeson::utils::pairutil::V0PhotonClassSelection const& selA,
+                                  o2::aod::pwgem::photonmeson::utils::pairutil::V0PhotonClassSelection const& selB)
+{
+  return (selA.isSelected(c) ? kClassA : 0) | (selB.isSelected(c) ? kClassB : 0);
+}
+
+/// same as pairutil::isPairPhotonClassSelected, from the precomputed class bits
+inline bool isPairPhotonClassSelected(uint8_t bits1, uint8_t bits2)
+{
+  return ((bits1 & kClassA) && (bits2 & kClassB)) || ((bits2 & kClassA) && (bits1 & kClassB));
+}
+
+/// four-momentum (E, px, py, pz) from pt, eta, phi and mass
+inline std::array<double, 4> getFourMomentum(double pt, double eta, double phi, double mass)
+{
+  const double px = pt * std::cos(phi);
+  const double py = pt * std::sin(phi);
+  const double pz = pt * std::sinh(eta);
+  return {std::sqrt(px * px + py * py + pz * pz + mass * mass), px, py, pz};
+}
+
+/// photons (or dileptons) of one event as flat arrays
+struct PhotonRecords {
+  std::vector<double> e;
+  std::vector<double> px;
+  std::vector<double> py;
+  std::vector<double> pz;
+  std::vector<uint8_t> classBits; // PhotonClassBit
+
+  void clear()
+  {
+    e.clear();
+    px.clear();
+    py.clear();
+    pz.clear();
+    classBits.clear();
+  }
+
+  std::size_t size() const { return e.size(); }
+  bool empty() const { return e.empty(); }
+
+  void add(std::array<double, 4> const& p4, uint8_t bits = 0)
+  {
+    e.push_back(p4[0]);
+    px.push_back(p4[1]);
+    py.push_back(p4[2]);
+    pz.push_back(p4[3]);
+    classBits.push_back(bits);
+  }
+
+  void add(PhotonRecords const& other, std::size_t i)
+  {
+    e.push_back(other.e[i]);
+    px.push_back(other.px[i]);
+    py.push_back(other.py[i]);
+    pz.push_back(other.pz[i]);
+    classBits.push_back(other.classBits[i]);
+  }
+
+  void swap(PhotonRecords& other)
+  {
+    e.swap(other.e);
+    px.swap(other.px);
+    py.swap(other.py);
+    pz.swap(other.pz);
+    classBits.swap(other.classBits);
+  }
+};
+
+/// selected photons of the current event, with what is only needed for the same-event pairs
+struct SelectedPhotons {
+  PhotonRecords records;
+  std::vector<float> energies;            // energies as stored in the table, for the energy asymmetry
+  std::vector<float> weights;             // photon weights, 1 if the table has none
+  std::array<std::vector<int>, 2> legIds; // track ids of the positive and negative legs, -1 if not applicable
+
+  void clear()
+  {
+    records.clear();
+    energies.clear();
+    weights.clear();
+    legIds[0].clear();
+    legIds[1].clear();
+  }
+
+  std::size_t size() const { return records.size(); }
+
+  void add(std::array<double, 4> const& p4, float energy, float weight, uint8_t classBits = 0, int posLegId = -1, int negLegId = -1)
+  {
+    records.add(p4, classBits);
+    energies.push_back(energy);
+    weights.push_back(weight);
+    legIds[0].push_back(posLegId);
+    legIds[1].push_back(negLegId);
+  }
+};
+
+/// kinematics of the pairs of one photon with a range of photons
+struct PairKinematics {
+  std::vector<double> mass;
+  std::vector<double> pt;
+  std::vector<double> rapidity;
+};
+
+/// Computes the invariant mass, pT and rapidity of the pairs of photon i1 of records1 with photons [begin, end) of records2.
+/// Results are stored at [0, end - begin) of out.
+inline void computePairKinematics(PhotonRecords const& records1, std::size_t i1, PhotonRecords const& records2, std::size_t begin, std::size_t end, PairKinematics& out)
+{
+  const std::size_t n = end > begin ? end - begin : 0;
+  out.mass.resize(n);
+  out.pt.resize(n);
+  out.rapidity.resize(n);
+
+  const double e1 = records1.e[i1];
+  const double px1 = records1.px[i1];
+  const double py1 = records1.py[i1];
+  const double pz1 = records1.pz[i1];
+  const double* e2 = records2.e.data() + begin;
+  const double* px2 = records2.px.data() + begin;
+  const double* py2 = records2.py.data() + begin;
+  const double* pz2 = records2.pz.data() + begin;
+  double* mass = out.mass.data();
+  double* pt = out.pt.data();
+  double* rapidity = out.rapidity.data();
+
+  for (std::size_t j = 0; j < n; j++) {
+    const double e = e1 + e2[j];
+    const double px = px1 + px2[j];
+    const double py = py1 + py2[j];
+    const double pz = pz1 + pz2[j];
+    const double pt2 = px * px + py * py;
+    const double m2 = e * e - pt2 - pz * pz;
+    mass[j] = m2 >= 0. ? std::sqrt(m2) : -std::sqrt(-m2); // same convention as ROOT::Math::LorentzVector::M()
+    pt[j] = std::sqrt(pt2);
+    rapidity[j] = 0.5 * std::log((e + pz) / (e - pz));
+  }
+}
+
+/// Event pools for the mixing, one ring buffer of the last ndepth events per mixing bin.
+class PhotonMixingPool
+{
+ public:
+  struct Event {
+    uint64_t globalBC{0};
+    PhotonRecords photons1;
+    PhotonRecords photons2;
+  };
+
+  void init(int nBins, int depth)
+  {
+    mRings.clear();
+    mRings.resize(std::max(nBins, 0));
+    mDepth = std::max(depth, 1);
+  }
+
+  int nEvents(int bin) const { return mRings[bin].size; }
+
+  /// i-th event of the bin, from the oldest to the newest
+  Event const& getEvent(int bin, int i) const
+  {
+    auto const& ring = mRings[bin];
+    return ring.events[(ring.first + i) % ring.events.size()];
+  }
+
+  /// Adds an event at the end of the bin, replacing the oldest one when the pool is full.
+  /// The photons are swapped in, such that the buffers of the replaced event are reused by the caller.
+  void addEvent(int bin, uint64_t globalBC, PhotonRecords& photons1, PhotonRecords& photons2)
+  {
+    auto& ring = mRings[bin];
+    Event* event = nullptr;
+    if (ring.size < mDepth) {
+      ring.events.emplace_back();
+      event = &ring.events.back();
+      ring.size++;
+    } else {
+      event = &ring.events[ring.first];
+      ring.first = (ring.first + 1) % mDepth;
+    }
+    event->globalBC = globalBC;
+    event->photons1.swap(photons1);
+    event->photons2.swap(photons2);
+    photons1.clear();
+    photons2.clear();
+  }
+
+ private:
+  struct Ring {
+    std::vector<Event> events;
+    int first{0}; // position of the oldest event
+    int size{0};
+  };
+
+  std::vector<Ring> mRings;
+  int mDepth{1};
+};
+} // namespace o2::aod::pwgem::photonmeson::utils::pairkernel
+
+#endif // PWGEM_PHOTONMESON_UTILS_PHOTONPAIRKERNEL_H_
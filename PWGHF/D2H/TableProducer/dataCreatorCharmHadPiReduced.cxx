@@ -23,6 +23,7 @@
 #include "PWGHF/Core/HfHelper.h"
 #include "PWGHF/Core/SelectorCuts.h"
 #include "PWGHF/D2H/DataModel/ReducedDataModel.h"
+#include "PWGHF/D2H/Utils/utilsBachelorTracks.h"
 #include "PWGHF/D2H/Utils/utilsRedDataFormat.h"
 #include "PWGHF/DataModel/AliasTables.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
@@ -74,7 +75,6 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
-#include <map>
 #include <memory>
 #include <numeric>
 #include <stdexcept>
@@ -413,14 +413,13 @@ struct HfDataCreatorCharmHadPiReduced {
     }
   }
 
-  /// Pion selection (D Pi <-- B0)
+  /// Pion preselection (D Pi <-- B0), independent of the charm-hadron candidate
   /// \param trackPion is a track with the pion hypothesis
   /// \param trackParCovPion is the track parametrisation of the pion
   /// \param dcaPion is the 2-D array with track DCAs of the pion
-  /// \param charmDautracks charm-hadron daughter tracks
   /// \return true if trackPion passes all cuts
   template <typename T1, typename T2, typename T3>
-  bool isPionSelected(const T1& trackPion, const T2& trackParCovPion, const T3& dcaPion, const std::vector<T1>& charmDautracks)
+  bool isPionPreselected(const T1& trackPion, const T2& trackParCovPion, const T3& dcaPion)
   {
     // check isGlobalTrackWoDCA status for pions if wanted
     if (trackPionConfigurations.usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
@@ -430,14 +429,22 @@ struct HfDataCreatorCharmHadPiReduced {
     if (trackParCovPion.getPt() < trackPionConfigurations.ptPionMin || std::abs(trackParCovPion.getEta()) > trackPionConfigurations.etaPionMax || !isSelectedTrackDCA(trackParCovPion, dcaPion, trackPionConfigurations.binsPtPion, trackPionConfigurations.cutsTrackPionDCA)) {
       return false;
     }
-    // reject pions that are charm-hadron daughters
+
+    return true;
+  }
+
+  /// Checks whether a track is one of the charm-hadron daughters
+  /// \param trackPion is a track with the pion hypothesis
+  /// \param charmDautracks charm-hadron daughter tracks
+  template <typename T1>
+  bool isCharmHadDaughter(const T1& trackPion, const std::vector<T1>& charmDautracks)
+  {
     for (const auto& track : charmDautracks) {
       if (trackPion.globalIndex() == track.globalIndex()) {
-        return false;
+        return true;
       }
     }
-
-    return true;
+    return false;
   }
 
   /// Calculates the index of the collision with the maximum number of contributions.
@@ -482,13 +489,13 @@ struct HfDataCreatorCharmHadPiReduced {
   /// \param particlesMc is the table with MC particles
   /// \param vecDaughtersB is the vector with all daughter tracks (bachelor pion in last position)
   /// \param indexHfCandCharm is the index of the charm-hadron candidate
-  /// \param selectedTracksPion is the map with the indices of selected bachelor pion tracks
+  /// \param indexHfTrackPion is the index of the bachelor pion in the reduced pion table
   template <uint8_t DecChannel, typename CColl, typename PParticles, typename TTrack>
   void fillMcRecoInfo(const CColl& collision,
                       const PParticles& particlesMc,
                       const std::vector<TTrack>& vecDaughtersB,
                       int& indexHfCandCharm,
-                      std::map<int64_t, int64_t> selectedTracksPion,
+                      const int64_t indexHfTrackPion,
                       const int64_t indexCollisionMaxNumContrib)
   {
 
@@ -619,7 +626,7 @@ struct HfDataCreatorCharmHadPiReduced {
         }
         tables.rowHfDPiMcCheckReduced(pdgCodeBeautyMother, pdgCodeCharmMother, pdgCodeProng0, pdgCodeProng1, pdgCodeProng2, pdgCodeProng3);
       }
-      tables.rowHfDPiMcRecReduced(indexHfCandCharm, selectedTracksPion[vecDaughtersB.back().globalIndex()], flag, flagWrongCollision, debug, motherPt);
+      tables.rowHfDPiMcRecReduced(indexHfCandCharm, indexHfTrackPion, flag, flagWrongCollision, debug, motherPt);
     } else if constexpr (DecChannel == DecayChannel::BsToDsminusPi) {
       // Bs → Ds- π+ → (K- K+ π-) π+
       auto indexRec = RecoDecay::getMatchedMCRec<true, false, false, true, true>(particlesMc, std::array{vecDaughtersB[0], vecDaughtersB[1], vecDaughtersB[2], vecDaughtersB[3]}, Pdg::kBS, std::array{-kKPlus, +kKPlus, -kPiPlus, +kPiPlus}, true, &sign, 3);
@@ -774,7 +781,7 @@ struct HfDataCreatorCharmHadPiReduced {
         }
         tables.rowHfDsPiMcCheckReduced(pdgCodeBeautyMother, pdgCodeCharmMother, pdgCodeProng0, pdgCodeProng1, pdgCodeProng2, pdgCodeProng3);
       }
-      tables.rowHfDsPiMcRecReduced(indexHfCandCharm, selectedTracksPion[vecDaughtersB.back().globalIndex()], flag, flagWrongCollision, debug, motherPt);
+      tables.rowHfDsPiMcRecReduced(indexHfCandCharm, indexHfTrackPion, flag, flagWrongCollision, debug, motherPt);
     } else if constexpr (DecChannel == DecayChannel::BplusToD0barPi) {
       // B+ → D0(bar) π+ → (K+ π-) π+
       auto indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, true>(particlesMc, std::array{vecDaughtersB[0], vecDaughtersB[1], vecDaughtersB[2]}, Pdg::kBPlus, std::array{+kPiPlus, +kKPlus, -kPiPlus}, true, &sign, 2);
@@ -871,7 +878,7 @@ struct HfDataCreatorCharmHadPiReduced {
         }
         tables.rowHfD0PiMcCheckReduced(pdgCodeBeautyMother, pdgCodeCharmMother, pdgCodeProng0, pdgCodeProng1, pdgCodeProng2);
       }
-      tables.rowHfD0PiMcRecReduced(indexHfCandCharm, selectedTracksPion[vecDaughtersB.back().globalIndex()], flag, flagWrongCollision, debug, motherPt);
+      tables.rowHfD0PiMcRecReduced(indexHfCandCharm, indexHfTrackPion, flag, flagWrongCollision, debug, motherPt);
     } else if constexpr (DecChannel == DecayChannel::LbToLcplusPi) {
       // Lb → Lc+ π- → (p K- π+) π-
       auto indexRec = RecoDecay::getMatchedMCRec<false, false, false, true, true>(particlesMc, std::array{vecDaughtersB[0], vecDaughtersB[1], vecDaughtersB[2], vecDaughtersB[3]}, Pdg::kLambdaB0, std::array{+kProton, -kKPlus, +kPiPlus, -kPiPlus}, true, &sign, 3);
@@ -975,7 +982,7 @@ struct HfDataCreatorCharmHadPiReduced {
         }
         tables.rowHfLcPiMcCheckReduced(pdgCodeBeautyMother, pdgCodeCharmMother, pdgCodeProng0, pdgCodeProng1, pdgCodeProng2, pdgCodeProng3);
       }
-      tables.rowHfLcPiMcRecReduced(indexHfCandCharm, selectedTracksPion[vecDaughtersB.back().globalIndex()], flag, flagWrongCollision, debug, motherPt);
+      tables.rowHfLcPiMcRecReduced(indexHfCandCharm, indexHfTrackPion, flag, flagWrongCollision, debug, motherPt);
     } else if constexpr (DecChannel == DecayChannel::B0ToDstarPi) {
       // B0 → D*+ π- → (D0 π+) π- → (K- π+ π+) π-
       auto indexRec = RecoDecay::getMatchedMCRec<true, false, false, true, true>(particlesMc, std::array{vecDaughtersB[0], vecDaughtersB[1], vecDaughtersB[2], vecDaughtersB[3]}, Pdg::kB0, std::array{+kKPlus, -kPiPlus, -kPiPlus, +kPiPlus}, true, &sign, 4);
@@ -1012,7 +1019,7 @@ struct HfDataCreatorCharmHadPiReduced {
           checkWrongCollision(particleMother, collision, indexCollisionMaxNumContrib, flagWrongCollision);
         }
       }
-      tables.rowHfDStarPiMcRecReduced(indexHfCandCharm, selectedTracksPion[vecDaughtersB.back().globalIndex()], flag, flagWrongCollision, debug, motherPt);
+      tables.rowHfDStarPiMcRecReduced(indexHfCandCharm, indexHfTrackPion, flag, flagWrongCollision, debug, motherPt);
     }
   }
 
@@ -1039,9 +1046,8 @@ struct HfDataCreatorCharmHadPiReduced {
 
     // helpers for ReducedTables filling
     int const indexHfReducedCollision = tables.hfReducedCollision.lastIndex() + 1;
-    // std::map where the key is the track.globalIndex() and
-    // the value is the track index in the table of the selected pions
-    std::map<int64_t, int64_t> selectedTracksPion;
+    // preselected bachelor pions of this collision, each stored in the table of the selected pions at most once
+    o2::hf_bachelor::BachelorTrackCache<typename TTracks::iterator> pionCache;
     bool fillHfReducedCollision = false;
 
     auto primaryVertex = getPrimaryVertex(collision);
@@ -1065,6 +1071,13 @@ struct HfDataCreatorCharmHadPiReduced {
     df3.setBz(bz);
 
     auto thisCollId = collision.globalIndex();
+    // select and propagate the bachelor pions once for all the charm-hadron candidates
+    if (candsC.size() > 0) {
+      pionCache.template fill<TTracks>(collision, trackIndices, noMatCorr, [this](const auto& trackPion, const auto& trackParCovPion, const auto& dcaPion) {
+        return isPionPreselected(trackPion, trackParCovPion, dcaPion);
+      });
+    }
+
     for (const auto& candC : candsC) {
       int indexHfCandCharm{-1};
       float invMassC0{-1.f}, invMassC1{-1.f};
@@ -1273,35 +1286,26 @@ struct HfDataCreatorCharmHadPiReduced {
         }
       }
 
-      for (const auto& trackId : trackIndices) {
-        auto trackPion = trackId.template track_as<TTracks>();
-
-        // apply selections on pion tracks
-        auto trackParCovPion = getTrackParCov(trackPion);
-        std::array<float, 2> dcaPion{trackPion.dcaXY(), trackPion.dcaZ()};
-        std::array<float, 3> pVecPion = trackPion.pVector();
-        if (trackPion.collisionId() != thisCollId) {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParCovPion, 2.f, noMatCorr, &dcaPion);
-          getPxPyPz(trackParCovPion, pVecPion);
-        }
+      // reject pi D with same sign as D
+      bool acceptNegPion{true}, acceptPosPion{true};
+      if constexpr (DecChannel == DecayChannel::B0ToDminusPi || DecChannel == DecayChannel::BsToDsminusPi || DecChannel == DecayChannel::LbToLcplusPi) { // D∓ → π∓ K± π∓ and Ds∓ → K∓ K± π∓ and Lc∓ → p∓ K± π∓
+        acceptNegPion = charmHadDauTracks[0].sign() > 0;
+        acceptPosPion = charmHadDauTracks[0].sign() < 0;
+      } else if constexpr (DecChannel == DecayChannel::BplusToD0barPi) { // D0(bar) → K± π∓
+        acceptNegPion = candC.isSelD0() >= hfflagConfigurations.selectionFlagD0;
+        acceptPosPion = candC.isSelD0bar() >= hfflagConfigurations.selectionFlagD0bar;
+      } else if constexpr (DecChannel == DecayChannel::B0ToDstarPi) { // D*+ → D0 π+
+        acceptNegPion = charmHadDauTracks.back().sign() > 0;
+        acceptPosPion = charmHadDauTracks.back().sign() < 0;
+      }
 
-        // reject pi D with same sign as D
-        if constexpr (DecChannel == DecayChannel::B0ToDminusPi || DecChannel == DecayChannel::BsToDsminusPi || DecChannel == DecayChannel::LbToLcplusPi) { // D∓ → π∓ K± π∓ and Ds∓ → K∓ K± π∓ and Lc∓ → p∓ K± π∓
-          if (trackPion.sign() * charmHadDauTracks[0].sign() > 0) {
-            continue;
-          }
-        } else if constexpr (DecChannel == DecayChannel::BplusToD0barPi) { // D0(bar) → K± π∓
-          if (!((candC.isSelD0() >= hfflagConfigurations.selectionFlagD0 && trackPion.sign() < 0) || (candC.isSelD0bar() >= hfflagConfigurations.selectionFlagD0bar && trackPion.sign() > 0))) {
-            continue;
-          }
-        } else if constexpr (DecChannel == DecayChannel::B0ToDstarPi) { // D*+ → D0 π+
-          if (trackPion.sign() * charmHadDauTracks.back().sign() > 0) {
-            continue;
-          }
-        }
+      for (const auto& iPion : pionCache.positionsWithSign(acceptNegPion, acceptPosPion)) {
+        const auto& trackPion = pionCache.tracks[iPion];
+        const auto& trackParCovPion = pionCache.trackParCovs[iPion];
+        const auto& pVecPion = pionCache.pVecs[iPion];
 
-        // apply selections on pion tracks
-        if (!isPionSelected(trackPion, trackParCovPion, dcaPion, charmHadDauTracks)) {
+        // reject pions that are charm-hadron daughters
+        if (isCharmHadDaughter(trackPion, charmHadDauTracks)) {
           continue;
         }
 
@@ -1314,7 +1318,7 @@ struct HfDataCreatorCharmHadPiReduced {
 
         // fill Pion tracks table
         // if information on track already stored, go to next track
-        if (!selectedTracksPion.count(trackPion.globalIndex())) {
+        if (pionCache.tableIndices[iPion] < 0) {
           tables.hfTrackPion(trackPion.globalIndex(), indexHfReducedCollision,
                              trackParCovPion.getX(), trackParCovPion.getAlpha(),
                              trackParCovPion.getY(), trackParCovPion.getZ(), trackParCovPion.getSnp(),
@@ -1329,10 +1333,10 @@ struct HfDataCreatorCharmHadPiReduced {
           tables.hfTrackPidPion(trackPion.hasTPC(), trackPion.hasTOF(),
                                 trackPion.tpcNSigmaPi(), trackPion.tofNSigmaPi());
           tables.hfTrackMomPion(pVecPion[0], pVecPion[1], pVecPion[2], trackPion.sign());
-          // add trackPion.globalIndex() to a list
+          // keep the index of the pion in tables.hfTrackPion
           // to keep memory of the pions filled in the table and avoid refilling them if they are paired to another D candidate
-          // and keep track of their index in tables.hfTrackPion for McRec purposes
-          selectedTracksPion[trackPion.globalIndex()] = tables.hfTrackPion.lastIndex();
+          // and for McRec purposes
+          pionCache.tableIndices[iPion] = tables.hfTrackPion.lastIndex();
         }
 
         if constexpr (DoMc) {
@@ -1342,7 +1346,7 @@ struct HfDataCreatorCharmHadPiReduced {
             beautyHadDauTracks.push_back(track);
           }
           beautyHadDauTracks.push_back(trackPion);
-          fillMcRecoInfo<DecChannel>(collision, particlesMc, beautyHadDauTracks, indexHfCandCharm, selectedTracksPion, indexCollisionMaxNumContrib);
+          fillMcRecoInfo<DecChannel>(collision, particlesMc, beautyHadDauTracks, indexHfCandCharm, pionCache.tableIndices[iPion], indexCollisionMaxNumContrib);
         }
         fillHfCandCharm = true;
       } // pion loop
@@ -0,0 +1,114 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsBachelorTracks.h
+/// \brief Per-collision cache of preselected bachelor tracks for the reduced data creators
+
+#ifndef PWGHF_D2H_UTILS_UTILSBACHELORTRACKS_H_
+#define PWGHF_D2H_UTILS_UTILSBACHELORTRACKS_H_
+
+#include "Common/Core/trackUtilities.h"
+
+#include <DetectorsBase/Propagator.h>
+#include <ReconstructionDataFormats/Track.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace o2::hf_bachelor
+{
+/// Bachelor tracks of one collision which pass the candidate-independent selections.
+/// Each track is selected, propagated to the primary vertex and stored once in flat arrays (in the order of the
+/// track-to-collision association), such that the loop over the charm-hadron candidates only has to form the pairs.
+/// The positions of the negative and positive tracks are also kept separately, to loop only over the allowed charges.
+/// \tparam TTrack is the track iterator type
+template <typename TTrack>
+struct BachelorTrackCache {
+  std::vector<TTrack> tracks;                       // track iterators
+  std::vector<o2::track::TrackParCov> trackParCovs; // track parametrisations at the primary vertex
+  std::vector<std::array<float, 2>> dcas;           // DCAs to the primary vertex
+  std::vector<std::array<float, 3>> pVecs;          // momenta at the primary vertex
+  std::vector<int8_t> signs;                        // track charge signs
+  std::vector<int64_t> tableIndices;                // index of the track in the output table, -1 if not yet stored
+  std::vector<std::size_t> positionsNeg;            // positions of the negative tracks
+  std::vector<std::size_t> positionsPos;            // positions of the positive tracks
+  std::vector<std::size_t> positionsAll;            // positions of all tracks
+  std::vector<std::size_t> positionsNone;           // always empty
+
+  void clear()
+  {
+    tracks.clear();
+    trackParCovs.clear();
+    dcas.clear();
+    pVecs.clear();
+    signs.clear();
+    tableIndices.clear();
+    positionsNeg.clear();
+    positionsPos.clear();
+    positionsAll.clear();
+  }
+
+  std::size_t size() const { return tracks.size(); }
+  bool empty() const { return tracks.empty(); }
+
+  /// Positions of the tracks with the accepted charge signs, in the order in which they were filled
+  const std::vector<std::size_t>& positionsWithSign(bool acceptNeg, bool acceptPos) const
+  {
+    if (acceptNeg && acceptPos) {
+      return positionsAll;
+    }
+    if (acceptNeg) {
+      return positionsNeg;
+    }
+    if (acceptPos) {
+      return positionsPos;
+    }
+    return positionsNone;
+  }
+
+  /// Fills the cache with the tracks associated to a collision
+  /// \param collision is the collision
+  /// \param trackIndices are the track-to-collision associations of this collision
+  /// \param matCorr is the material correction used in the propagation of tracks from other collisions
+  /// \param isPreselected is called as isPreselected(track, trackParCov, dca) and returns true if the track is kept
+  template <typename TTracks, typename TColl, typename TTrackIndices, typename TSelector>
+  void fill(TColl const& collision, TTrackIndices const& trackIndices, o2::base::Propagator::MatCorrType matCorr, TSelector&& isPreselected)
+  {
+    clear();
+    const auto collId = collision.globalIndex();
+    for (const auto& trackId : trackIndices) {
+      auto track = trackId.template track_as<TTracks>();
+      auto trackParCov = getTrackParCov(track);
+      std::array<float, 2> dca{track.dcaXY(), track.dcaZ()};
+      std::array<float, 3> pVec = track.pVector();
+      if (track.collisionId() != collId) {
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParCov, 2.f, matCorr, &dca);
+        getPxPyPz(trackParCov, pVec);
+      }
+      if (!isPreselected(track, trackParCov, dca)) {
+        continue;
+      }
+      (track.sign() > 0 ? positionsPos : positionsNeg).push_back(tracks.size());
+      positionsAll.push_back(tracks.size());
+      tracks.push_back(track);
+      trackParCovs.push_back(trackParCov);
+      dcas.push_back(dca);
+      pVecs.push_back(pVec);
+      signs.push_back(track.sign());
+      tableIndices.push_back(-1);
+    }
+  }
+};
+} // namespace o2::hf_bachelor
+
+#endif // PWGHF_D2H_UTILS_UTILSBACHELORTRACKS_H_
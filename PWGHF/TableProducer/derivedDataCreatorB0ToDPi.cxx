@@ -248,7 +248,7 @@ struct HfDerivedDataCreatorB0ToDPi {
     // Fill collision properties
     if constexpr (IsMc) {
       if (confDerData.fillMcRCollId) {
-        rowsCommon.matchedCollisions.clear();
+        rowsCommon.clearMatchedCollisions();
       }
     }
     // const auto sizeTableColl = collisions.size();
@@ -345,7 +345,7 @@ struct HfDerivedDataCreatorB0ToDPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, true>(collisions, candidatesMcSig, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -359,7 +359,7 @@ struct HfDerivedDataCreatorB0ToDPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, true, false>(collisions, candidatesMcBkg, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -373,7 +373,7 @@ struct HfDerivedDataCreatorB0ToDPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, false>(collisions, candidatesMcAll, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -399,7 +399,7 @@ struct HfDerivedDataCreatorB0ToDPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, true>(collisions, candidatesMcMlSig, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -413,7 +413,7 @@ struct HfDerivedDataCreatorB0ToDPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, true, false>(collisions, candidatesMcMlBkg, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -427,7 +427,7 @@ struct HfDerivedDataCreatorB0ToDPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, false>(collisions, candidatesMcMlAll, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
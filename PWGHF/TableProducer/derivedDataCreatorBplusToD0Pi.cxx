@@ -283,7 +283,7 @@ struct HfDerivedDataCreatorBplusToD0Pi {
     // Fill collision properties
     if constexpr (IsMc) {
       if (confDerData.fillMcRCollId) {
-        rowsCommon.matchedCollisions.clear();
+        rowsCommon.clearMatchedCollisions();
       }
     }
     // const auto sizeTableColl = collisions.size();
@@ -387,7 +387,7 @@ struct HfDerivedDataCreatorBplusToD0Pi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, true>(collisions, candidatesMcSig, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -401,7 +401,7 @@ struct HfDerivedDataCreatorBplusToD0Pi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, true, false>(collisions, candidatesMcBkg, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -415,7 +415,7 @@ struct HfDerivedDataCreatorBplusToD0Pi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, false>(collisions, candidatesMcAll, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -441,7 +441,7 @@ struct HfDerivedDataCreatorBplusToD0Pi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, true>(collisions, candidatesMcMlSig, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -455,7 +455,7 @@ struct HfDerivedDataCreatorBplusToD0Pi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, true, false>(collisions, candidatesMcMlBkg, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -469,7 +469,7 @@ struct HfDerivedDataCreatorBplusToD0Pi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, false>(collisions, candidatesMcMlAll, candidatesDaughters, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -0,0 +1,101 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file derivedDataCreatorCharm3ProngMcGen.cxx
+/// \brief Producer of derived tables of generated D+, Ds and Lc (3-prong) MC particles and their MC collisions in one sweep
+/// \note Produces only the MC collision and MC particle tables, filled as by processMcGenOnly of derivedDataCreatorDplusToPiKPi.cxx,
+///       derivedDataCreatorDsToKKPi.cxx and derivedDataCreatorLcToPKPi.cxx. It replaces them when several of these species are
+///       produced together and cannot run in the same workflow as their MC process functions.
+
+#include "PWGHF/Core/DecayChannels.h"
+#include "PWGHF/DataModel/CandidateReconstructionTables.h"
+#include "PWGHF/DataModel/DerivedTables.h"
+#include "PWGHF/Utils/utilsDerivedData.h"
+#include "PWGLF/DataModel/mcCentrality.h"
+
+#include <CommonConstants/PhysicsConstants.h>
+#include <Framework/ASoA.h>
+#include <Framework/AnalysisDataModel.h>
+#include <Framework/AnalysisHelpers.h>
+#include <Framework/AnalysisTask.h>
+#include <Framework/Configurable.h>
+#include <Framework/InitContext.h>
+#include <Framework/Logger.h>
+#include <Framework/runDataProcessing.h>
+
+#include <cstdint>
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+using namespace o2::analysis::hf_derived;
+
+/// Writes the generator-level information of several 3-prong species in one pass over the MC particles
+struct HfDerivedDataCreatorCharm3ProngMcGen {
+  HfProducesDerivedDataMcGen<
+    o2::aod::HfDplusMcCollBases,
+    o2::aod::HfDplusMcCollIds,
+    o2::aod::HfDplusMcRCollIds,
+    o2::aod::HfDplusPBases,
+    o2::aod::HfDplusPIds>
+    rowsDplus;
+  HfProducesDerivedDataMcGen<
+    o2::aod::HfDsMcCollBases,
+    o2::aod::HfDsMcCollIds,
+    o2::aod::HfDsMcRCollIds,
+    o2::aod::HfDsPBases,
+    o2::aod::HfDsPIds>
+    rowsDs;
+  HfProducesDerivedDataMcGen<
+    o2::aod::HfLcMcCollBases,
+    o2::aod::HfLcMcCollIds,
+    o2::aod::HfLcMcRCollIds,
+    o2::aod::HfLcPBases,
+    o2::aod::HfLcPIds>
+    rowsLc;
+
+  // Switches for filling tables (only the MC collision and MC particle ones are used)
+  HfConfigurableDerivedData confDerData;
+  Configurable<bool> fillDplus{"fillDplus", true, "Fill tables of D+ -> pi K pi"};
+  Configurable<bool> fillDs{"fillDs", true, "Fill tables of Ds -> K K pi"};
+  Configurable<bool> fillLc{"fillLc", true, "Fill tables of Lc -> p K pi"};
+
+  using MatchedGenCandidatesMc = soa::Filtered<soa::Join<aod::McParticles, aod::HfCand3ProngMcGen>>;
+  using TypeMcCollisions = soa::Join<aod::McCollisions, aod::McCentFT0Ms>;
+
+  Filter filterMcGenMatching = nabs(aod::hf_cand_mc_flag::flagMcMatchGen) == static_cast<int8_t>(hf_decay::hf_cand_3prong::DecayChannelMain::DplusToPiKPi) ||
+                               nabs(aod::hf_cand_mc_flag::flagMcMatchGen) == static_cast<int8_t>(hf_decay::hf_cand_3prong::DecayChannelMain::DsToPiKK) ||
+                               nabs(aod::hf_cand_mc_flag::flagMcMatchGen) == static_cast<int8_t>(hf_decay::hf_cand_3prong::DecayChannelMain::LcToPKPi);
+
+  Preslice<MatchedGenCandidatesMc> mcParticlesPerMcCollision = aod::mcparticle::mcCollisionId;
+
+  void init(InitContext const&)
+  {
+    rowsDplus.init(confDerData);
+    rowsDs.init(confDerData);
+    rowsLc.init(confDerData);
+  }
+
+  void processMcGenOnly(TypeMcCollisions const& mcCollisions,
+                        MatchedGenCandidatesMc const& mcParticles)
+  {
+    HfMcSpeciesDerivedData<decltype(rowsDplus)> dplus{rowsDplus, static_cast<int8_t>(hf_decay::hf_cand_3prong::DecayChannelMain::DplusToPiKPi), o2::constants::physics::MassDPlus, fillDplus.value};
+    HfMcSpeciesDerivedData<decltype(rowsDs)> ds{rowsDs, static_cast<int8_t>(hf_decay::hf_cand_3prong::DecayChannelMain::DsToPiKK), o2::constants::physics::MassDS, fillDs.value};
+    HfMcSpeciesDerivedData<decltype(rowsLc)> lc{rowsLc, static_cast<int8_t>(hf_decay::hf_cand_3prong::DecayChannelMain::LcToPKPi), o2::constants::physics::MassLambdaCPlus, fillLc.value};
+    processMcParticlesMultiSpecies(mcCollisions, mcParticlesPerMcCollision, mcParticles, dplus, ds, lc);
+  }
+  PROCESS_SWITCH(HfDerivedDataCreatorCharm3ProngMcGen, processMcGenOnly, "Process MC gen. only", true);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<HfDerivedDataCreatorCharm3ProngMcGen>(cfgc)};
+}
@@ -247,7 +247,7 @@ struct HfDerivedDataCreatorD0ToKPi {
     // Fill collision properties
     if constexpr (IsMc) {
       if (confDerData.fillMcRCollId) {
-        rowsCommon.matchedCollisions.clear();
+        rowsCommon.clearMatchedCollisions();
       }
     }
     // const auto sizeTableColl = collisions.size();
@@ -363,7 +363,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                  aod::Tracks const& tracks,
                                  aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::DCAFitter, false, true, false, true>(collisions, candidatesMcSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -376,7 +376,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                  aod::Tracks const& tracks,
                                  aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::DCAFitter, false, true, true, false>(collisions, candidatesMcBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -389,7 +389,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                  aod::Tracks const& tracks,
                                  aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::DCAFitter, false, true, false, false>(collisions, candidatesMcAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -402,7 +402,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                   aod::Tracks const& tracks,
                                   aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::KfParticle, false, true, false, true>(collisions, candidatesMcKfSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -415,7 +415,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                   aod::Tracks const& tracks,
                                   aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::KfParticle, false, true, true, false>(collisions, candidatesMcKfBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -428,7 +428,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                   aod::Tracks const& tracks,
                                   aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::KfParticle, false, true, false, false>(collisions, candidatesMcKfAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -461,7 +461,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                    aod::Tracks const& tracks,
                                    aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::DCAFitter, true, true, false, true>(collisions, candidatesMcMlSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -474,7 +474,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                    aod::Tracks const& tracks,
                                    aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::DCAFitter, true, true, true, false>(collisions, candidatesMcMlBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -487,7 +487,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                    aod::Tracks const& tracks,
                                    aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::DCAFitter, true, true, false, false>(collisions, candidatesMcMlAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -500,7 +500,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                     aod::Tracks const& tracks,
                                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::KfParticle, true, true, false, true>(collisions, candidatesMcKfMlSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -513,7 +513,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                     aod::Tracks const& tracks,
                                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::KfParticle, true, true, true, false>(collisions, candidatesMcKfMlBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -526,7 +526,7 @@ struct HfDerivedDataCreatorD0ToKPi {
                                     aod::Tracks const& tracks,
                                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<aod::hf_cand::VertexerType::KfParticle, true, true, false, false>(collisions, candidatesMcKfMlAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -245,7 +245,7 @@ struct HfDerivedDataCreatorDplusToPiKPi {
     // Fill collision properties
     if constexpr (IsMc) {
       if (confDerData.fillMcRCollId) {
-        rowsCommon.matchedCollisions.clear();
+        rowsCommon.clearMatchedCollisions();
       }
     }
     // const auto sizeTableColl = collisions.size();
@@ -338,7 +338,7 @@ struct HfDerivedDataCreatorDplusToPiKPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, true>(collisions, candidatesMcSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -351,7 +351,7 @@ struct HfDerivedDataCreatorDplusToPiKPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, true, false>(collisions, candidatesMcBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -364,7 +364,7 @@ struct HfDerivedDataCreatorDplusToPiKPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, false>(collisions, candidatesMcAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -388,7 +388,7 @@ struct HfDerivedDataCreatorDplusToPiKPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, true>(collisions, candidatesMcMlSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -401,7 +401,7 @@ struct HfDerivedDataCreatorDplusToPiKPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, true, false>(collisions, candidatesMcMlBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -414,7 +414,7 @@ struct HfDerivedDataCreatorDplusToPiKPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, false>(collisions, candidatesMcMlAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
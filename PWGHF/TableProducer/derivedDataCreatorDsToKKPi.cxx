@@ -228,7 +228,7 @@ struct HfDerivedDataCreatorDsToKKPi {
     // Fill collision properties
     if constexpr (IsMc) {
       if (confDerData.fillMcRCollId) {
-        rowsCommon.matchedCollisions.clear();
+        rowsCommon.clearMatchedCollisions();
       }
     }
     // const auto sizeTableColl = collisions.size();
@@ -319,7 +319,7 @@ struct HfDerivedDataCreatorDsToKKPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, true>(collisions, candidatesMcSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -332,7 +332,7 @@ struct HfDerivedDataCreatorDsToKKPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, true, false>(collisions, candidatesMcBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -345,7 +345,7 @@ struct HfDerivedDataCreatorDsToKKPi {
                     TracksWPid const& tracks,
                     aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<false, true, false, false>(collisions, candidatesMcAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -369,7 +369,7 @@ struct HfDerivedDataCreatorDsToKKPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, true>(collisions, candidatesMcMlSig, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -382,7 +382,7 @@ struct HfDerivedDataCreatorDsToKKPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, true, false>(collisions, candidatesMcMlBkg, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
@@ -395,7 +395,7 @@ struct HfDerivedDataCreatorDsToKKPi {
                       TracksWPid const& tracks,
                       aod::BCs const& bcs)
   {
-    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticlesPerMcCollision, mcParticles);
+    rowsCommon.preProcessMcCollisions(mcCollisions, mcParticles);
     processCandidates<true, true, false, false>(collisions, candidatesMcMlAll, tracks, bcs);
     rowsCommon.processMcParticles(mcCollisions, mcParticlesPerMcCollision, mcParticles, Mass);
   }
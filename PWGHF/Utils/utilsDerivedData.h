@@ -23,8 +23,9 @@
 #include <Framework/Configurable.h>
 #include <Framework/Logger.h>
 
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <cstdlib>
 #include <vector>
 
 // Macro to store nSigma for prong _id_ with PID hypothesis _hyp_ in an array
@@ -88,14 +89,22 @@ struct HfProducesDerivedData : o2::framework::ProducesGroup {
   o2::framework::Produces<HfPIds> rowParticleId;
 
   HfConfigurableDerivedData const* conf{};
-  std::map<int, std::vector<int>> matchedCollisions; // indices of derived reconstructed collisions matched to the global indices of MC collisions
-  std::map<int, bool> hasMcParticles;                // flags for MC collisions with HF particles
+  std::vector<std::vector<int>> matchedCollisions; // indices of derived reconstructed collisions matched to MC collisions, indexed by the MC collision global index
+  std::vector<uint8_t> hasMcParticles;             // flags for MC collisions with HF particles, indexed by the MC collision global index
 
   void init(HfConfigurableDerivedData const& c)
   {
     conf = &c;
   }
 
+  /// Clears the indices of matched derived collisions, keeping the per-MC-collision buffers
+  void clearMatchedCollisions()
+  {
+    for (auto& indices : matchedCollisions) {
+      indices.clear();
+    }
+  }
+
   void reserveTablesCandidates(const uint64_t size)
   {
     o2::analysis::hf_derived::reserveTable(rowCandidateBase, conf->fillCandidateBase, size);
@@ -157,9 +166,13 @@ struct HfProducesDerivedData : o2::framework::ProducesGroup {
     }
     if constexpr (IsMc) {
       if (conf->fillMcRCollId.value && collision.has_mcCollision()) {
-        // Save rowCollBase.lastIndex() at key collision.mcCollisionId()
-        LOGF(debug, "Rec. collision %d: Filling derived-collision index %d for MC collision %d", collision.globalIndex(), rowCollBase.lastIndex(), collision.mcCollisionId());
-        matchedCollisions[collision.mcCollisionId()].push_back(rowCollBase.lastIndex()); // [] inserts an empty element if it does not exist
+        // Save rowCollBase.lastIndex() at position collision.mcCollisionId()
+        const auto mcCollisionId = collision.mcCollisionId();
+        LOGF(debug, "Rec. collision %d: Filling derived-collision index %d for MC collision %d", collision.globalIndex(), rowCollBase.lastIndex(), mcCollisionId);
+        if (static_cast<std::size_t>(mcCollisionId) >= matchedCollisions.size()) {
+          matchedCollisions.resize(mcCollisionId + 1);
+        }
+        matchedCollisions[mcCollisionId].push_back(rowCollBase.lastIndex());
       }
     }
   }
@@ -207,19 +220,16 @@ struct HfProducesDerivedData : o2::framework::ProducesGroup {
 
   template <typename TMcCollisions, typename TMcParticles>
   void preProcessMcCollisions(TMcCollisions const& mcCollisions,
-                              o2::framework::Preslice<TMcParticles> const& mcParticlesPerMcCollision,
                               TMcParticles const& mcParticles)
   {
+    matchedCollisions.resize(mcCollisions.size());
     if (!conf->fillMcRCollId.value) {
       return;
     }
-    hasMcParticles.clear();
-    // Fill MC collision flags
-    for (const auto& mcCollision : mcCollisions) {
-      const auto thisMcCollId = mcCollision.globalIndex();
-      const auto particlesThisMcColl = mcParticles.sliceBy(mcParticlesPerMcCollision, thisMcCollId);
-      LOGF(debug, "MC collision %d has %d MC particles (preprocess)", thisMcCollId, particlesThisMcColl.size());
-      hasMcParticles[thisMcCollId] = (particlesThisMcColl.size() > 0);
+    // Fill MC collision flags in one pass over the MC particles
+    hasMcParticles.assign(mcCollisions.size(), 0);
+    for (const auto& particle : mcParticles) {
+      hasMcParticles[particle.mcCollisionId()] = 1;
     }
   }
 
@@ -234,6 +244,9 @@ struct HfProducesDerivedData : o2::framework::ProducesGroup {
     // reserveTablesMcColl(sizeTableMcColl);
     const auto sizeTablePart = mcParticles.size();
     reserveTablesParticles(sizeTablePart);
+    if (matchedCollisions.size() < static_cast<std::size_t>(mcCollisions.size())) {
+      matchedCollisions.resize(mcCollisions.size());
+    }
     for (const auto& mcCollision : mcCollisions) {
       const auto thisMcCollId = mcCollision.globalIndex();
       const auto particlesThisMcColl = mcParticles.sliceBy(mcParticlesPerMcCollision, thisMcCollId);
@@ -255,6 +268,158 @@ struct HfProducesDerivedData : o2::framework::ProducesGroup {
     }
   }
 };
+
+/// Generator-level derived tables of one species, i.e. the MC collision and MC particle tables of HfProducesDerivedData.
+/// Used by tasks filling the tables of MC particles without reconstructed candidates and collisions.
+template <
+  typename HfMcCollBases,
+  typename HfMcCollIds,
+  typename HfMcRCollIds,
+  typename HfPBases,
+  typename HfPIds>
+struct HfProducesDerivedDataMcGen : o2::framework::ProducesGroup {
+  // MC collisions
+  o2::framework::Produces<HfMcCollBases> rowMcCollBase;
+  o2::framework::Produces<HfMcCollIds> rowMcCollId;
+  o2::framework::Produces<HfMcRCollIds> rowMcRCollId;
+  // MC particles
+  o2::framework::Produces<HfPBases> rowParticleBase;
+  o2::framework::Produces<HfPIds> rowParticleId;
+
+  HfConfigurableDerivedData const* conf{};
+  const std::vector<int> noMatchedCollisions{}; // no reconstructed collisions are saved
+
+  void init(HfConfigurableDerivedData const& c)
+  {
+    conf = &c;
+  }
+
+  void reserveTablesParticles(const uint64_t size)
+  {
+    o2::analysis::hf_derived::reserveTable(rowParticleBase, conf->fillParticleBase, size);
+    o2::analysis::hf_derived::reserveTable(rowParticleId, conf->fillParticleId, size);
+  }
+
+  template <typename TMcCollision>
+  void fillTablesMcCollision(TMcCollision const& mcCollision)
+  {
+    if (conf->fillMcCollBase.value) {
+      rowMcCollBase(
+        mcCollision.posX(),
+        mcCollision.posY(),
+        mcCollision.posZ(),
+        mcCollision.centFT0M());
+    }
+    if (conf->fillMcCollId.value) {
+      rowMcCollId(
+        mcCollision.globalIndex());
+    }
+    if (conf->fillMcRCollId.value) {
+      rowMcRCollId(
+        noMatchedCollisions);
+    }
+  }
+
+  template <typename TMcParticle, typename TMass>
+  void fillTablesParticle(TMcParticle const& particle, const TMass mass)
+  {
+    if (conf->fillParticleBase.value) {
+      rowParticleBase(
+        rowMcCollBase.lastIndex(),
+        particle.pt(),
+        particle.eta(),
+        particle.phi(),
+        RecoDecayPtEtaPhi::y(particle.pt(), particle.eta(), mass),
+        particle.flagMcMatchGen(),
+        particle.originMcGen());
+    }
+    if (conf->fillParticleId.value) {
+      rowParticleId(
+        particle.mcCollisionId(),
+        particle.globalIndex());
+    }
+  }
+};
+
+/// Species filled by processMcParticlesMultiSpecies: generator-level derived tables and flag of the species
+template <typename TProducesDerivedDataMcGen>
+struct HfMcSpeciesDerivedData {
+  TProducesDerivedDataMcGen& rows;
+  int8_t flagMcMatchGen; // absolute value of flagMcMatchGen of the particles of this species
+  double mass;           // mass used for the particle rapidity
+  bool enabled;
+  bool isMcCollisionFilled{false}; // whether the current MC collision has been filled in the tables of this species
+  uint64_t nParticles{0};
+
+  bool isSpecies(const int flag) const
+  {
+    return enabled && flag == flagMcMatchGen;
+  }
+
+  void countParticle(const int flag)
+  {
+    nParticles += isSpecies(flag);
+  }
+
+  void reserveTables()
+  {
+    if (!enabled) {
+      return;
+    }
+    rows.reserveTablesParticles(nParticles);
+    nParticles = 0;
+  }
+
+  /// Fills the particle if it belongs to this species, preceded by its MC collision for the first particle of the collision
+  template <typename TMcCollision, typename TMcParticle>
+  void fillParticle(TMcCollision const& mcCollision, TMcParticle const& particle, const int flag)
+  {
+    if (!isSpecies(flag)) {
+      return;
+    }
+    if (!isMcCollisionFilled) {
+      LOGF(debug, "Filling MC collision %d at derived index %d", mcCollision.globalIndex(), rows.rowMcCollBase.lastIndex() + 1);
+      rows.fillTablesMcCollision(mcCollision);
+      isMcCollisionFilled = true;
+    }
+    rows.fillTablesParticle(particle, mass);
+  }
+
+  void resetMcCollision()
+  {
+    isMcCollisionFilled = false;
+  }
+};
+
+/// Fills the MC collision and particle tables of several species sharing the same MC particle table in one sweep
+/// over the MC collisions and particles. Each particle is dispatched to the species with the same |flagMcMatchGen|.
+/// The tables of each species are the same as filled by HfProducesDerivedData::processMcParticles with the MC
+/// particles of this species only and without reconstructed collisions, i.e. MC collisions without particles of
+/// the species are skipped.
+template <typename TMcCollisions, typename TMcParticles, typename... TSpecies>
+void processMcParticlesMultiSpecies(TMcCollisions const& mcCollisions,
+                                    o2::framework::Preslice<TMcParticles> const& mcParticlesPerMcCollision,
+                                    TMcParticles const& mcParticles,
+                                    TSpecies&... species)
+{
+  // Count the particles of each species to reserve the tables
+  for (const auto& particle : mcParticles) {
+    const int flag = std::abs(particle.flagMcMatchGen());
+    (species.countParticle(flag), ...);
+  }
+  (species.reserveTables(), ...);
+
+  for (const auto& mcCollision : mcCollisions) {
+    const auto thisMcCollId = mcCollision.globalIndex();
+    const auto particlesThisMcColl = mcParticles.sliceBy(mcParticlesPerMcCollision, thisMcCollId);
+    LOGF(debug, "MC collision %d has %d MC particles", thisMcCollId, particlesThisMcColl.size());
+    for (const auto& particle : particlesThisMcColl) {
+      const int flag = std::abs(particle.flagMcMatchGen());
+      (species.fillParticle(mcCollision, particle, flag), ...);
+    }
+    (species.resetMcCollision(), ...);
+  }
+}
 } // namespace o2::analysis::hf_derived
 
 #endif // PWGHF_UTILS_UTILSDERIVEDDATA_H_
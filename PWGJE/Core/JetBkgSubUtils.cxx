@@ -18,8 +18,11 @@
 #include <TMath.h>
 
 #include <fastjet/AreaDefinition.hh>
+#include <fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh>
 #include <fastjet/ClusterSequenceArea.hh>
+#include <fastjet/ClusterSequenceAreaBase.hh>
 #include <fastjet/GhostedAreaSpec.hh>
+#include <fastjet/config.h>
 #include <fastjet/JetDefinition.hh>
 #include <fastjet/PseudoJet.hh>
 #include <fastjet/Selector.hh>
@@ -28,6 +31,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -65,6 +69,58 @@ std::tuple<double, double> JetBkgSubUtils::estimateRhoAreaMedian(const std::vect
   // cluster the kT jets
   fastjet::ClusterSequenceArea clusterSeq(inputParticles, jetDefBkg, areaDefBkg);
 
+  return getRhoFromClusterSequence(clusterSeq, doSparseSub);
+}
+
+std::vector<std::tuple<double, double>> JetBkgSubUtils::estimateRhoAreaMedian(const std::vector<std::vector<fastjet::PseudoJet>>& inputParticlesSets, bool doSparseSub, int nThreads)
+{
+  JetBkgSubUtils::initialise();
+
+  const int nSets = inputParticlesSets.size();
+  std::vector<std::tuple<double, double>> rhos(nSets, std::make_tuple(0.0, 0.0));
+  if (std::none_of(inputParticlesSets.begin(), inputParticlesSets.end(), [](const auto& inputParticles) { return inputParticles.size() != 0; })) {
+    return rhos;
+  }
+
+  // one ghost grid for all the sets, generated as ClusterSequenceArea does for a single clustering
+  std::vector<fastjet::PseudoJet> ghosts;
+  areaDefBkg.ghost_spec().add_ghosts(ghosts);
+  const double ghostArea = areaDefBkg.ghost_spec().actual_ghost_area();
+
+  // the clusterings only read the input particles, the ghosts and the definitions, so the sets can be split between threads.
+  // Concurrent clusterings are however only supported by FastJet builds configured with (limited) thread safety
+#if !defined(FASTJET_HAVE_LIMITED_THREAD_SAFETY) && !defined(FASTJET_HAVE_THREAD_SAFETY)
+  nThreads = 1;
+#endif
+  const int nWorkers = std::max(1, std::min(nThreads, nSets));
+  const int chunkSize = (nSets + nWorkers - 1) / nWorkers;
+  auto estimateChunk = [&](int iWorker) {
+    const int first = iWorker * chunkSize;
+    const int last = std::min(first + chunkSize, nSets);
+    for (int iSet = first; iSet < last; iSet++) {
+      if (inputParticlesSets[iSet].size() == 0) {
+        continue;
+      }
+      fastjet::ClusterSequenceActiveAreaExplicitGhosts clusterSeq(inputParticlesSets[iSet], jetDefBkg, ghosts, ghostArea);
+      rhos[iSet] = getRhoFromClusterSequence(clusterSeq, doSparseSub);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(nWorkers - 1);
+  for (int iWorker = 1; iWorker < nWorkers; iWorker++) {
+    workers.emplace_back(estimateChunk, iWorker);
+  }
+  estimateChunk(0);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  return rhos;
+}
+
+std::tuple<double, double> JetBkgSubUtils::getRhoFromClusterSequence(const fastjet::ClusterSequenceAreaBase& clusterSeq, bool doSparseSub) const
+{
   // select jets in detector acceptance
   std::vector<fastjet::PseudoJet> alljets = selRho(clusterSeq.inclusive_jets());
 
@@ -18,6 +18,7 @@
 #define PWGJE_CORE_JETBKGSUBUTILS_H_
 
 #include <fastjet/AreaDefinition.hh>
+#include <fastjet/ClusterSequenceAreaBase.hh>
 #include <fastjet/GhostedAreaSpec.hh>
 #include <fastjet/JetDefinition.hh>
 #include <fastjet/PseudoJet.hh>
@@ -68,6 +69,15 @@ class JetBkgSubUtils
   /// @return Rho, RhoM the underlying event density
   std::tuple<double, double> estimateRhoAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
 
+  /// @brief Method for estimating the jet background density for several sets of input particles of the same event
+  /// (e.g. the particles left after removing the daughters of each candidate). The ghosts are generated once and
+  /// shared by all the clusterings, so that identical sets of input particles give identical densities
+  /// @param inputParticlesSets sets of input particles
+  /// @param doSparseSub weather to do rho sparse subtraction
+  /// @param nThreads number of threads running the clusterings of the different sets, forced to 1 if FastJet is built without thread safety
+  /// @return Rho, RhoM the underlying event density for each set
+  std::vector<std::tuple<double, double>> estimateRhoAreaMedian(const std::vector<std::vector<fastjet::PseudoJet>>& inputParticlesSets, bool doSparseSub, int nThreads = 1);
+
   /// @brief method that subtracts the background from jets using the area method
   /// @param jet input jet to be background subtracted
   /// @param rhoParam the underlying evvent density vs pT (to be set)
@@ -127,6 +137,9 @@ class JetBkgSubUtils
   double getMd(fastjet::PseudoJet jet) const;
 
  protected:
+  /// @brief median of the pT and mass densities of the kT jets of a clustering with explicit ghosts
+  std::tuple<double, double> getRhoFromClusterSequence(const fastjet::ClusterSequenceAreaBase& clusterSeq, bool doSparseSub) const;
+
   float jetBkgR = 0.2;
   float bkgEtaMin = -0.9;
   float bkgEtaMax = 0.9;
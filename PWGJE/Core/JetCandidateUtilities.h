@@ -23,6 +23,7 @@
 
 #include <cstdint>
 #include <type_traits>
+#include <vector>
 
 namespace jetcandidateutilities
 {
@@ -156,6 +157,25 @@ bool isDaughterParticle(const T& particle, int globalIndex)
   return false;
 }
 
+/**
+ * appends the global indices of all the daughters of the particle, at any depth of the decay chain
+ * (i.e. all the global indices for which isDaughterParticle returns true)
+ *
+ * @param particle mother particle
+ * @param daughterIndices vector to which the global indices are appended
+ */
+template <typename T>
+void collectDaughterParticles(const T& particle, std::vector<int>& daughterIndices)
+{
+  if (!particle.has_daughters()) {
+    return;
+  }
+  for (auto daughter : particle.template daughters_as<typename std::decay_t<T>::parent_t>()) {
+    daughterIndices.push_back(daughter.globalIndex());
+    collectDaughterParticles(daughter, daughterIndices);
+  }
+}
+
 /**
  * returns the index of the JMcParticle matched to the candidate
  *
@@ -13,7 +13,9 @@
 //
 /// \author Nima Zardoshti <nima.zardoshti@cern.ch>
 
+#include "PWGJE/Core/FastJetUtilities.h"
 #include "PWGJE/Core/JetBkgSubUtils.h"
+#include "PWGJE/Core/JetCandidateUtilities.h"
 #include "PWGJE/Core/JetDerivedDataUtilities.h"
 #include "PWGJE/Core/JetFindingUtilities.h"
 #include "PWGJE/DataModel/Jet.h"
@@ -32,8 +34,11 @@
 #include <fastjet/JetDefinition.hh>
 #include <fastjet/PseudoJet.hh>
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <math.h>
@@ -86,6 +91,8 @@ struct RhoEstimatorTask {
     Configurable<double> ghostGridScatter{"ghostGridScatter", 1.0, "Grid scatter"};
     Configurable<double> ghostKtScatter{"ghostKtScatter", 0.1, "kT scatter"};
     Configurable<double> ghostMeanPt{"ghostMeanPt", 1e-100, "Mean ghost pT"};
+    Configurable<bool> batchCandidates{"batchCandidates", false, "estimate rho once per set of removed candidate daughters in a collision, with one ghost grid per collision"};
+    Configurable<int> nThreadsCandidates{"nThreadsCandidates", 1, "number of threads running the clusterings of the batched candidate rho estimation (1 if FastJet is built without thread safety)"};
 
     Configurable<float> thresholdTriggerTrackPtMin{"thresholdTriggerTrackPtMin", 0.0, "Minimum trigger track pt to accept event"};
     Configurable<float> thresholdClusterEnergyMin{"thresholdClusterEnergyMin", 0.0, "Minimum cluster energy to accept event"};
@@ -108,6 +115,15 @@ struct RhoEstimatorTask {
   float bkgPhiMax_;
   float bkgPhiMin_;
   std::vector<fastjet::PseudoJet> inputParticles;
+  // batched estimation for the candidates of a collision
+  std::vector<fastjet::PseudoJet> selectedParticles;               // candidate-independent input particles of the collision
+  std::vector<int> removedPositions;                               // positions in selectedParticles of the daughters of each candidate
+  std::vector<int> removedOffsets;                                 // range of removedPositions of each candidate
+  std::vector<int> candidateOrder;                                 // candidates sorted by removed daughters
+  std::vector<int> candidateSets;                                  // set of input particles of each candidate
+  std::vector<std::vector<fastjet::PseudoJet>> inputParticlesSets; // distinct sets of input particles
+  std::vector<int> daughterIndices;                                // global indices of the candidate particle and its daughters
+  std::vector<std::pair<int, int>> selectedIndices;                // global index and position of the selected particles
   int trackSelection = -1;
   std::string particleSelection;
 
@@ -230,292 +246,272 @@ struct RhoEstimatorTask {
   }
   PROCESS_SWITCH(RhoEstimatorTask, processChargedMcCollisions, "Fill rho tables for MC collisions using charged tracks", false);
 
-  void processD0Collisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesD0Data const& candidates)
+  template <typename T>
+  bool isCollisionSelected(T const& collision)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoD0Table(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
+    return !(!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut);
+  }
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoD0Table(rho, rhoM);
-    }
+  template <typename T>
+  bool isMcCollisionSelected(T const& mcCollision)
+  {
+    return !(!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut);
   }
-  PROCESS_SWITCH(RhoEstimatorTask, processD0Collisions, "Fill rho tables for collisions with D0 candidates", false);
 
-  void processD0McCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesD0MCP const& candidates)
+  // Groups the candidates whose removed daughters (removedPositions, removedOffsets) are the same, builds the input
+  // particles of each group from selectedParticles and estimates rho once per group, with the ghosts shared by the collision.
+  // The input particles of a candidate are the same, in the same order, as the ones built for it alone by analyseTracks / analyseParticles
+  template <typename T>
+  void estimateBatchedRhos(int nCandidates, T& rhoTable)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoD0McTable(0.0, 0.0);
-        continue;
+    auto removedOf = [this](int iCandidate) {
+      return std::make_pair(removedPositions.begin() + removedOffsets[iCandidate], removedPositions.begin() + removedOffsets[iCandidate + 1]);
+    };
+    candidateOrder.resize(nCandidates);
+    std::iota(candidateOrder.begin(), candidateOrder.end(), 0);
+    std::stable_sort(candidateOrder.begin(), candidateOrder.end(), [&removedOf](int iCandidate, int jCandidate) {
+      auto [iFirst, iLast] = removedOf(iCandidate);
+      auto [jFirst, jLast] = removedOf(jCandidate);
+      return std::lexicographical_compare(iFirst, iLast, jFirst, jLast);
+    });
+
+    candidateSets.resize(nCandidates);
+    int nSets = 0;
+    for (int iOrder = 0; iOrder < nCandidates; iOrder++) {
+      const int iCandidate = candidateOrder[iOrder];
+      auto [first, last] = removedOf(iCandidate);
+      if (iOrder > 0) {
+        auto [previousFirst, previousLast] = removedOf(candidateOrder[iOrder - 1]);
+        if (std::equal(first, last, previousFirst, previousLast)) {
+          candidateSets[iCandidate] = nSets - 1;
+          continue;
+        }
+      }
+      if (static_cast<int>(inputParticlesSets.size()) <= nSets) {
+        inputParticlesSets.emplace_back();
       }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
+      auto& inputParticlesSet = inputParticlesSets[nSets];
+      inputParticlesSet.clear();
+      for (int iParticle = 0; iParticle < static_cast<int>(selectedParticles.size()); iParticle++) {
+        if (first != last && *first == iParticle) {
+          ++first;
+          continue;
+        }
+        inputParticlesSet.push_back(selectedParticles[iParticle]);
+      }
+      candidateSets[iCandidate] = nSets++;
+    }
+    inputParticlesSets.resize(nSets);
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoD0McTable(rho, rhoM);
+    auto rhos = bkgSub.estimateRhoAreaMedian(inputParticlesSets, config.doSparse, config.nThreadsCandidates);
+    for (int iCandidate = 0; iCandidate < nCandidates; iCandidate++) {
+      auto [rho, rhoM] = rhos[candidateSets[iCandidate]];
+      rhoTable(rho, rhoM);
     }
   }
-  PROCESS_SWITCH(RhoEstimatorTask, processD0McCollisions, "Fill rho tables for collisions with D0 MCP candidates", false);
 
-  void processDplusCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDplusData const& candidates)
+  template <typename T, typename U, typename V, typename W>
+  void estimateCandidateRhos(T const& collision, U const& tracks, V const& candidates, W& rhoTable)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoDplusTable(0.0, 0.0);
-        continue;
+    if (!config.batchCandidates) {
+      for (auto& candidate : candidates) {
+        if (!isCollisionSelected(collision)) {
+          rhoTable(0.0, 0.0);
+          continue;
+        }
+        inputParticles.clear();
+        jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
+
+        auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+        rhoTable(rho, rhoM);
       }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
+      return;
+    }
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDplusTable(rho, rhoM);
+    if (!isCollisionSelected(collision)) {
+      for (int iCandidate = 0; iCandidate < candidates.size(); iCandidate++) {
+        rhoTable(0.0, 0.0);
+      }
+      return;
+    }
+    // the track selection does not depend on the candidate, only the removal of its daughters does
+    selectedParticles.clear();
+    std::vector<typename U::iterator> selectedTracks;
+    for (auto const& track : tracks) {
+      if (jetderiveddatautilities::selectTrack(track, trackSelection)) {
+        fastjetutilities::fillTracks(track, selectedParticles, track.globalIndex());
+        selectedTracks.push_back(track);
+      }
     }
+    removedPositions.clear();
+    removedOffsets.assign(1, 0);
+    for (auto const& candidate : candidates) {
+      for (int iTrack = 0; iTrack < static_cast<int>(selectedTracks.size()); iTrack++) {
+        if (jetcandidateutilities::isDaughterTrack(selectedTracks[iTrack], candidate)) {
+          removedPositions.push_back(iTrack);
+        }
+      }
+      removedOffsets.push_back(removedPositions.size());
+    }
+    estimateBatchedRhos(candidates.size(), rhoTable);
   }
-  PROCESS_SWITCH(RhoEstimatorTask, processDplusCollisions, "Fill rho tables for collisions with Dplus candidates", false);
 
-  void processDplusMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesDplusMCP const& candidates)
+  template <typename T, typename U, typename V, typename W>
+  void estimateCandidateMcRhos(T const& mcCollision, U const& particles, V const& candidates, W& rhoTable)
   {
-    for (auto& candidate : candidates) {
+    if (!config.batchCandidates) {
+      for (auto& candidate : candidates) {
+        if (!isMcCollisionSelected(mcCollision)) {
+          rhoTable(0.0, 0.0);
+          continue;
+        }
+        inputParticles.clear();
+        jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
 
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoDplusMcTable(0.0, 0.0);
-        continue;
+        auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
+        rhoTable(rho, rhoM);
       }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
+      return;
+    }
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDplusMcTable(rho, rhoM);
+    if (!isMcCollisionSelected(mcCollision)) {
+      for (int iCandidate = 0; iCandidate < candidates.size(); iCandidate++) {
+        rhoTable(0.0, 0.0);
+      }
+      return;
     }
+    // the particle selection does not depend on the candidate, only the removal of the candidate particle and its daughters does
+    selectedParticles.clear();
+    jetfindingutilities::analyseParticles<false, U, typename U::iterator>(selectedParticles, particleSelection, 1, particles, pdgDatabase);
+    selectedIndices.clear();
+    for (int iParticle = 0; iParticle < static_cast<int>(selectedParticles.size()); iParticle++) {
+      selectedIndices.emplace_back(selectedParticles[iParticle].template user_info<fastjetutilities::fastjet_user_info>().getIndex(), iParticle);
+    }
+    std::sort(selectedIndices.begin(), selectedIndices.end());
+    removedPositions.clear();
+    removedOffsets.assign(1, 0);
+    for (auto const& candidate : candidates) {
+      daughterIndices.clear();
+      daughterIndices.push_back(candidate.mcParticleId());
+      jetcandidateutilities::collectDaughterParticles(candidate.template mcParticle_as<U>(), daughterIndices);
+      for (const auto& daughterIndex : daughterIndices) {
+        auto selectedIndex = std::lower_bound(selectedIndices.begin(), selectedIndices.end(), std::make_pair(daughterIndex, 0));
+        if (selectedIndex != selectedIndices.end() && selectedIndex->first == daughterIndex) {
+          removedPositions.push_back(selectedIndex->second);
+        }
+      }
+      std::sort(removedPositions.begin() + removedOffsets.back(), removedPositions.end());
+      removedPositions.erase(std::unique(removedPositions.begin() + removedOffsets.back(), removedPositions.end()), removedPositions.end());
+      removedOffsets.push_back(removedPositions.size());
+    }
+    estimateBatchedRhos(candidates.size(), rhoTable);
+  }
+
+  void processD0Collisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesD0Data const& candidates)
+  {
+    estimateCandidateRhos(collision, tracks, candidates, rhoD0Table);
+  }
+  PROCESS_SWITCH(RhoEstimatorTask, processD0Collisions, "Fill rho tables for collisions with D0 candidates", false);
+
+  void processD0McCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesD0MCP const& candidates)
+  {
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoD0McTable);
+  }
+  PROCESS_SWITCH(RhoEstimatorTask, processD0McCollisions, "Fill rho tables for collisions with D0 MCP candidates", false);
+
+  void processDplusCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDplusData const& candidates)
+  {
+    estimateCandidateRhos(collision, tracks, candidates, rhoDplusTable);
+  }
+  PROCESS_SWITCH(RhoEstimatorTask, processDplusCollisions, "Fill rho tables for collisions with Dplus candidates", false);
+
+  void processDplusMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesDplusMCP const& candidates)
+  {
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoDplusMcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processDplusMcCollisions, "Fill rho tables for collisions with Dplus MCP candidates", false);
 
   void processDsCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDsData const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoDsTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDsTable(rho, rhoM);
-    }
+    estimateCandidateRhos(collision, tracks, candidates, rhoDsTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processDsCollisions, "Fill rho tables for collisions with Ds candidates", false);
 
   void processDsMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesDsMCP const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoDsMcTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDsMcTable(rho, rhoM);
-    }
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoDsMcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processDsMcCollisions, "Fill rho tables for collisions with Ds MCP candidates", false);
 
   void processDstarCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDstarData const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoDstarTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDstarTable(rho, rhoM);
-    }
+    estimateCandidateRhos(collision, tracks, candidates, rhoDstarTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processDstarCollisions, "Fill rho tables for collisions with Dstar candidates", false);
 
   void processDstarMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesDstarMCP const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoDstarMcTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDstarMcTable(rho, rhoM);
-    }
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoDstarMcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processDstarMcCollisions, "Fill rho tables for collisions with Dstar MCP candidates", false);
 
   void processLcCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesLcData const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoLcTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoLcTable(rho, rhoM);
-    }
+    estimateCandidateRhos(collision, tracks, candidates, rhoLcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processLcCollisions, "Fill rho tables for collisions with Lc candidates", false);
 
   void processLcMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesLcMCP const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoLcMcTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoLcMcTable(rho, rhoM);
-    }
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoLcMcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processLcMcCollisions, "Fill rho tables for collisions with Lc MCP candidates", false);
 
   void processB0Collisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesB0Data const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoB0Table(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoB0Table(rho, rhoM);
-    }
+    estimateCandidateRhos(collision, tracks, candidates, rhoB0Table);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processB0Collisions, "Fill rho tables for collisions with B0 candidates", false);
 
   void processB0McCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesB0MCP const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoB0McTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoB0McTable(rho, rhoM);
-    }
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoB0McTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processB0McCollisions, "Fill rho tables for collisions with B0 MCP candidates", false);
 
   void processBplusCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesBplusData const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoBplusTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoBplusTable(rho, rhoM);
-    }
+    estimateCandidateRhos(collision, tracks, candidates, rhoBplusTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processBplusCollisions, "Fill rho tables for collisions with Bplus candidates", false);
 
   void processBplusMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesBplusMCP const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoBplusMcTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoBplusMcTable(rho, rhoM);
-    }
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoBplusMcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processBplusMcCollisions, "Fill rho tables for collisions with Bplus MCP candidates", false);
 
   void processXicToXiPiPiCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesXicToXiPiPiData const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoXicToXiPiPiTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoXicToXiPiPiTable(rho, rhoM);
-    }
+    estimateCandidateRhos(collision, tracks, candidates, rhoXicToXiPiPiTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processXicToXiPiPiCollisions, "Fill rho tables for collisions with XicToXiPiPi candidates", false);
 
   void processXicToXiPiPiMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesXicToXiPiPiMCP const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoXicToXiPiPiMcTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoXicToXiPiPiMcTable(rho, rhoM);
-    }
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoXicToXiPiPiMcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processXicToXiPiPiMcCollisions, "Fill rho tables for collisions with XicToXiPiPi MCP candidates", false);
 
   void processDielectronCollisions(aod::JetCollision const& collision, soa::Filtered<aod::JetTracks> const& tracks, aod::CandidatesDielectronData const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(collision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || collision.centFT0M() < config.centralityMin || collision.centFT0M() >= config.centralityMax || collision.trackOccupancyInTimeRange() > config.trackOccupancyInTimeRangeMax || std::abs(collision.posZ()) > config.vertexZCut) {
-        rhoDielectronTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDielectronTable(rho, rhoM);
-    }
+    estimateCandidateRhos(collision, tracks, candidates, rhoDielectronTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processDielectronCollisions, "Fill rho tables for collisions with Dielectron candidates", false);
 
   void processDielectronMcCollisions(aod::JetMcCollision const& mcCollision, soa::Filtered<aod::JetParticles> const& particles, aod::CandidatesDielectronMCP const& candidates)
   {
-    for (auto& candidate : candidates) {
-      if (!jetderiveddatautilities::selectCollision(mcCollision, eventSelectionBits, config.skipMBGapEvents, config.applyRCTSelections) || std::abs(mcCollision.posZ()) > config.vertexZCut) {
-        rhoDielectronMcTable(0.0, 0.0);
-        continue;
-      }
-      inputParticles.clear();
-      jetfindingutilities::analyseParticles<true>(inputParticles, particleSelection, 1, particles, pdgDatabase, &candidate);
-
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, config.doSparse);
-      rhoDielectronMcTable(rho, rhoM);
-    }
+    estimateCandidateMcRhos(mcCollision, particles, candidates, rhoDielectronMcTable);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processDielectronMcCollisions, "Fill rho tables for collisions with Dielectron MCP candidates", false);
 };
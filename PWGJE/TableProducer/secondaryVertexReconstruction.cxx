@@ -43,9 +43,11 @@
 #include <ReconstructionDataFormats/Vertex.h>
 
 #include <array>
-#include <cstddef>
+#include <cstdint>
+#include <numeric>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace o2;
@@ -152,203 +154,329 @@ struct SecondaryVertexReconstruction {
   using JetTracksMCDwPIs = soa::Filtered<soa::Join<aod::JetTracksMCD, aod::JTrackPIs>>;
   using OriginalTracks = soa::Join<aod::Tracks, aod::TracksCov, aod::TrackSelection, aod::TracksDCA, aod::TracksDCACov>;
 
-  template <unsigned int numProngs, bool externalMagneticField, typename AnyCollision, typename AnyJet, typename AnyParticles>
-  void runCreatorNProng(AnyCollision const& collision,
-                        AnyJet const& analysisJet,
-                        AnyParticles const& listoftracks,
-                        std::vector<int>& svIndices,
-                        o2::vertexing::DCAFitterN<numProngs>& df,
-                        size_t prongIndex = 0,
-                        std::vector<size_t> currentCombination = {})
+  // Constituents of the jets of a collision which pass the track selection, converted once for all the jets
+  struct ProngPool {
+    std::unordered_map<int64_t, int> positions;                                // position in the pool of each jet constituent, -1 if rejected
+    std::vector<o2::track::TrackParametrizationWithError<float>> trackParCovs; // track parameters at the reference point of the track
+    std::vector<std::array<float, 3>> momenta;                                 // momenta at the reference point of the track
+    std::vector<double> energies;                                              // energies with the charged-pion mass
+    std::vector<float> pts;                                                    // transverse momenta
+    std::vector<o2::dataformats::DCA> impactParameters;                        // impact parameters w.r.t. the primary vertex, computed on first use
+    std::vector<bool> hasImpactParameters;                                     // whether the impact parameter is computed
+    o2::dataformats::VertexBase primaryVertex;                                 // primary vertex of the collision
+
+    void clear()
+    {
+      positions.clear();
+      trackParCovs.clear();
+      momenta.clear();
+      energies.clear();
+      pts.clear();
+      impactParameters.clear();
+      hasImpactParameters.clear();
+    }
+  };
+
+  // Result of the vertex fit of a combination of prongs, shared by all the jets containing the combination
+  struct SecondaryVertexFit {
+    bool isAccepted{false}; // fit converged and vertex within maxRsv, maxZsv
+    std::array<float, 3> secondaryVertex{};
+    float chi2PCA{0.f};
+    std::array<float, 6> covMatrixPCA{};
+    float dispersion{0.f};
+  };
+
+  ProngPool prongPool;
+  std::unordered_map<uint64_t, SecondaryVertexFit> svFitCache; // fits of the collision, keyed by the pool positions of the prongs
+  std::vector<int> jetProngs;                                  // pool positions of the selected constituents of a jet
+
+  /// Fills the prong pool with the constituents of the jets of a collision and resets the fit cache
+  template <typename AnyParticles, typename AnyCollision, typename AnyJets>
+  void fillProngPool(AnyCollision const& collision, AnyJets const& jets)
   {
+    prongPool.clear();
+    svFitCache.clear();
+    prongPool.primaryVertex = getPrimaryVertex(collision);
+    for (const auto& jet : jets) {
+      for (const auto& particle : jet.template tracks_as<AnyParticles>()) {
+        auto [position, isNew] = prongPool.positions.try_emplace(particle.globalIndex(), -1);
+        if (!isNew) {
+          continue;
+        }
+        const auto& track = particle.template track_as<OriginalTracks>();
+        if (track.pt() < ptMinTrack || track.eta() < etaMinTrack || track.eta() > etaMaxTrack || std::abs(track.dcaXY()) > maxIPxy || std::abs(track.dcaZ()) > maxIPz) {
+          continue;
+        }
+        position->second = prongPool.trackParCovs.size();
+        auto trackParCov = getTrackParCov(track);
+        std::array<float, 3> momentum{};
+        trackParCov.getPxPyPzGlo(momentum);
+        prongPool.trackParCovs.push_back(trackParCov);
+        prongPool.momenta.push_back(momentum);
+        prongPool.energies.push_back(track.energy(o2::constants::physics::MassPiPlus));
+        prongPool.pts.push_back(track.pt());
+        prongPool.impactParameters.emplace_back();
+        prongPool.hasImpactParameters.push_back(false);
+      }
+    }
+  }
 
-    const auto& particles = analysisJet.template tracks_as<AnyParticles>();
+  /// Impact parameter of a prong of the pool w.r.t. the primary vertex
+  const o2::dataformats::DCA& getImpactParameter(int position)
+  {
+    if (!prongPool.hasImpactParameters[position]) {
+      auto trackParCov = prongPool.trackParCovs[position];
+      trackParCov.propagateToDCA(prongPool.primaryVertex, bz, &prongPool.impactParameters[position]);
+      prongPool.hasImpactParameters[position] = true;
+    }
+    return prongPool.impactParameters[position];
+  }
 
-    if (currentCombination.size() == numProngs) {
-      // Create an array of track parameters and covariance matrices for the current combination
-      std::array<o2::track::TrackParametrizationWithError<float>, numProngs> trackParVars;
-      double energySV = 0.;
-      for (unsigned int inum = 0; inum < numProngs; ++inum) {
-        const auto& prong = particles[currentCombination[inum]].template track_as<OriginalTracks>();
-        energySV += prong.energy(o2::constants::physics::MassPiPlus);
-        trackParVars[inum] = getTrackParCov(prong);
+  template <bool externalMagneticField, typename AnyCollision>
+  void updateMagneticField(AnyCollision const& collision)
+  {
+    if constexpr (externalMagneticField) {
+      bz = magneticField;
+    } else {
+      auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
+      if (runNumber != bc.runNumber()) {
+        initCCDB(bc, runNumber, ccdb, ccdbPathGrpMag, lut, false);
+        bz = o2::base::Propagator::Instance()->getNominalBz();
       }
+    }
+  }
 
-      if constexpr (externalMagneticField) {
-        bz = magneticField;
-      } else {
-        auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-        if (runNumber != bc.runNumber()) {
-          initCCDB(bc, runNumber, ccdb, ccdbPathGrpMag, lut, false);
-          bz = o2::base::Propagator::Instance()->getNominalBz();
-        }
-      }
+  /// Fits the secondary vertex of a combination of prongs of the pool, or returns the fit of the combination if already done
+  template <unsigned int numProngs>
+  const SecondaryVertexFit& fitSecondaryVertex(std::array<int, numProngs> const& prongs, o2::vertexing::DCAFitterN<numProngs>& df)
+  {
+    uint64_t key = numProngs;
+    for (const auto& prong : prongs) {
+      key = (key << 20) | static_cast<uint64_t>(prong);
+    }
+    auto [cached, isNew] = svFitCache.try_emplace(key);
+    auto& fit = cached->second;
+    if (!isNew) {
+      return fit;
+    }
 
-      // Use a different fitter depending on the number of prongs
-      df.setBz(bz);
+    // Create an array of track parameters and covariance matrices for the current combination
+    std::array<o2::track::TrackParametrizationWithError<float>, numProngs> trackParVars;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      trackParVars[inum] = prongPool.trackParCovs[prongs[inum]];
+    }
 
-      // Reconstruct the secondary vertex
-      int processResult = 0;
-      try {
-        std::apply([&df, &processResult](const auto&... elems) { processResult = df.process(elems...); }, trackParVars);
-      } catch (const std::runtime_error& error) {
-        LOG(info) << "Run time error found: " << error.what() << ". DCAFitterN cannot work, skipping the candidate.";
-        return;
-      }
-      if (processResult == 0) {
-        return;
-      }
+    // Use a different fitter depending on the number of prongs
+    df.setBz(bz);
+
+    // Reconstruct the secondary vertex
+    int processResult = 0;
+    try {
+      std::apply([&df, &processResult](const auto&... elems) { processResult = df.process(elems...); }, trackParVars);
+    } catch (const std::runtime_error& error) {
+      LOG(info) << "Run time error found: " << error.what() << ". DCAFitterN cannot work, skipping the candidate.";
+      return fit;
+    }
+    if (processResult == 0) {
+      return fit;
+    }
 
-      const auto& secondaryVertex = df.getPCACandidatePos();
-      if (std::sqrt(secondaryVertex[0] * secondaryVertex[0] + secondaryVertex[1] * secondaryVertex[1]) > maxRsv || std::abs(secondaryVertex[2]) > maxZsv) {
-        return;
+    const auto& secondaryVertex = df.getPCACandidatePos();
+    if (std::sqrt(secondaryVertex[0] * secondaryVertex[0] + secondaryVertex[1] * secondaryVertex[1]) > maxRsv || std::abs(secondaryVertex[2]) > maxZsv) {
+      return fit;
+    }
+
+    float dispersion = 0.;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      o2::dataformats::VertexBase sv(o2::math_utils::Point3D<float>{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}, std::array<float, 6>{0});
+      o2::dataformats::DCA dcaSV;
+      auto& prong = df.getTrack(inum);
+      prong.propagateToDCA(sv, bz, &dcaSV);
+      dispersion += (dcaSV.getY() * dcaSV.getY() + dcaSV.getZ() * dcaSV.getZ());
+    }
+    fit.dispersion = std::sqrt(dispersion / numProngs);
+    fit.secondaryVertex = secondaryVertex;
+    fit.chi2PCA = df.getChi2AtPCACandidate();
+    fit.covMatrixPCA = df.calcPCACovMatrixFlat();
+    fit.isAccepted = true;
+    return fit;
+  }
+
+  template <unsigned int numProngs, bool externalMagneticField, typename AnyCollision, typename AnyJet, typename AnyParticles>
+  void runCreatorNProng(AnyCollision const& collision,
+                        AnyJet const& analysisJet,
+                        AnyParticles const& /*listoftracks*/,
+                        std::vector<int>& svIndices,
+                        o2::vertexing::DCAFitterN<numProngs>& df)
+  {
+    // selected constituents, in the order of the jet constituents
+    jetProngs.clear();
+    for (const auto& particle : analysisJet.template tracks_as<AnyParticles>()) {
+      const int position = prongPool.positions.at(particle.globalIndex());
+      if (position >= 0) {
+        jetProngs.push_back(position);
       }
+    }
+    const int nJetProngs = jetProngs.size();
+    const int nProngs = numProngs;
+    if (nJetProngs < nProngs) {
+      return;
+    }
+
+    updateMagneticField<externalMagneticField>(collision);
+
+    const auto& primaryVertex = prongPool.primaryVertex;
+    auto covMatrixPV = primaryVertex.getCov();
 
-      float dispersion = 0.;
-      for (unsigned int inum = 0; inum < numProngs; ++inum) {
-        o2::dataformats::VertexBase sv(o2::math_utils::Point3D<float>{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}, std::array<float, 6>{0});
-        o2::dataformats::DCA dcaSV;
-        auto& prong = df.getTrack(inum);
-        prong.propagateToDCA(sv, bz, &dcaSV);
-        dispersion += (dcaSV.getY() * dcaSV.getY() + dcaSV.getZ() * dcaSV.getZ());
+    // loop over the combinations of prongs in lexicographic order
+    std::array<int, numProngs> combination{};
+    std::iota(combination.begin(), combination.end(), 0);
+    std::array<int, numProngs> prongs{};
+    while (true) {
+      for (int inum = 0; inum < nProngs; ++inum) {
+        prongs[inum] = jetProngs[combination[inum]];
       }
-      dispersion = std::sqrt(dispersion / numProngs);
-
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
-
-      // get track impact parameters
-      // This modifies track momenta!
-      auto primaryVertex = getPrimaryVertex(collision);
-      auto covMatrixPV = primaryVertex.getCov();
-
-      // Get track momenta and impact parameters
-      std::array<std::array<float, 3>, numProngs> arrayMomenta{};
-      std::array<o2::dataformats::DCA, numProngs> impactParameters;
-      for (unsigned int inum = 0; inum < numProngs; ++inum) {
-        trackParVars[inum].getPxPyPzGlo(arrayMomenta[inum]);
-        trackParVars[inum].propagateToDCA(primaryVertex, bz, &impactParameters[inum]);
-
-        if (fillHistograms) {
-          const auto& prong = particles[currentCombination[inum]].template track_as<OriginalTracks>();
-          registry.fill(HIST("hDcaXYNProngs"), prong.pt(), impactParameters[inum].getY() * toMicrometers, numProngs);
-          registry.fill(HIST("hDcaZNProngs"), prong.pt(), impactParameters[inum].getZ() * toMicrometers, numProngs);
-        }
+      const auto& fit = fitSecondaryVertex<numProngs>(prongs, df);
+      if (fit.isAccepted) {
+        fillSecondaryVertex<numProngs>(analysisJet, prongs, fit, primaryVertex, covMatrixPV, svIndices);
       }
 
-      // get uncertainty of the decay length
-      double phi, theta;
-      getPointDirection(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, secondaryVertex, phi, theta);
-      auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-      auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-      // calculate invariant mass
-      std::array<double, numProngs> massArray{};
-      std::fill(massArray.begin(), massArray.end(), o2::constants::physics::MassPiPlus);
-      double massSV = RecoDecay::m(arrayMomenta, massArray);
-
-      // calculate momentum
-      double xMomenta = -1;
-      double yMomenta = -1;
-      double zMomenta = -1;
-      if (numProngs == ThreeProngCount) {
-        xMomenta = arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0];
-        yMomenta = arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1];
-        zMomenta = arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2];
-      } else if (numProngs == TwoProngCount) {
-        xMomenta = arrayMomenta[0][0] + arrayMomenta[1][0];
-        yMomenta = arrayMomenta[0][1] + arrayMomenta[1][1];
-        zMomenta = arrayMomenta[0][2] + arrayMomenta[1][2];
-      } else {
-        LOG(error) << "No process momenta\n";
+      int iLast = nProngs - 1;
+      while (iLast >= 0 && combination[iLast] == nJetProngs - nProngs + iLast) {
+        --iLast;
       }
-
-      // fill candidate table rows
-      if ((doprocessData3Prongs || doprocessData3ProngsExternalMagneticField) && numProngs == ThreeProngCount) {
-        sv3prongTableData(analysisJet.globalIndex(),
-                          primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                          secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                          xMomenta,
-                          yMomenta,
-                          zMomenta,
-                          energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv3prongTableData.lastIndex());
-      } else if ((doprocessData2Prongs || doprocessData2ProngsExternalMagneticField) && numProngs == TwoProngCount) {
-        sv2prongTableData(analysisJet.globalIndex(),
-                          primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                          secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                          xMomenta,
-                          yMomenta,
-                          zMomenta,
-                          energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv2prongTableData.lastIndex());
-      } else if ((doprocessDataNProngs || doprocessDataNProngsExternalMagneticField)) {
-        svnprongTableData(analysisJet.globalIndex(),
-                          primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                          secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                          xMomenta,
-                          yMomenta,
-                          zMomenta,
-                          energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(svnprongTableData.lastIndex());
-      } else if ((doprocessMCD3Prongs || doprocessMCD3ProngsExternalMagneticField) && numProngs == ThreeProngCount) {
-        sv3prongTableMCD(analysisJet.globalIndex(),
-                         primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                         secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                         xMomenta,
-                         yMomenta,
-                         zMomenta,
-                         energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv3prongTableMCD.lastIndex());
-      } else if ((doprocessMCD2Prongs || doprocessMCD2ProngsExternalMagneticField) && numProngs == TwoProngCount) {
-        sv2prongTableMCD(analysisJet.globalIndex(),
-                         primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                         secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                         xMomenta,
-                         yMomenta,
-                         zMomenta,
-                         energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv2prongTableMCD.lastIndex());
-      } else if (doprocessMCDNProngs || doprocessMCDNProngsExternalMagneticField) {
-        svnprongTableMCD(analysisJet.globalIndex(),
-                         primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                         secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                         xMomenta,
-                         yMomenta,
-                         zMomenta,
-                         energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(svnprongTableMCD.lastIndex());
-      } else {
-        LOG(error) << "No process specified\n";
+      if (iLast < 0) {
+        break;
       }
+      ++combination[iLast];
+      for (int inum = iLast + 1; inum < nProngs; ++inum) {
+        combination[inum] = combination[inum - 1] + 1;
+      }
+    }
+  }
 
-      // fill histograms
+  template <unsigned int numProngs, typename AnyJet>
+  void fillSecondaryVertex(AnyJet const& analysisJet,
+                           std::array<int, numProngs> const& prongs,
+                           SecondaryVertexFit const& fit,
+                           o2::dataformats::VertexBase const& primaryVertex,
+                           std::array<float, 6> const& covMatrixPV,
+                           std::vector<int>& svIndices)
+  {
+    const auto& secondaryVertex = fit.secondaryVertex;
+    const auto& covMatrixPCA = fit.covMatrixPCA;
+    auto chi2PCA = fit.chi2PCA;
+    auto dispersion = fit.dispersion;
+
+    // Get track momenta and impact parameters
+    double energySV = 0.;
+    std::array<std::array<float, 3>, numProngs> arrayMomenta{};
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      energySV += prongPool.energies[prongs[inum]];
+      arrayMomenta[inum] = prongPool.momenta[prongs[inum]];
       if (fillHistograms) {
-        double decayLengthNormalised = RecoDecay::distance(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, std::array{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}) / errorDecayLength;
-        double decayLengthXYNormalised = RecoDecay::distanceXY(std::array{primaryVertex.getX(), primaryVertex.getY()}, std::array{secondaryVertex[0], secondaryVertex[1]}) / errorDecayLengthXY;
-
-        registry.fill(HIST("hDispersion"), dispersion, numProngs);
-        registry.fill(HIST("hMassNProngs"), massSV, numProngs);
-        registry.fill(HIST("hLxySNProngs"), decayLengthXYNormalised, numProngs);
-        registry.fill(HIST("hLSNProngs"), decayLengthNormalised, numProngs);
-        registry.fill(HIST("hFeNProngs"), energySV / analysisJet.energy() > 1. ? 0.99 : energySV / analysisJet.energy(), numProngs);
+        const auto& impactParameter = getImpactParameter(prongs[inum]);
+        registry.fill(HIST("hDcaXYNProngs"), prongPool.pts[prongs[inum]], impactParameter.getY() * toMicrometers, numProngs);
+        registry.fill(HIST("hDcaZNProngs"), prongPool.pts[prongs[inum]], impactParameter.getZ() * toMicrometers, numProngs);
       }
-
-      return;
     }
 
-    // Recursive call to explore all combinations
-    for (size_t iprong = prongIndex; iprong < particles.size(); ++iprong) {
+    // get uncertainty of the decay length
+    double phi, theta;
+    getPointDirection(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, secondaryVertex, phi, theta);
+    auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
+    auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
+
+    // calculate invariant mass
+    std::array<double, numProngs> massArray{};
+    std::fill(massArray.begin(), massArray.end(), o2::constants::physics::MassPiPlus);
+    double massSV = RecoDecay::m(arrayMomenta, massArray);
+
+    // calculate momentum
+    double xMomenta = -1;
+    double yMomenta = -1;
+    double zMomenta = -1;
+    if (numProngs == ThreeProngCount) {
+      xMomenta = arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0];
+      yMomenta = arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1];
+      zMomenta = arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2];
+    } else if (numProngs == TwoProngCount) {
+      xMomenta = arrayMomenta[0][0] + arrayMomenta[1][0];
+      yMomenta = arrayMomenta[0][1] + arrayMomenta[1][1];
+      zMomenta = arrayMomenta[0][2] + arrayMomenta[1][2];
+    } else {
+      LOG(error) << "No process momenta\n";
+    }
 
-      const auto& testTrack = particles[iprong].template track_as<OriginalTracks>();
-      if (testTrack.pt() < ptMinTrack || testTrack.eta() < etaMinTrack || testTrack.eta() > etaMaxTrack || std::abs(testTrack.dcaXY()) > maxIPxy || std::abs(testTrack.dcaZ()) > maxIPz) {
-        continue;
-      }
+    // fill candidate table rows
+    if ((doprocessData3Prongs || doprocessData3ProngsExternalMagneticField) && numProngs == ThreeProngCount) {
+      sv3prongTableData(analysisJet.globalIndex(),
+                        primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                        secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                        xMomenta,
+                        yMomenta,
+                        zMomenta,
+                        energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv3prongTableData.lastIndex());
+    } else if ((doprocessData2Prongs || doprocessData2ProngsExternalMagneticField) && numProngs == TwoProngCount) {
+      sv2prongTableData(analysisJet.globalIndex(),
+                        primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                        secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                        xMomenta,
+                        yMomenta,
+                        zMomenta,
+                        energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv2prongTableData.lastIndex());
+    } else if ((doprocessDataNProngs || doprocessDataNProngsExternalMagneticField)) {
+      svnprongTableData(analysisJet.globalIndex(),
+                        primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                        secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                        xMomenta,
+                        yMomenta,
+                        zMomenta,
+                        energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(svnprongTableData.lastIndex());
+    } else if ((doprocessMCD3Prongs || doprocessMCD3ProngsExternalMagneticField) && numProngs == ThreeProngCount) {
+      sv3prongTableMCD(analysisJet.globalIndex(),
+                       primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                       secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                       xMomenta,
+                       yMomenta,
+                       zMomenta,
+                       energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv3prongTableMCD.lastIndex());
+    } else if ((doprocessMCD2Prongs || doprocessMCD2ProngsExternalMagneticField) && numProngs == TwoProngCount) {
+      sv2prongTableMCD(analysisJet.globalIndex(),
+                       primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                       secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                       xMomenta,
+                       yMomenta,
+                       zMomenta,
+                       energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv2prongTableMCD.lastIndex());
+    } else if (doprocessMCDNProngs || doprocessMCDNProngsExternalMagneticField) {
+      svnprongTableMCD(analysisJet.globalIndex(),
+                       primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                       secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                       xMomenta,
+                       yMomenta,
+                       zMomenta,
+                       energySV, massSV, chi2PCA, dispersion, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(svnprongTableMCD.lastIndex());
+    } else {
+      LOG(error) << "No process specified\n";
+    }
 
-      currentCombination.push_back(iprong);
-      runCreatorNProng<numProngs, externalMagneticField>(
-        collision, analysisJet, listoftracks, svIndices, df, iprong + 1, currentCombination);
-      currentCombination.pop_back();
+    // fill histograms
+    if (fillHistograms) {
+      double decayLengthNormalised = RecoDecay::distance(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, std::array{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}) / errorDecayLength;
+      double decayLengthXYNormalised = RecoDecay::distanceXY(std::array{primaryVertex.getX(), primaryVertex.getY()}, std::array{secondaryVertex[0], secondaryVertex[1]}) / errorDecayLengthXY;
+
+      registry.fill(HIST("hDispersion"), dispersion, numProngs);
+      registry.fill(HIST("hMassNProngs"), massSV, numProngs);
+      registry.fill(HIST("hLxySNProngs"), decayLengthXYNormalised, numProngs);
+      registry.fill(HIST("hLSNProngs"), decayLengthNormalised, numProngs);
+      registry.fill(HIST("hFeNProngs"), energySV / analysisJet.energy() > 1. ? 0.99 : energySV / analysisJet.energy(), numProngs);
     }
   }
 
@@ -359,6 +487,7 @@ struct SecondaryVertexReconstruction {
 
   void processData3Prongs(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets, JetTracksData const& tracks, OriginalTracks const& /*tracks*/, aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    fillProngPool<JetTracksData>(collision.template collision_as<aod::Collisions>(), jets);
     for (const auto& jet : jets) {
       std::vector<int> svIndices;
       runCreatorNProng<3, false>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df3);
@@ -369,6 +498,7 @@ struct SecondaryVertexReconstruction {
 
   void processData3ProngsExternalMagneticField(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets, JetTracksData const& tracks, OriginalTracks const& /*tracks*/)
   {
+    fillProngPool<JetTracksData>(collision.template collision_as<aod::Collisions>(), jets);
     for (const auto& jet : jets) {
       std::vector<int> svIndices;
       runCreatorNProng<3, true>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df3);
@@ -379,6 +509,7 @@ struct SecondaryVertexReconstruction {
 
   void processData2Prongs(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets, JetTracksData const& tracks, OriginalTracks const& /*tracks*/, aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    fillProngPool<JetTracksData>(collision.template collision_as<aod::Collisions>(), jets);
     for (const auto& jet : jets) {
       std::vector<int> svIndices;
       runCreatorNProng<2, false>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df2);
@@ -389,6 +520,7 @@ struct SecondaryVertexReconstruction {
 
   void processData2ProngsExternalMagneticField(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets, JetTracksData const& tracks, OriginalTracks const& /*tracks*/)
   {
+    fillProngPool<JetTracksData>(collision.template collision_as<aod::Collisions>(), jets);
     for (const auto& jet : jets) {
       std::vector<int> svIndices;
       runCreatorNProng<2, true>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df2);
@@ -399,6 +531,7 @@ struct SecondaryVertexReconstruction {
 
   void processDataNProngs(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets, JetTracksData const& tracks, OriginalTracks const& /*tracks*/, aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    fillProngPool<JetTracksData>(collision.template collision_as<aod::Collisions>(), jets);
     for (const auto& jet : jets) {
       std::vector<int> svIndices;
       if (nProng == ThreeProngCount) {
@@ -416,6 +549,7 @@ struct SecondaryVertexReconstruction {
 
   void processDataNProngsExternalMagneticField(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets, JetTracksData const& tracks, OriginalTracks const& /*tracks*/)
   {
+    fillProngPool<JetTracksData>(collision.template collision_as<aod::Collisions>(), jets);
     for (const auto& jet : jets) {
       std::vector<int> svIndices;
       if (nProng == ThreeProngCount) {
@@ -433,6 +567,7 @@ struct SecondaryVertexReconstruction {
 
   void processMCD3Prongs(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents> const& mcdjets, JetTracksMCDwPIs const& tracks, OriginalTracks const& /*tracks*/, aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    fillProngPool<JetTracksMCDwPIs>(collision.template collision_as<aod::Collisions>(), mcdjets);
     for (const auto& jet : mcdjets) {
       std::vector<int> svIndices;
       runCreatorNProng<3, false>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df3);
@@ -443,6 +578,7 @@ struct SecondaryVertexReconstruction {
 
   void processMCD3ProngsExternalMagneticField(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents> const& mcdjets, JetTracksMCDwPIs const& tracks, OriginalTracks const& /*tracks*/)
   {
+    fillProngPool<JetTracksMCDwPIs>(collision.template collision_as<aod::Collisions>(), mcdjets);
     for (const auto& jet : mcdjets) {
       std::vector<int> svIndices;
       runCreatorNProng<3, true>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df3);
@@ -453,6 +589,7 @@ struct SecondaryVertexReconstruction {
 
   void processMCD2Prongs(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents> const& mcdjets, JetTracksMCDwPIs const& tracks, OriginalTracks const& /*tracks*/, aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    fillProngPool<JetTracksMCDwPIs>(collision.template collision_as<aod::Collisions>(), mcdjets);
     for (const auto& jet : mcdjets) {
       std::vector<int> svIndices;
       runCreatorNProng<2, false>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df2);
@@ -463,6 +600,7 @@ struct SecondaryVertexReconstruction {
 
   void processMCD2ProngsExternalMagneticField(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents> const& mcdjets, JetTracksMCDwPIs const& tracks, OriginalTracks const& /*tracks*/)
   {
+    fillProngPool<JetTracksMCDwPIs>(collision.template collision_as<aod::Collisions>(), mcdjets);
     for (const auto& jet : mcdjets) {
       std::vector<int> svIndices;
       runCreatorNProng<2, true>(collision.template collision_as<aod::Collisions>(), jet, tracks, svIndices, df2);
@@ -473,6 +611,7 @@ struct SecondaryVertexReconstruction {
 
   void processMCDNProngs(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents> const& mcdjets, JetTracksMCDwPIs const& tracks, OriginalTracks const& /*tracks*/, aod::BCsWithTimestamps const& /*bcWithTimeStamps*/)
   {
+    fillProngPool<JetTracksMCDwPIs>(collision.template collision_as<aod::Collisions>(), mcdjets);
     for (const auto& jet : mcdjets) {
       std::vector<int> svIndices;
       if (nProng == ThreeProngCount) {
@@ -490,6 +629,7 @@ struct SecondaryVertexReconstruction {
 
   void processMCDNProngsExternalMagneticField(JetCollisionwPIs::iterator const& collision, aod::Collisions const& /*realColl*/, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents> const& mcdjets, JetTracksMCDwPIs const& tracks, OriginalTracks const& /*tracks*/)
   {
+    fillProngPool<JetTracksMCDwPIs>(collision.template collision_as<aod::Collisions>(), mcdjets);
     for (const auto& jet : mcdjets) {
       std::vector<int> svIndices;
       if (nProng == ThreeProngCount) {
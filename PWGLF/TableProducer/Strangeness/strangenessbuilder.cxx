@@ -363,6 +363,9 @@ struct StrangenessBuilder {
 
   Configurable<int> mc_findableMode{"mc_findableMode", 0, "0: disabled; 1: add findable-but-not-found to existing V0s from AO2D; 2: reset V0s and generate only findable-but-not-found"};
 
+  // reuse daughter DCA-to-PV propagations across V0s and cascades sharing a track
+  Configurable<bool> useDCAToPVCache{"useDCAToPVCache", false, "cache daughter DCA to PV per (track, collision) within a dataframe. False (default): propagate again; true: save CPU, use more RAM"};
+
   // Autoconfigure process functions
   Configurable<bool> autoConfigureProcess{"autoConfigureProcess", false, "if true, will configure process function switches based on metadata"};
 
@@ -600,6 +603,9 @@ struct StrangenessBuilder {
   // for tagging V0s used in cascades
   std::vector<o2::pwglf::v0candidate> v0sFromCascades; // Vector of v0 candidates used in cascades
   std::vector<int> ao2dV0toV0List;                     // index to relate v0s -> v0List
+  o2::pwglf::V0groupList v0tableGrouped;               // V0s grouped by (pos, neg) track for de-duplication
+  o2::pwglf::TrackComboIndex findableV0Index;          // (pos, neg) -> V0 lookup for MC findable mode
+  o2::pwglf::TrackComboIndex findableCascadeIndex;     // (pos, neg, bach) -> cascade lookup for MC findable mode
   std::vector<int> v0Map;                              // index to relate v0List -> v0sFromCascades
 
   void init(InitContext& context)
@@ -797,6 +803,8 @@ struct StrangenessBuilder {
     straHelper.cascadeselections.lambdaMassWindow = cascadeBuilderOpts.lambdaMassWindow;
     straHelper.cascadeselections.maxDaughterEta = cascadeBuilderOpts.maxDaughterEta;
 
+    straHelper.useDCAToPVCache = useDCAToPVCache.value;
+
     // Loading BDT model
     if (DeduplicationOpts.deduplicationAlgorithm.value == 4 || DeduplicationOpts.deduplicationAlgorithm.value == 6) {
       if (DeduplicationOpts.loadModelsFromCCDB) {
@@ -872,7 +880,7 @@ struct StrangenessBuilder {
   //_______________________________________________________________________
   // Process duplicated photons
   template <class TBCs, typename TCollisions, typename TTracks>
-  std::vector<V0DuplicateExtra> processDuplicates(TCollisions const& collisions, TTracks const& tracks, std::vector<o2::pwglf::V0group> V0Grouped, size_t iV0)
+  std::vector<V0DuplicateExtra> processDuplicates(TCollisions const& collisions, TTracks const& tracks, o2::pwglf::V0groupList const& V0Grouped, size_t iV0)
   {
     auto pTrack = tracks.rawIteratorAt(V0Grouped[iV0].posTrackId);
     auto nTrack = tracks.rawIteratorAt(V0Grouped[iV0].negTrackId);
@@ -1199,7 +1207,7 @@ struct StrangenessBuilder {
         // handle duplicates explicitly: group V0s according to (p,n) indices
         // will provide a list of collisionIds (in V0group), allowing for
         // easy de-duplication when passing to the v0List
-        std::vector<o2::pwglf::V0group> v0tableGrouped = o2::pwglf::groupDuplicates(v0s);
+        o2::pwglf::groupDuplicates(v0s, v0tableGrouped);
         histos.fill(HIST("hDeduplicationStatistics"), 0.0, v0s.size());
         histos.fill(HIST("hDeduplicationStatistics"), 1.0, v0tableGrouped.size());
 
@@ -1312,24 +1320,34 @@ struct StrangenessBuilder {
           }
         }
 
-        // Nested loop only with valuable tracks
+        // group negative tracks by originating particle (stable: pairing order is preserved)
+        std::ranges::stable_sort(negativeTrackArray, {}, &trackEntry::originId);
+
+        // index V0s by (pos, neg) once instead of searching them for every findable pair
+        findableV0Index.clear();
+        if (mc_findableMode.value == 1) {
+          for (int ii = 0; ii < v0ListReconstructedSize; ii++) {
+            findableV0Index.addV0(v0List[ii].posTrackId, v0List[ii].negTrackId, ii);
+          }
+        }
+        if (mc_findableMode.value == 2) {
+          int v0Row = 0;
+          for (const auto& v0 : v0s) {
+            findableV0Index.addV0(v0.posTrackId(), v0.negTrackId(), v0Row++);
+          }
+        }
+
+        // pair valuable tracks sharing the same originating particle
         for (const auto& positiveTrackIndex : positiveTrackArray) {
-          for (const auto& negativeTrackIndex : negativeTrackArray) {
-            if (positiveTrackIndex.originId != negativeTrackIndex.originId) {
-              continue; // not the same originating particle
-            }
+          for (const auto& negativeTrackIndex : std::ranges::equal_range(negativeTrackArray, positiveTrackIndex.originId, {}, &trackEntry::originId)) {
             // findable mode 1: add non-reconstructed as v0Type 8
             if (mc_findableMode.value == 1) {
-              bool detected = false;
-              for (int ii = 0; ii < v0ListReconstructedSize; ii++) {
-                // check if this particular combination already exists in v0List
-                if (v0List[ii].posTrackId == positiveTrackIndex.globalId &&
-                    v0List[ii].negTrackId == negativeTrackIndex.globalId) {
-                  detected = true;
-                  // override pdg code with something useful for cascade findable math
-                  v0List[ii].pdgCode = positiveTrackIndex.pdgCode;
-                  break;
-                }
+              // check if this particular combination already exists in v0List
+              int existingV0 = findableV0Index.findV0(positiveTrackIndex.globalId, negativeTrackIndex.globalId);
+              bool detected = existingV0 >= 0;
+              if (detected) {
+                // override pdg code with something useful for cascade findable math
+                v0List[existingV0].pdgCode = positiveTrackIndex.pdgCode;
               }
               if (detected == false) {
                 // collision index: from best-version-of-this-mcCollision
@@ -1368,17 +1386,15 @@ struct StrangenessBuilder {
                 currentV0Entry.isCollinearV0 = true;
               }
               currentV0Entry.found = false;
-              for (const auto& v0 : v0s) {
-                if (v0.posTrackId() == positiveTrackIndex.globalId &&
-                    v0.negTrackId() == negativeTrackIndex.globalId) {
-                  // this will override type, but not collision index
-                  // N.B.: collision index checks still desirable!
-                  currentV0Entry.globalId = v0.globalIndex();
-                  currentV0Entry.v0Type = v0.v0Type();
-                  currentV0Entry.isCollinearV0 = v0.isCollinearV0();
-                  currentV0Entry.found = true;
-                  break;
-                }
+              int existingV0 = findableV0Index.findV0(positiveTrackIndex.globalId, negativeTrackIndex.globalId);
+              if (existingV0 >= 0) {
+                auto const& v0 = v0s.rawIteratorAt(existingV0);
+                // this will override type, but not collision index
+                // N.B.: collision index checks still desirable!
+                currentV0Entry.globalId = v0.globalIndex();
+                currentV0Entry.v0Type = v0.v0Type();
+                currentV0Entry.isCollinearV0 = v0.isCollinearV0();
+                currentV0Entry.found = true;
               }
               if (v0BuilderOpts.mc_findableDetachedV0.value || currentV0Entry.collisionId >= 0) {
                 v0List.push_back(currentV0Entry);
@@ -1459,6 +1475,25 @@ struct StrangenessBuilder {
             bachelorTrackArray.push_back(currentTrackEntry);
           }
 
+          // group bachelor tracks by originating particle (stable: pairing order is preserved)
+          std::ranges::stable_sort(bachelorTrackArray, {}, &trackEntry::originId);
+
+          // index cascades by (pos, neg, bachelor) once instead of searching them for every findable triplet
+          // caution: use track indices (immutable) but not V0 indices (re-indexing)
+          findableCascadeIndex.clear();
+          if (mc_findableMode.value == 1) {
+            for (size_t ii = 0; ii < cascadeListReconstructedSize; ii++) {
+              findableCascadeIndex.addCascade(cascadeList[ii].posTrackId, cascadeList[ii].negTrackId, cascadeList[ii].bachTrackId, ii);
+            }
+          }
+          if (mc_findableMode.value == 2) {
+            int cascadeRow = 0;
+            for (const auto& cascade : cascades) {
+              auto const& v0fromAOD = cascade.v0();
+              findableCascadeIndex.addCascade(v0fromAOD.posTrackId(), v0fromAOD.negTrackId(), cascade.bachelorId(), cascadeRow++);
+            }
+          }
+
           // determine which V0s are of interest to pair and do pairing
           for (size_t v0i = 0; v0i < v0List.size(); v0i++) {
             auto v0 = v0List[sorted_v0[v0i]];
@@ -1488,24 +1523,12 @@ struct StrangenessBuilder {
             if (std::abs(v0OriginParticle.pdgCode()) != 3312 && std::abs(v0OriginParticle.pdgCode()) != 3334) {
               continue; // this V0 does not come from any particle of interest, don't try
             }
-            for (const auto& bachelorTrackIndex : bachelorTrackArray) {
-              if (bachelorTrackIndex.originId != v0OriginParticle.globalIndex()) {
-                continue;
-              }
+            for (const auto& bachelorTrackIndex : std::ranges::equal_range(bachelorTrackArray, static_cast<int>(v0OriginParticle.globalIndex()), {}, &trackEntry::originId)) {
               // if we are here: v0 origin is 3312 or 3334, bachelor origin matches V0 origin
               // findable mode 1: add non-reconstructed as cascadeType 1
               if (mc_findableMode.value == 1) {
-                bool detected = false;
-                for (size_t ii = 0; ii < cascadeListReconstructedSize; ii++) {
-                  // check if this particular combination already exists in cascadeList
-                  // caution: use track indices (immutable) but not V0 indices (re-indexing)
-                  if (cascadeList[ii].posTrackId == v0.posTrackId &&
-                      cascadeList[ii].negTrackId == v0.negTrackId &&
-                      cascadeList[ii].bachTrackId == bachelorTrackIndex.globalId) {
-                    detected = true;
-                    break;
-                  }
-                }
+                // check if this particular combination already exists in cascadeList
+                bool detected = findableCascadeIndex.findCascade(v0.posTrackId, v0.negTrackId, bachelorTrackIndex.globalId) >= 0;
                 if (detected == false) {
                   // collision index: from best-version-of-this-mcCollision
                   // nota bene: this could be negative, caution advised
@@ -1539,17 +1562,12 @@ struct StrangenessBuilder {
                 if (bestCollisionArray[bachelorTrackIndex.mcCollisionId] < 0) {
                   collisionLessCascades++;
                 }
-                for (const auto& cascade : cascades) {
-                  auto const& v0fromAOD = cascade.v0();
-                  if (v0fromAOD.posTrackId() == v0.posTrackId &&
-                      v0fromAOD.negTrackId() == v0.negTrackId &&
-                      cascade.bachelorId() == bachelorTrackIndex.globalId) {
-                    // this will override type, but not collision index
-                    // N.B.: collision index checks still desirable!
-                    currentCascadeEntry.found = true;
-                    currentCascadeEntry.globalId = cascade.globalIndex();
-                    break;
-                  }
+                int existingCascade = findableCascadeIndex.findCascade(v0.posTrackId, v0.negTrackId, bachelorTrackIndex.globalId);
+                if (existingCascade >= 0) {
+                  // this will override type, but not collision index
+                  // N.B.: collision index checks still desirable!
+                  currentCascadeEntry.found = true;
+                  currentCascadeEntry.globalId = cascades.rawIteratorAt(existingCascade).globalIndex();
                 }
                 if (cascadeBuilderOpts.mc_findableDetachedCascade.value || currentCascadeEntry.collisionId >= 0) {
                   cascadeList.push_back(currentCascadeEntry);
@@ -1562,15 +1580,15 @@ struct StrangenessBuilder {
           // correct. We'll have to loop over all V0s and find the appropriate matches
           // ---> but only in mode 1, and only for AO2D-native V0s
           if (mc_findableMode.value == 1) {
+            // index (pos, neg) -> position in sorted v0List, first sorted match wins
+            findableV0Index.clear();
+            for (size_t v0i = 0; v0i < v0List.size(); v0i++) {
+              findableV0Index.addV0(v0List[sorted_v0[v0i]].posTrackId, v0List[sorted_v0[v0i]].negTrackId, v0i);
+            }
             for (size_t casci = 0; casci < cascadeListReconstructedSize; casci++) {
-              // loop over v0List to find corresponding v0 index, but do it in sorted way
-              for (size_t v0i = 0; v0i < v0List.size(); v0i++) {
-                auto v0 = v0List[sorted_v0[v0i]];
-                if (cascadeList[casci].posTrackId == v0.posTrackId &&
-                    cascadeList[casci].negTrackId == v0.negTrackId) {
-                  cascadeList[casci].v0Id = v0i; // fix, point to correct V0 index
-                  break;
-                }
+              int v0i = findableV0Index.findV0(cascadeList[casci].posTrackId, cascadeList[casci].negTrackId);
+              if (v0i >= 0) {
+                cascadeList[casci].v0Id = v0i; // fix, point to correct V0 index
               }
             }
           }
@@ -2841,6 +2859,9 @@ struct StrangenessBuilder {
     // reset vectors for cascade interlinks
     resetInterlinks();
 
+    // daughter DCAs are only valid within this dataframe
+    straHelper.clearDCAToPVCache();
+
     // prepare v0List, cascadeList
     prepareBuildingLists<TBCs>(collisions, mccollisions, v0s, cascades, tracks, mcParticles);
 
@@ -33,12 +33,16 @@
 #include <KFPVertex.h>
 #include <KFParticle.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <numeric>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace o2
@@ -47,35 +51,87 @@ namespace pwglf
 {
 //__________________________________________
 // V0 group: abstraction to deal with duplicates
-// in an intuitive manner
+// in an intuitive manner. Non-owning view into
+// the contiguous arrays of V0groupList
 struct V0group {
-  std::vector<int> V0Ids;        // index list to original aod::V0s
-  std::vector<int> collisionIds; // coll indices
+  std::span<const int> V0Ids;        // index list to original aod::V0s
+  std::span<const int> collisionIds; // coll indices
   int posTrackId;
   int negTrackId;
   uint8_t v0Type;
 };
 
-//_______________________________________________________________________
-template <typename T>
-std::vector<std::size_t> sort_indices_posTrack(const std::vector<T>& v)
-{
-  std::vector<std::size_t> idx(v.size());
-  std::iota(idx.begin(), idx.end(), 0);
-  std::stable_sort(idx.begin(), idx.end(),
-                   [&v](std::size_t i1, std::size_t i2) { return v[i1].posTrackId < v[i2].posTrackId; });
-  return idx;
-}
+//__________________________________________
+// all V0 groups of a dataframe in CSR layout: group i owns
+// entries [offsets[i], offsets[i+1]) of V0Ids and collisionIds
+struct V0groupList {
+  std::vector<int> offsets;
+  std::vector<int> V0Ids;
+  std::vector<int> collisionIds;
+  std::vector<int> posTrackIds;
+  std::vector<int> negTrackIds;
+  std::vector<uint8_t> v0Types;
+
+  // scratch buffers for the sorting, kept to avoid reallocations
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> order;
+  std::vector<uint64_t> keysSwap;
+  std::vector<uint32_t> orderSwap;
+  std::vector<uint32_t> radixCounts;
+  std::vector<int> rowV0Ids;
+  std::vector<int> rowCollisionIds;
+  std::vector<uint8_t> rowV0Types;
+
+  std::size_t size() const { return posTrackIds.size(); }
+  V0group operator[](std::size_t i) const
+  {
+    const std::size_t first = offsets[i];
+    const std::size_t count = offsets[i + 1] - first;
+    return V0group{std::span<const int>(V0Ids.data() + first, count), std::span<const int>(collisionIds.data() + first, count), posTrackIds[i], negTrackIds[i], v0Types[i]};
+  }
+  void clear()
+  {
+    offsets.clear();
+    V0Ids.clear();
+    collisionIds.clear();
+    posTrackIds.clear();
+    negTrackIds.clear();
+    v0Types.clear();
+  }
+};
 
 //_______________________________________________________________________
-template <typename T>
-std::vector<std::size_t> sort_indices_negTrack(const std::vector<T>& v)
+// stable LSD radix sort of (key, index) pairs, 16 bits per pass;
+// passes in which all keys share the same digit are skipped
+inline void radixSortKeys(std::vector<uint64_t>& keys, std::vector<uint32_t>& order, std::vector<uint64_t>& keysSwap, std::vector<uint32_t>& orderSwap, std::vector<uint32_t>& counts)
 {
-  std::vector<std::size_t> idx(v.size());
-  std::iota(idx.begin(), idx.end(), 0);
-  std::stable_sort(idx.begin(), idx.end(),
-                   [&v](std::size_t i1, std::size_t i2) { return v[i1].negTrackId < v[i2].negTrackId; });
-  return idx;
+  constexpr int nBitsPerPass = 16;
+  constexpr std::size_t nBuckets = std::size_t{1} << nBitsPerPass;
+  counts.resize(nBuckets);
+  keysSwap.resize(keys.size());
+  orderSwap.resize(order.size());
+  for (int shift = 0; shift < 64; shift += nBitsPerPass) {
+    std::fill(counts.begin(), counts.end(), 0);
+    for (const auto& key : keys) {
+      counts[(key >> shift) & (nBuckets - 1)]++;
+    }
+    if (counts[(keys[0] >> shift) & (nBuckets - 1)] == keys.size()) {
+      continue; // nothing to sort for this digit
+    }
+    uint32_t sum = 0;
+    for (auto& count : counts) {
+      uint32_t current = count;
+      count = sum;
+      sum += current;
+    }
+    for (std::size_t i = 0; i < keys.size(); i++) {
+      uint32_t destination = counts[(keys[i] >> shift) & (nBuckets - 1)]++;
+      keysSwap[destination] = keys[i];
+      orderSwap[destination] = order[i];
+    }
+    keys.swap(keysSwap);
+    order.swap(orderSwap);
+  }
 }
 
 //_______________________________________________________________________
@@ -85,64 +141,110 @@ std::vector<std::size_t> sort_indices_negTrack(const std::vector<T>& v)
 // but an array of compatible collisions. The original V0 indices
 // are preserved in the resulting structure to allow for easy referencing
 // back afterwards. Algorithmically, full N^2 loops and/or multiple
-// find calls are avoided via sorting.
+// find calls are avoided via a single radix sort on the packed
+// (posTrackId, negTrackId) key; groups are ordered by (pos, neg) index
+// and, inside a group, by V0 index.
 template <typename T>
-std::vector<V0group> groupDuplicates(const T& V0s)
+void groupDuplicates(const T& V0s, V0groupList& v0tableGrouped)
 {
-  std::vector<V0group> v0table;
+  v0tableGrouped.clear();
   if (V0s.size() == 0) {
-    return v0table;
+    return;
   }
-  V0group thisV0;
-  thisV0.V0Ids.push_back(-1);        // create one single element
-  thisV0.collisionIds.push_back(-1); // create one single element
+  auto& keys = v0tableGrouped.keys;
+  auto& order = v0tableGrouped.order;
+  keys.resize(V0s.size());
+  order.resize(V0s.size());
+  v0tableGrouped.rowV0Ids.resize(V0s.size());
+  v0tableGrouped.rowCollisionIds.resize(V0s.size());
+  v0tableGrouped.rowV0Types.resize(V0s.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::size_t iRow = 0;
   for (auto const& V0 : V0s) {
-    thisV0.V0Ids[0] = V0.globalIndex();
-    thisV0.collisionIds[0] = V0.collisionId();
-    thisV0.posTrackId = V0.posTrackId();
-    thisV0.negTrackId = V0.negTrackId();
-    thisV0.v0Type = V0.v0Type();
-    v0table.push_back(thisV0);
+    keys[iRow] = (static_cast<uint64_t>(static_cast<uint32_t>(V0.posTrackId())) << 32) | static_cast<uint32_t>(V0.negTrackId());
+    v0tableGrouped.rowV0Ids[iRow] = V0.globalIndex();
+    v0tableGrouped.rowCollisionIds[iRow] = V0.collisionId();
+    v0tableGrouped.rowV0Types[iRow] = V0.v0Type();
+    iRow++;
   }
-
-  // sort tracks according to positive track index to avoid excessive N^2 searches
-  auto posTrackSort = sort_indices_posTrack(v0table);
-
-  // create a proper list of V0s including duplicates: collisionIds is now a vector
-  int atPosTrackId = v0table[posTrackSort[0]].posTrackId;
-  std::vector<V0group> v0tableFixedPositive; // small list with fixed positive id
-  std::vector<V0group> v0tableGrouped;       // final list with proper grouping
-  for (size_t iV0 = 0; iV0 < posTrackSort.size(); iV0++) {
-    if (atPosTrackId != v0table[posTrackSort[iV0]].posTrackId) {
-      // switched pos track id. Process chunk of V0s
-      auto negTrackSort = sort_indices_negTrack(v0tableFixedPositive);
-      thisV0.collisionIds.clear();
-      thisV0.V0Ids.clear();
-      thisV0.negTrackId = v0tableFixedPositive[negTrackSort[0]].negTrackId;
-      for (size_t iPV0 = 0; iPV0 < v0tableFixedPositive.size(); iPV0++) {
-        if (thisV0.negTrackId != v0tableFixedPositive[negTrackSort[iPV0]].negTrackId) {
-          v0tableGrouped.push_back(thisV0);
-          thisV0.collisionIds.clear(); // clean collision Ids
-          thisV0.V0Ids.clear();        // clean aod::V0s Ids
-        }
-        thisV0.V0Ids.push_back(v0tableFixedPositive[negTrackSort[iPV0]].V0Ids[0]);
-        thisV0.collisionIds.push_back(v0tableFixedPositive[negTrackSort[iPV0]].collisionIds[0]);
-        thisV0.posTrackId = v0tableFixedPositive[negTrackSort[iPV0]].posTrackId;
-        thisV0.negTrackId = v0tableFixedPositive[negTrackSort[iPV0]].negTrackId;
-        thisV0.v0Type = v0tableFixedPositive[negTrackSort[iPV0]].v0Type;
-      }
-      v0tableGrouped.push_back(thisV0); // publish last
-      v0tableFixedPositive.clear();
-      atPosTrackId = v0table[posTrackSort[iV0]].posTrackId; // move to the next pos index
-    }
-    v0tableFixedPositive.push_back(v0table[posTrackSort[iV0]]);
+  radixSortKeys(keys, order, v0tableGrouped.keysSwap, v0tableGrouped.orderSwap, v0tableGrouped.radixCounts);
+
+  v0tableGrouped.V0Ids.reserve(keys.size());
+  v0tableGrouped.collisionIds.reserve(keys.size());
+  for (std::size_t i = 0; i < keys.size(); i++) {
+    const uint32_t row = order[i];
+    if (i == 0 || keys[i] != keys[i - 1]) {
+      v0tableGrouped.offsets.push_back(i);
+      v0tableGrouped.posTrackIds.push_back(static_cast<int>(keys[i] >> 32));
+      v0tableGrouped.negTrackIds.push_back(static_cast<int>(keys[i] & 0xffffffff));
+      v0tableGrouped.v0Types.push_back(0);
+    }
+    v0tableGrouped.V0Ids.push_back(v0tableGrouped.rowV0Ids[row]);
+    v0tableGrouped.collisionIds.push_back(v0tableGrouped.rowCollisionIds[row]);
+    v0tableGrouped.v0Types.back() = v0tableGrouped.rowV0Types[row]; // type of the last entry in the group
   }
-  v0tableGrouped.push_back(thisV0); // publish last
+  v0tableGrouped.offsets.push_back(keys.size());
 
   LOGF(debug, "Duplicate V0s grouped. aod::V0s counted: %i, unique index pairs: %i", V0s.size(), v0tableGrouped.size());
+}
+
+template <typename T>
+V0groupList groupDuplicates(const T& V0s)
+{
+  V0groupList v0tableGrouped;
+  groupDuplicates(V0s, v0tableGrouped);
   return v0tableGrouped;
 }
 
+//__________________________________________
+// hashed lookup of track combinations, used to match findable
+// candidates to reconstructed ones without scanning candidate lists.
+// (pos, neg) pairs are keyed directly; (pos, neg, bachelor) triplets
+// are keyed by a dense id of their (pos, neg) pair and the bachelor.
+// Only the first entry registered for a given key is kept.
+struct TrackComboIndex {
+  std::unordered_map<uint64_t, int> pairIds;
+  std::unordered_map<uint64_t, int> entries;
+
+  static uint64_t packKey(int first, int second)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(first)) << 32) | static_cast<uint32_t>(second);
+  }
+  int findPairId(int posTrackId, int negTrackId) const
+  {
+    auto it = pairIds.find(packKey(posTrackId, negTrackId));
+    return it == pairIds.end() ? -1 : it->second;
+  }
+  void addV0(int posTrackId, int negTrackId, int index)
+  {
+    entries.emplace(packKey(posTrackId, negTrackId), index);
+  }
+  int findV0(int posTrackId, int negTrackId) const
+  {
+    auto it = entries.find(packKey(posTrackId, negTrackId));
+    return it == entries.end() ? -1 : it->second;
+  }
+  void addCascade(int posTrackId, int negTrackId, int bachTrackId, int index)
+  {
+    auto pairId = pairIds.emplace(packKey(posTrackId, negTrackId), static_cast<int>(pairIds.size())).first->second;
+    entries.emplace(packKey(pairId, bachTrackId), index);
+  }
+  int findCascade(int posTrackId, int negTrackId, int bachTrackId) const
+  {
+    int pairId = findPairId(posTrackId, negTrackId);
+    if (pairId < 0) {
+      return -1;
+    }
+    auto it = entries.find(packKey(pairId, bachTrackId));
+    return it == entries.end() ? -1 : it->second;
+  }
+  void clear()
+  {
+    pairIds.clear();
+    entries.clear();
+  }
+};
+
 //__________________________________________
 // V0 information storage
 struct v0candidate {
@@ -329,7 +431,7 @@ class strangenessBuilderHelper
       o2::track::TrackPar negativeTrackParamCopy(negativeTrackParam);
 
       dcaInfo[0] = dcaInfo[1] = 999.0f; // by default, take large value to make sure candidate accepted
-      o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, positiveTrackParamCopy, 2.f, fitter.getMatCorrType(), &dcaInfo);
+      propagateToPV(positiveTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, positiveTrackParamCopy, dcaInfo);
       v0.positiveDCAxy = dcaInfo[0];
 
       if constexpr (useSelections) {
@@ -340,7 +442,7 @@ class strangenessBuilderHelper
       }
 
       dcaInfo[0] = dcaInfo[1] = 999.0f; // by default, take large value to make sure candidate accepted
-      o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, negativeTrackParamCopy, 2.f, fitter.getMatCorrType(), &dcaInfo);
+      propagateToPV(negativeTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, negativeTrackParamCopy, dcaInfo);
       v0.negativeDCAxy = dcaInfo[0];
 
       if constexpr (useSelections) {
@@ -530,7 +632,7 @@ class strangenessBuilderHelper
     o2::track::TrackPar negativeTrackParamCopy(negativeTrackParam);
 
     dcaInfo[0] = dcaInfo[1] = 999.0f; // by default, take large value to make sure candidate accepted
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, positiveTrackParamCopy, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    propagateToPV(positiveTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, positiveTrackParamCopy, dcaInfo);
     v0.positiveDCAxy = dcaInfo[0];
 
     if (std::fabs(v0.positiveDCAxy) < v0selections.dcanegtopv) {
@@ -539,7 +641,7 @@ class strangenessBuilderHelper
     }
 
     dcaInfo[0] = dcaInfo[1] = 999.0f; // reset to default value
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, negativeTrackParamCopy, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    propagateToPV(negativeTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, negativeTrackParamCopy, dcaInfo);
     v0.negativeDCAxy = dcaInfo[0];
 
     if (std::fabs(v0.negativeDCAxy) < v0selections.dcanegtopv) {
@@ -759,7 +861,7 @@ class strangenessBuilderHelper
     dcaInfo[0] = dcaInfo[1] = 999.0f; // by default, take large value to make sure candidate accepted
 
     auto bachTrackPar = getTrackPar(bachelorTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, bachTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    propagateToPV(bachelorTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, bachTrackPar, dcaInfo);
     cascade.bachelorDCAxy = dcaInfo[0];
 
     if (std::fabs(cascade.bachelorDCAxy) < cascadeselections.dcabachtopv) {
@@ -986,17 +1088,17 @@ class strangenessBuilderHelper
     dcaInfo[0] = dcaInfo[1] = 999.0f; // by default, take large value to make sure candidate accepted
 
     auto bachTrackPar = getTrackPar(bachelorTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, bachTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    propagateToPV(bachelorTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, bachTrackPar, dcaInfo);
     cascade.bachelorDCAxy = dcaInfo[0];
 
     dcaInfo[0] = dcaInfo[1] = 999.0f; // by default, take large value to make sure candidate accepted
     o2::track::TrackParCov posTrackParCovForDCA = getTrackParCov(positiveTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, posTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    propagateToPV(positiveTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, posTrackParCovForDCA, dcaInfo);
     cascade.positiveDCAxy = dcaInfo[0];
 
     dcaInfo[0] = dcaInfo[1] = 999.0f; // by default, take large value to make sure candidate accepted
     o2::track::TrackParCov negTrackParCovForDCA = getTrackParCov(negativeTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, negTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    propagateToPV(negativeTrack.globalIndex(), collisionIndex, pvX, pvY, pvZ, negTrackParCovForDCA, dcaInfo);
     cascade.negativeDCAxy = dcaInfo[0];
 
     if (std::fabs(cascade.bachelorDCAxy) < cascadeselections.dcabachtopv) {
@@ -1257,6 +1359,28 @@ class strangenessBuilderHelper
     return true;
   }
 
+  //_______________________________________________________________________
+  // optional cache of daughter DCA-to-PV results, shared by all building paths.
+  // Keyed by (track, collision), invalidated by the user once per dataframe.
+  // Each entry remembers the parameters it was propagated from, so that a
+  // daughter modified by the caller (e.g. moved TPC-only track, electron PID)
+  // is propagated again instead of reusing the result
+  bool useDCAToPVCache = false;
+  void clearDCAToPVCache()
+  {
+    for (auto& cache : dcaToPVCache) {
+      cache.clear();
+    }
+  }
+  // moves the entries of another helper's cache (e.g. a worker copy) into this one,
+  // entries already present here are kept
+  void mergeDCAToPVCache(strangenessBuilderHelper& other)
+  {
+    for (std::size_t iCache = 0; iCache < dcaToPVCache.size(); iCache++) {
+      dcaToPVCache[iCache].merge(other.dcaToPVCache[iCache]);
+    }
+  }
+
   o2::base::MatLayerCylSet* lut;       // material LUT for DCA fitter
   o2::vertexing::DCAFitterN<2> fitter; // 2-prong o2 dca fitter
 
@@ -1286,6 +1410,37 @@ class strangenessBuilderHelper
   } cascadeselections;
 
  private:
+  struct dcaToPVCacheEntry {
+    std::array<float, 7> params; // x, alpha, y, z, snp, tgl, q2pt before propagation
+    std::array<float, 3> pv;
+    uint8_t pid;
+    std::array<float, 2> dca;
+  };
+  std::array<std::unordered_map<uint64_t, dcaToPVCacheEntry>, 2> dcaToPVCache; // [TrackPar, TrackParCov]
+
+  // propagate a daughter (copy) to the PV for its DCA, using the cache if enabled.
+  // On a cache hit the parameters are left unpropagated: callers only use dcaInfo
+  template <typename TTrackParametrization>
+  void propagateToPV(int trackIndex, int collisionIndex, float pvX, float pvY, float pvZ, TTrackParametrization& trackParam, std::array<float, 2>& dcaInfo)
+  {
+    if (!useDCAToPVCache) {
+      o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, trackParam, 2.f, fitter.getMatCorrType(), &dcaInfo);
+      return;
+    }
+    auto& cache = dcaToPVCache[std::is_same_v<TTrackParametrization, o2::track::TrackPar> ? 0 : 1];
+    const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(trackIndex)) << 32) | static_cast<uint32_t>(collisionIndex);
+    const std::array<float, 7> params = {trackParam.getX(), trackParam.getAlpha(), trackParam.getY(), trackParam.getZ(), trackParam.getSnp(), trackParam.getTgl(), trackParam.getQ2Pt()};
+    const std::array<float, 3> pv = {pvX, pvY, pvZ};
+    const uint8_t pid = trackParam.getPID().getID();
+    auto it = cache.find(key);
+    if (it != cache.end() && it->second.params == params && it->second.pv == pv && it->second.pid == pid) {
+      dcaInfo = it->second.dca;
+      return;
+    }
+    o2::base::Propagator::Instance()->propagateToDCABxByBz({pvX, pvY, pvZ}, trackParam, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    cache.insert_or_assign(key, dcaToPVCacheEntry{params, pv, pid, dcaInfo});
+  }
+
   // internal helper to calculate DCA (3D) of a straight line to a given PV analytically
   float CalculateDCAStraightToPV(float X, float Y, float Z, float Px, float Py, float Pz, float pvX, float pvY, float pvZ)
   {
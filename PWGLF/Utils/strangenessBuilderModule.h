@@ -47,12 +47,14 @@
 #include <TPDGCode.h>
 #include <TString.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <numeric>
 #include <string>
+#include <thread>
 #include <vector>
 
 // simple checkers, but ensure 8 bit integers
@@ -334,6 +336,12 @@ struct coreConfigurables : o2::framework::ConfigurableGroup {
 
   // test the possibility of refitting with material corrections (DCA Fitter option)
   o2::framework::Configurable<bool> refitWithMaterialCorrection{"refitWithMaterialCorrection", false, "do refit after material corrections were applied"};
+
+  // parallel building: V0s and cascades are fitted by worker threads, tables still filled in order
+  o2::framework::Configurable<int> nThreads{"nThreads", 1, "number of threads used to build V0s and cascades. 1: serial"};
+
+  // reuse daughter DCA-to-PV propagations across V0s and cascades sharing a track
+  o2::framework::Configurable<bool> useDCAToPVCache{"useDCAToPVCache", false, "cache daughter DCA to PV per (track, collision) within a dataframe. False (default): propagate again; true: save CPU, use more RAM"};
 };
 
 // strangenessBuilder: V0 building options
@@ -608,8 +616,21 @@ class BuilderModule
   // for tagging V0s used in cascades
   std::vector<o2::pwglf::v0candidate> v0sFromCascades; // Vector of v0 candidates used in cascades
   std::vector<int> ao2dV0toV0List;                     // index to relate v0s -> v0List
+  o2::pwglf::V0groupList v0tableGrouped;               // V0s grouped by (pos, neg) track for de-duplication
+  o2::pwglf::TrackComboIndex findableV0Index;          // (pos, neg) -> V0 lookup for MC findable mode
+  o2::pwglf::TrackComboIndex findableCascadeIndex;     // (pos, neg, bach) -> cascade lookup for MC findable mode
   std::vector<int> v0Map;                              // index to relate v0List -> v0sFromCascades
 
+  // candidates built by worker threads (baseOpts.nThreads > 1), index-aligned with sorted_v0 / sorted_cascade
+  enum prebuildStatus : uint8_t { kNotPrebuilt = 0,
+                                  kPrebuildOK,
+                                  kPrebuildFailed };
+  std::vector<o2::pwglf::v0candidate> v0sPrebuilt;
+  std::vector<uint8_t> v0PrebuildStatus;
+  std::vector<o2::pwglf::cascadeCandidate> cascadesPrebuilt;
+  std::vector<uint8_t> cascadePrebuildStatus;
+  bool isSerialFallbackReported = false;
+
   // declaration of structs here
   // (N.B.: will be invisible to the outside, create your own copies)
   o2::pwglf::strangenessbuilder::coreConfigurables baseOpts;
@@ -824,6 +845,8 @@ class BuilderModule
     // Set option to refit with material corrections
     straHelper.fitter.setRefitWithMatCorr(baseOpts.refitWithMaterialCorrection.value);
 
+    straHelper.useDCAToPVCache = baseOpts.useDCAToPVCache.value;
+
     // Initialise the RCTFlagsChecker
     if (eventSelectOpts.cfgApplyRCTrequirement) {
       rctFlagsChecker.init(eventSelectOpts.cfgRCTLabel.value, eventSelectOpts.cfgCheckZDC, eventSelectOpts.cfgTreatLimitedAcceptanceAsBad);
@@ -983,7 +1006,7 @@ class BuilderModule
         // handle duplicates explicitly: group V0s according to (p,n) indices
         // will provide a list of collisionIds (in V0group), allowing for
         // easy de-duplication when passing to the v0List
-        std::vector<o2::pwglf::V0group> v0tableGrouped = o2::pwglf::groupDuplicates(v0s);
+        o2::pwglf::groupDuplicates(v0s, v0tableGrouped);
         histos.fill(HIST("hDeduplicationStatistics"), 0.0, v0s.size());
         histos.fill(HIST("hDeduplicationStatistics"), 1.0, v0tableGrouped.size());
 
@@ -1138,24 +1161,34 @@ class BuilderModule
           }
         }
 
-        // Nested loop only with valuable tracks
+        // group negative tracks by originating particle (stable: pairing order is preserved)
+        std::ranges::stable_sort(negativeTrackArray, {}, &trackEntry::originId);
+
+        // index V0s by (pos, neg) once instead of searching them for every findable pair
+        findableV0Index.clear();
+        if (baseOpts.mc_findableMode.value == 1) {
+          for (int ii = 0; ii < v0ListReconstructedSize; ii++) {
+            findableV0Index.addV0(v0List[ii].posTrackId, v0List[ii].negTrackId, ii);
+          }
+        }
+        if (baseOpts.mc_findableMode.value == 2) {
+          int v0Row = 0;
+          for (const auto& v0 : v0s) {
+            findableV0Index.addV0(v0.posTrackId(), v0.negTrackId(), v0Row++);
+          }
+        }
+
+        // pair valuable tracks sharing the same originating particle
         for (const auto& positiveTrackIndex : positiveTrackArray) {
-          for (const auto& negativeTrackIndex : negativeTrackArray) {
-            if (positiveTrackIndex.originId != negativeTrackIndex.originId) {
-              continue; // not the same originating particle
-            }
+          for (const auto& negativeTrackIndex : std::ranges::equal_range(negativeTrackArray, positiveTrackIndex.originId, {}, &trackEntry::originId)) {
             // findable mode 1: add non-reconstructed as v0Type 8
             if (baseOpts.mc_findableMode.value == 1) {
-              bool detected = false;
-              for (int ii = 0; ii < v0ListReconstructedSize; ii++) {
-                // check if this particular combination already exists in v0List
-                if (v0List[ii].posTrackId == positiveTrackIndex.globalId &&
-                    v0List[ii].negTrackId == negativeTrackIndex.globalId) {
-                  detected = true;
-                  // override pdg code with something useful for cascade findable math
-                  v0List[ii].pdgCode = positiveTrackIndex.pdgCode;
-                  break;
-                }
+              // check if this particular combination already exists in v0List
+              int existingV0 = findableV0Index.findV0(positiveTrackIndex.globalId, negativeTrackIndex.globalId);
+              bool detected = existingV0 >= 0;
+              if (detected) {
+                // override pdg code with something useful for cascade findable math
+                v0List[existingV0].pdgCode = positiveTrackIndex.pdgCode;
               }
               if (detected == false) {
                 // collision index: from best-version-of-this-mcCollision
@@ -1194,17 +1227,15 @@ class BuilderModule
                 currentV0Entry.isCollinearV0 = true;
               }
               currentV0Entry.found = false;
-              for (const auto& v0 : v0s) {
-                if (v0.posTrackId() == positiveTrackIndex.globalId &&
-                    v0.negTrackId() == negativeTrackIndex.globalId) {
-                  // this will override type, but not collision index
-                  // N.B.: collision index checks still desirable!
-                  currentV0Entry.globalId = v0.globalIndex();
-                  currentV0Entry.v0Type = v0.v0Type();
-                  currentV0Entry.isCollinearV0 = v0.isCollinearV0();
-                  currentV0Entry.found = true;
-                  break;
-                }
+              int existingV0 = findableV0Index.findV0(positiveTrackIndex.globalId, negativeTrackIndex.globalId);
+              if (existingV0 >= 0) {
+                auto const& v0 = v0s.rawIteratorAt(existingV0);
+                // this will override type, but not collision index
+                // N.B.: collision index checks still desirable!
+                currentV0Entry.globalId = v0.globalIndex();
+                currentV0Entry.v0Type = v0.v0Type();
+                currentV0Entry.isCollinearV0 = v0.isCollinearV0();
+                currentV0Entry.found = true;
               }
               if (v0BuilderOpts.mc_findableDetachedV0.value || currentV0Entry.collisionId >= 0) {
                 v0List.push_back(currentV0Entry);
@@ -1285,6 +1316,25 @@ class BuilderModule
             bachelorTrackArray.push_back(currentTrackEntry);
           }
 
+          // group bachelor tracks by originating particle (stable: pairing order is preserved)
+          std::ranges::stable_sort(bachelorTrackArray, {}, &trackEntry::originId);
+
+          // index cascades by (pos, neg, bachelor) once instead of searching them for every findable triplet
+          // caution: use track indices (immutable) but not V0 indices (re-indexing)
+          findableCascadeIndex.clear();
+          if (baseOpts.mc_findableMode.value == 1) {
+            for (size_t ii = 0; ii < cascadeListReconstructedSize; ii++) {
+              findableCascadeIndex.addCascade(cascadeList[ii].posTrackId, cascadeList[ii].negTrackId, cascadeList[ii].bachTrackId, ii);
+            }
+          }
+          if (baseOpts.mc_findableMode.value == 2) {
+            int cascadeRow = 0;
+            for (const auto& cascade : cascades) {
+              auto const& v0fromAOD = cascade.v0();
+              findableCascadeIndex.addCascade(v0fromAOD.posTrackId(), v0fromAOD.negTrackId(), cascade.bachelorId(), cascadeRow++);
+            }
+          }
+
           // determine which V0s are of interest to pair and do pairing
           for (size_t v0i = 0; v0i < v0List.size(); v0i++) {
             auto v0 = v0List[sorted_v0[v0i]];
@@ -1314,24 +1364,12 @@ class BuilderModule
             if (std::abs(v0OriginParticle.pdgCode()) != PDG_t::kXiMinus && std::abs(v0OriginParticle.pdgCode()) != PDG_t::kOmegaMinus) {
               continue; // this V0 does not come from any particle of interest, don't try
             }
-            for (const auto& bachelorTrackIndex : bachelorTrackArray) {
-              if (bachelorTrackIndex.originId != v0OriginParticle.globalIndex()) {
-                continue;
-              }
+            for (const auto& bachelorTrackIndex : std::ranges::equal_range(bachelorTrackArray, static_cast<int>(v0OriginParticle.globalIndex()), {}, &trackEntry::originId)) {
               // if we are here: v0 origin is 3312 or 3334, bachelor origin matches V0 origin
               // findable mode 1: add non-reconstructed as cascadeType 1
               if (baseOpts.mc_findableMode.value == 1) {
-                bool detected = false;
-                for (size_t ii = 0; ii < cascadeListReconstructedSize; ii++) {
-                  // check if this particular combination already exists in cascadeList
-                  // caution: use track indices (immutable) but not V0 indices (re-indexing)
-                  if (cascadeList[ii].posTrackId == v0.posTrackId &&
-                      cascadeList[ii].negTrackId == v0.negTrackId &&
-                      cascadeList[ii].bachTrackId == bachelorTrackIndex.globalId) {
-                    detected = true;
-                    break;
-                  }
-                }
+                // check if this particular combination already exists in cascadeList
+                bool detected = findableCascadeIndex.findCascade(v0.posTrackId, v0.negTrackId, bachelorTrackIndex.globalId) >= 0;
                 if (detected == false) {
                   // collision index: from best-version-of-this-mcCollision
                   // nota bene: this could be negative, caution advised
@@ -1365,17 +1403,12 @@ class BuilderModule
                 if (bestCollisionArray[bachelorTrackIndex.mcCollisionId] < 0) {
                   collisionLessCascades++;
                 }
-                for (const auto& cascade : cascades) {
-                  auto const& v0fromAOD = cascade.v0();
-                  if (v0fromAOD.posTrackId() == v0.posTrackId &&
-                      v0fromAOD.negTrackId() == v0.negTrackId &&
-                      cascade.bachelorId() == bachelorTrackIndex.globalId) {
-                    // this will override type, but not collision index
-                    // N.B.: collision index checks still desirable!
-                    currentCascadeEntry.found = true;
-                    currentCascadeEntry.globalId = cascade.globalIndex();
-                    break;
-                  }
+                int existingCascade = findableCascadeIndex.findCascade(v0.posTrackId, v0.negTrackId, bachelorTrackIndex.globalId);
+                if (existingCascade >= 0) {
+                  // this will override type, but not collision index
+                  // N.B.: collision index checks still desirable!
+                  currentCascadeEntry.found = true;
+                  currentCascadeEntry.globalId = cascades.rawIteratorAt(existingCascade).globalIndex();
                 }
                 if (cascadeBuilderOpts.mc_findableDetachedCascade.value || currentCascadeEntry.collisionId >= 0) {
                   cascadeList.push_back(currentCascadeEntry);
@@ -1388,15 +1421,15 @@ class BuilderModule
           // correct. We'll have to loop over all V0s and find the appropriate matches
           // ---> but only in mode 1, and only for AO2D-native V0s
           if (baseOpts.mc_findableMode.value == 1) {
+            // index (pos, neg) -> position in sorted v0List, first sorted match wins
+            findableV0Index.clear();
+            for (size_t v0i = 0; v0i < v0List.size(); v0i++) {
+              findableV0Index.addV0(v0List[sorted_v0[v0i]].posTrackId, v0List[sorted_v0[v0i]].negTrackId, v0i);
+            }
             for (size_t casci = 0; casci < cascadeListReconstructedSize; casci++) {
-              // loop over v0List to find corresponding v0 index, but do it in sorted way
-              for (size_t v0i = 0; v0i < v0List.size(); v0i++) {
-                auto v0 = v0List[sorted_v0[v0i]];
-                if (cascadeList[casci].posTrackId == v0.posTrackId &&
-                    cascadeList[casci].negTrackId == v0.negTrackId) {
-                  cascadeList[casci].v0Id = v0i; // fix, point to correct V0 index
-                  break;
-                }
+              int v0i = findableV0Index.findV0(cascadeList[casci].posTrackId, cascadeList[casci].negTrackId);
+              if (v0i >= 0) {
+                cascadeList[casci].v0Id = v0i; // fix, point to correct V0 index
               }
             }
           }
@@ -1455,6 +1488,159 @@ class BuilderModule
   }
 
   //__________________________________________________
+  //__________________________________________________
+  // the workers own their fitter and DCA cache, but the fitter material correction and
+  // the daughter DCAs go through the shared propagator singleton. This is only safe with
+  // the material LUT (or no correction), as TGeo navigation is not thread safe, and with
+  // the fast field parameterisation, as the full field map caches its state
+  bool isParallelBuildSafe() const
+  {
+    auto const* propagator = o2::base::Propagator::Instance();
+    const auto matCorr = straHelper.fitter.getMatCorrType();
+    const bool isMatCorrSafe = matCorr == o2::base::Propagator::MatCorrType::USEMatCorrNONE ||
+                               (matCorr == o2::base::Propagator::MatCorrType::USEMatCorrLUT && propagator->getMatLUT() != nullptr);
+    return isMatCorrSafe && propagator->getFieldFast() != nullptr;
+  }
+
+  // true if the V0s and cascades are to be prebuilt by worker threads
+  bool useParallelBuild()
+  {
+    if (baseOpts.nThreads.value <= 1) {
+      return false;
+    }
+    if (isParallelBuildSafe()) {
+      return true;
+    }
+    if (!isSerialFallbackReported) {
+      LOG(warning) << "Parallel V0 and cascade building requires the material LUT (or no material correction) and the fast magnetic field, building serially";
+      isSerialFallbackReported = true;
+    }
+    return false;
+  }
+
+  //__________________________________________________
+  // splits [0, nEntries) in contiguous ranges, processed by up to baseOpts.nThreads
+  // workers. Each worker owns a copy of straHelper, i.e. its own fitter state and a
+  // copy of the DCA cache, whose new entries are merged back after the join.
+  template <typename TFunction>
+  void runWithWorkerHelpers(std::size_t nEntries, TFunction const& processRange)
+  {
+    const std::size_t nWorkers = std::min<std::size_t>(baseOpts.nThreads.value, nEntries);
+    if (nWorkers == 0) {
+      return;
+    }
+    const std::size_t chunkSize = (nEntries + nWorkers - 1) / nWorkers;
+    std::vector<o2::pwglf::strangenessBuilderHelper> helpers(nWorkers, straHelper);
+    std::vector<std::thread> workers;
+    workers.reserve(nWorkers - 1);
+    for (std::size_t iWorker = 1; iWorker < nWorkers; iWorker++) {
+      workers.emplace_back([&, iWorker]() {
+        processRange(helpers[iWorker], iWorker * chunkSize, std::min(nEntries, (iWorker + 1) * chunkSize));
+      });
+    }
+    processRange(helpers[0], 0, std::min(nEntries, chunkSize));
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    if (straHelper.useDCAToPVCache) {
+      for (auto& helper : helpers) {
+        straHelper.mergeDCAToPVCache(helper);
+      }
+    }
+  }
+
+  //__________________________________________________
+  // builds the V0 candidates of buildV0s in parallel. V0s that buildV0s would skip
+  // before fitting are left kNotPrebuilt, as are V0s with TPC-only prongs to be
+  // moved: the TPC drift manager is stateful, these are built in the serial loop
+  template <typename TCollisions, typename TTracks>
+  void prebuildV0s(TCollisions const& collisions, TTracks const& tracks)
+  {
+    v0sPrebuilt.assign(v0List.size(), {});
+    v0PrebuildStatus.assign(v0List.size(), kNotPrebuilt);
+    runWithWorkerHelpers(v0List.size(), [&](o2::pwglf::strangenessBuilderHelper& helper, std::size_t first, std::size_t last) {
+      for (std::size_t iv0 = first; iv0 < last; iv0++) {
+        const auto& v0 = v0List[sorted_v0[iv0]];
+        if ((!v0BuilderOpts.generatePhotonCandidates.value && v0.v0Type > 1) || (!baseOpts.mEnabledTables[kV0CoresBase] && v0Map[iv0] == -2)) {
+          continue;
+        }
+        float pvX = 0.0f, pvY = 0.0f, pvZ = 0.0f;
+        if (v0.collisionId >= 0) {
+          auto const& collision = collisions.rawIteratorAt(v0.collisionId);
+          pvX = collision.posX();
+          pvY = collision.posY();
+          pvZ = collision.posZ();
+          if (eventSelectOpts.fillOnlySelectedCollisions && !isCollisionAccepted(collision)) {
+            continue;
+          }
+        }
+        auto const& posTrack = tracks.rawIteratorAt(v0.posTrackId);
+        auto const& negTrack = tracks.rawIteratorAt(v0.negTrackId);
+        if (v0BuilderOpts.moveTPCOnlyTracks &&
+            ((posTrack.hasTPC() && !posTrack.hasITS() && !posTrack.hasTRD() && !posTrack.hasTOF()) ||
+             (negTrack.hasTPC() && !negTrack.hasITS() && !negTrack.hasTRD() && !negTrack.hasTOF()))) {
+          continue;
+        }
+        auto posTrackPar = getTrackParCov(posTrack);
+        auto negTrackPar = getTrackParCov(negTrack);
+        bool isBuilt = helper.buildV0Candidate(v0.collisionId, pvX, pvY, pvZ, posTrack, negTrack, posTrackPar, negTrackPar, v0.isCollinearV0, baseOpts.mEnabledTables[kV0Covs], v0BuilderOpts.generatePhotonCandidates);
+        v0PrebuildStatus[iv0] = isBuilt ? kPrebuildOK : kPrebuildFailed;
+        v0sPrebuilt[iv0] = helper.v0;
+      }
+    });
+  }
+
+  //__________________________________________________
+  // builds the cascade candidates of buildCascades in parallel
+  template <typename TCollisions, typename TCascades, typename TTracks>
+  void prebuildCascades(TCollisions const& collisions, TCascades const& cascades, TTracks const& tracks)
+  {
+    cascadesPrebuilt.assign(cascades.size(), {});
+    cascadePrebuildStatus.assign(cascades.size(), kNotPrebuilt);
+    runWithWorkerHelpers(cascades.size(), [&](o2::pwglf::strangenessBuilderHelper& helper, std::size_t first, std::size_t last) {
+      for (std::size_t icascade = first; icascade < last; icascade++) {
+        auto const& cascade = cascades[sorted_cascade[icascade]];
+        float pvX = 0.0f, pvY = 0.0f, pvZ = 0.0f;
+        if (cascade.collisionId >= 0) {
+          auto const& collision = collisions.rawIteratorAt(cascade.collisionId);
+          pvX = collision.posX();
+          pvY = collision.posY();
+          pvZ = collision.posZ();
+          if (eventSelectOpts.fillOnlySelectedCollisions && !isCollisionAccepted(collision)) {
+            continue;
+          }
+        }
+        auto const& posTrack = tracks.rawIteratorAt(cascade.posTrackId);
+        auto const& negTrack = tracks.rawIteratorAt(cascade.negTrackId);
+        auto const& bachTrack = tracks.rawIteratorAt(cascade.bachTrackId);
+        bool isBuilt = false;
+        if (baseOpts.useV0BufferForCascades) {
+          if (cascade.v0Id < 0 || v0Map[cascade.v0Id] < 0) {
+            continue;
+          }
+          isBuilt = helper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
+                                                 v0sFromCascades[v0Map[cascade.v0Id]],
+                                                 posTrack,
+                                                 negTrack,
+                                                 bachTrack,
+                                                 baseOpts.mEnabledTables[kCascBBs],
+                                                 cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
+                                                 baseOpts.mEnabledTables[kCascCovs]);
+        } else {
+          isBuilt = helper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
+                                                 posTrack,
+                                                 negTrack,
+                                                 bachTrack,
+                                                 baseOpts.mEnabledTables[kCascBBs],
+                                                 cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
+                                                 baseOpts.mEnabledTables[kCascCovs]);
+        }
+        cascadePrebuildStatus[icascade] = isBuilt ? kPrebuildOK : kPrebuildFailed;
+        cascadesPrebuilt[icascade] = helper.cascade;
+      }
+    });
+  }
+
   template <class TBCs, typename THistoRegistry, typename TCollisions, typename TTracks, typename TV0s, typename TMCParticles, typename TProducts>
   void buildV0s(THistoRegistry& histos, TCollisions const& collisions, TV0s const& v0s, TTracks const& tracks, TMCParticles const& mcParticles, TProducts& products)
   {
@@ -1467,6 +1653,12 @@ class BuilderModule
       mcParticleIsReco.resize(mcParticles.size(), false);
     }
 
+    v0sPrebuilt.clear();
+    v0PrebuildStatus.clear();
+    if (useParallelBuild()) {
+      prebuildV0s(collisions, tracks);
+    }
+
     int nV0s = 0;
     // Loops over all V0s in the time frame
     histos.fill(HIST("hInputStatistics"), kV0CoresBase, v0s.size());
@@ -1581,7 +1773,14 @@ class BuilderModule
         }
       }
 
-      if (!straHelper.buildV0Candidate(v0.collisionId, pvX, pvY, pvZ, posTrack, negTrack, posTrackPar, negTrackPar, v0.isCollinearV0, baseOpts.mEnabledTables[kV0Covs], v0BuilderOpts.generatePhotonCandidates)) {
+      bool isV0Built = false;
+      if (!v0PrebuildStatus.empty() && v0PrebuildStatus[iv0] != kNotPrebuilt) {
+        straHelper.v0 = v0sPrebuilt[iv0];
+        isV0Built = (v0PrebuildStatus[iv0] == kPrebuildOK);
+      } else {
+        isV0Built = straHelper.buildV0Candidate(v0.collisionId, pvX, pvY, pvZ, posTrack, negTrack, posTrackPar, negTrackPar, v0.isCollinearV0, baseOpts.mEnabledTables[kV0Covs], v0BuilderOpts.generatePhotonCandidates);
+      }
+      if (!isV0Built) {
         products.v0dataLink(-1, -1);
         continue;
       }
@@ -2057,6 +2256,12 @@ class BuilderModule
     if (!baseOpts.mEnabledTables[kStoredCascCores]) {
       return; // don't do if no request for cascades in place
     }
+    cascadesPrebuilt.clear();
+    cascadePrebuildStatus.clear();
+    if (useParallelBuild()) {
+      prebuildCascades(collisions, cascades, tracks);
+    }
+
     int nCascades = 0;
     // Loops over all cascades in the time frame
     histos.fill(HIST("hInputStatistics"), kStoredCascCores, cascades.size());
@@ -2143,14 +2348,28 @@ class BuilderModule
           continue; // didn't work out, skip
         }
 
-        if (!straHelper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
-                                              v0sFromCascades[v0Map[cascade.v0Id]],
-                                              posTrack,
-                                              negTrack,
-                                              bachTrack,
-                                              baseOpts.mEnabledTables[kCascBBs],
-                                              cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
-                                              baseOpts.mEnabledTables[kCascCovs])) {
+        if (!cascadePrebuildStatus.empty()) {
+          straHelper.cascade = cascadesPrebuilt[icascade];
+          if (cascadePrebuildStatus[icascade] != kPrebuildOK) {
+            products.cascdataLink(-1);
+            interlinks.cascadeToCascCores.push_back(-1);
+            continue; // didn't work out, skip
+          }
+        } else if (!straHelper.buildCascadeCandidate(cascade.collisionId, pvX, pvY, pvZ,
+                                                     v0sFromCascades[v0Map[cascade.v0Id]],
+                                                     posTrack,
+                                                     negTrack,
+                                                     bachTrack,
+                                                     baseOpts.mEnabledTables[kCascBBs],
+                                                     cascadeBuilderOpts.useCascadeMomentumAtPrimVtx,
+                                                     baseOpts.mEnabledTables[kCascCovs])) {
+          products.cascdataLink(-1);
+          interlinks.cascadeToCascCores.push_back(-1);
+          continue; // didn't work out, skip
+        }
+      } else if (!cascadePrebuildStatus.empty()) {
+        straHelper.cascade = cascadesPrebuilt[icascade];
+        if (cascadePrebuildStatus[icascade] != kPrebuildOK) {
           products.cascdataLink(-1);
           interlinks.cascadeToCascCores.push_back(-1);
           continue; // didn't work out, skip
@@ -2771,6 +2990,9 @@ class BuilderModule
     // reset vectors for cascade interlinks
     resetInterlinks();
 
+    // daughter DCAs are only valid within this dataframe
+    straHelper.clearDCAToPVCache();
+
     // prepare v0List, cascadeList
     prepareBuildingLists<TBCs>(histos, collisions, mccollisions, v0s, cascades, tracks, mcParticles);
 
@@ -71,7 +71,54 @@ class DGSelector
         return 1;
       }
     }
+    return selectCollision(diffCuts, collision, tracks, fwdtracks);
+  };
+
+  // same as above, with the FIT veto taken from a FITActivityIndex over the BC rows in bcRows
+  template <typename CC, typename TCs, typename FWs>
+  int IsSelected(DGCutparHolder diffCuts, CC& collision, udhelpers::FITActivityIndex const& fitIndex, udhelpers::BCRowRange const& bcRows, TCs& tracks, FWs& fwdtracks)
+  {
+    if (udhelpers::FITveto(fitIndex, bcRows, diffCuts)) {
+      return 1;
+    }
+    return selectCollision(diffCuts, collision, tracks, fwdtracks);
+  };
+
+  // Function to check if BC passes DG filter (without associated collision)
+  template <typename BCs, typename TCs, typename FWs>
+  int IsSelected(DGCutparHolder diffCuts, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  {
+    // return if FIT veto is found in any of the compatible BCs
+    // Double Gap (DG) condition
+    // 4 types of vetoes:
+    //  0 TVX
+    //  1 TSC
+    //  2 TCE
+    //  3 TOR
+    for (auto const& bc : bcRange) {
+      if (udhelpers::FITveto(bc, diffCuts)) {
+        return 1;
+      }
+    }
+    return selectBC(diffCuts, tracks, fwdtracks);
+  };
 
+  // same as above, with the FIT veto taken from a FITActivityIndex over the BC rows in bcRows
+  // (own name, as IsSelected(diffCuts, collision, bcRange, tracks, fwdtracks) would match these arguments)
+  template <typename TCs, typename FWs>
+  int IsSelectedBC(DGCutparHolder diffCuts, udhelpers::FITActivityIndex const& fitIndex, udhelpers::BCRowRange const& bcRows, TCs& tracks, FWs& fwdtracks)
+  {
+    if (udhelpers::FITveto(fitIndex, bcRows, diffCuts)) {
+      return 1;
+    }
+    return selectBC(diffCuts, tracks, fwdtracks);
+  };
+
+ private:
+  // collision selection following the FIT veto
+  template <typename CC, typename TCs, typename FWs>
+  int selectCollision(DGCutparHolder const& diffCuts, CC& collision, TCs& tracks, FWs& fwdtracks)
+  {
     // forward tracks
     LOGF(debug, "FwdTracks %i", fwdtracks.size());
     if (!diffCuts.withFwdTracks()) {
@@ -201,23 +248,10 @@ class DGSelector
     return 0;
   };
 
-  // Function to check if BC passes DG filter (without associated collision)
-  template <typename BCs, typename TCs, typename FWs>
-  int IsSelected(DGCutparHolder diffCuts, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  // BC selection following the FIT veto
+  template <typename TCs, typename FWs>
+  int selectBC(DGCutparHolder const& diffCuts, TCs& tracks, FWs& fwdtracks)
   {
-    // return if FIT veto is found in any of the compatible BCs
-    // Double Gap (DG) condition
-    // 4 types of vetoes:
-    //  0 TVX
-    //  1 TSC
-    //  2 TCE
-    //  3 TOR
-    for (auto const& bc : bcRange) {
-      if (udhelpers::FITveto(bc, diffCuts)) {
-        return 1;
-      }
-    }
-
     // no activity in muon arm
     if (!diffCuts.withFwdTracks()) {
       for (auto& fwdtrack : fwdtracks) {
@@ -280,7 +314,6 @@ class DGSelector
     return 0;
   };
 
- private:
   TDatabasePDG* fPDG;
 
   ClassDefNV(DGSelector, 1);
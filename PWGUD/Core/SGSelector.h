@@ -156,6 +156,58 @@ class SGSelector
     result.value = gA && gC ? o2::aod::sgselector::DoubleGap : (gA ? o2::aod::sgselector::SingleGapA : o2::aod::sgselector::SingleGapC);
     return result;
   }
+  // same as above, with the gap decision taken from a FITActivityIndex of the bcs
+  // over the rows in bcRows, without looping over the BCs of the range
+  template <typename CC, typename BCs, typename BC>
+  SelectionResult<BC> IsSelected(SGCutParHolder const& diffCuts, CC const& collision, udhelpers::FITActivityIndex const& fitIndex, udhelpers::BCRowRange const& bcRows, BCs const& bcs, BC const& oldbc)
+  {
+    SelectionResult<BC> result;
+    result.bc = std::make_shared<BC>(oldbc);
+    if (collision.numContrib() < diffCuts.minNTracks() || collision.numContrib() > diffCuts.maxNTracks()) {
+      result.value = o2::aod::sgselector::TrkOutOfRange; // 4
+      return result;
+    }
+    bool gA = !fitIndex.isActive(udhelpers::FITActivityIndex::kFITA, bcRows);
+    bool gC = !fitIndex.isActive(udhelpers::FITActivityIndex::kFITC, bcRows);
+    if (!gA && !gC) {
+      result.value = o2::aod::sgselector::NoUpc; // gap = 3
+      return result;
+    }
+
+    if (!gA || !gC) {
+      // single gap: take the active BC closest to the original one
+      auto flag = gA ? udhelpers::FITActivityIndex::kFITC : udhelpers::FITActivityIndex::kFITA;
+      result.bc = std::make_shared<BC>(bcs.iteratorAt(fitIndex.closestActive(flag, bcRows, oldbc.globalBC())));
+    } else {
+      // double gap: get the most active FT0 BC
+      auto newdgabc = oldbc;
+      auto newdgcbc = oldbc;
+      float ampa = 0;
+      float ampc = 0;
+      for (auto const& bc : fitIndex.slice(bcs, bcRows)) {
+        if (bc.has_foundFT0()) {
+          float tempampa = udhelpers::FT0AmplitudeA(bc.foundFT0());
+          float tempampc = udhelpers::FT0AmplitudeC(bc.foundFT0());
+          if (tempampa > ampa) {
+            ampa = tempampa;
+            newdgabc = bc;
+          }
+          if (tempampc > ampc) {
+            ampc = tempampc;
+            newdgcbc = bc;
+          }
+        }
+      }
+      if (newdgabc != newdgcbc) {
+        if (ampc / diffCuts.FITAmpLimits()[2] > ampa / diffCuts.FITAmpLimits()[1])
+          newdgabc = newdgcbc;
+      }
+      result.bc = std::make_shared<BC>(newdgabc);
+    }
+    result.value = gA && gC ? o2::aod::sgselector::DoubleGap : (gA ? o2::aod::sgselector::SingleGapA : o2::aod::sgselector::SingleGapC);
+    return result;
+  }
+
   template <typename TFwdTrack>
   int FwdTrkSelector(TFwdTrack const& fwdtrack)
   {
@@ -541,6 +541,202 @@ bool FITveto(T const& bc, DGCutparHolder const& diffCuts)
   return false;
 }
 
+// -----------------------------------------------------------------------------
+// range [first, last) of rows in a BCs table
+struct BCRowRange {
+  int64_t first = 0;
+  int64_t last = 0;
+  int64_t size() const { return last - first; }
+  bool empty() const { return last <= first; }
+};
+
+// -----------------------------------------------------------------------------
+// Per-dataframe index of FIT activity in the BCs table.
+// Holds the sorted globalBC values of all BCs and, for every activity flag,
+// prefix counts of the BCs carrying it. A BC is active for a detector (side)
+// if it fails the corresponding clean* selection with the time cut and the
+// amplitude limits the index was built with. Ranges of compatible BCs are
+// then found by binary search and gap decisions over any BC window are O(1).
+class FITActivityIndex
+{
+ public:
+  enum Flag : int {
+    kFV0A = 0,
+    kFT0A,
+    kFT0C,
+    kFDDA,
+    kFDDC,
+    kFITA, // !cleanFITA
+    kFITC, // !cleanFITC
+    kFIT,  // !cleanFIT
+    kTVX,
+    kTSC,
+    kTCE,
+    kNFlags
+  };
+
+  // (re)build the index unless it already describes bcs with the given cuts
+  template <typename T>
+  void update(T const& bcs, float maxFITtime, std::vector<float> const& lims)
+  {
+    if (isBuiltFor(bcs, maxFITtime, lims)) {
+      return;
+    }
+    mGlobalBCs.clear();
+    mGlobalBCs.reserve(bcs.size());
+    mPrefix.assign(kNFlags, 0);
+    mPrefix.reserve((bcs.size() + 1) * kNFlags);
+    for (auto& rows : mActiveRows) {
+      rows.clear();
+    }
+
+    std::array<bool, kNFlags> active{};
+    int64_t row = 0;
+    for (auto const& bc : bcs) {
+      active[kFV0A] = !cleanFV0(bc, maxFITtime, lims[0]);
+      active[kFT0A] = !cleanFT0A(bc, maxFITtime, lims[1]);
+      active[kFT0C] = !cleanFT0C(bc, maxFITtime, lims[2]);
+      active[kFDDA] = !cleanFDDA(bc, maxFITtime, lims[3]);
+      active[kFDDC] = !cleanFDDC(bc, maxFITtime, lims[4]);
+      active[kFITA] = active[kFV0A] || active[kFT0A] || active[kFDDA];
+      active[kFITC] = active[kFT0C] || active[kFDDC];
+      active[kFIT] = active[kFITA] || active[kFITC];
+      active[kTVX] = TVX(bc);
+      active[kTSC] = TSC(bc);
+      active[kTCE] = TCE(bc);
+
+      mGlobalBCs.push_back(bc.globalBC());
+      for (int flag = 0; flag < kNFlags; flag++) {
+        const int32_t count = mPrefix[row * kNFlags + flag] + active[flag];
+        mPrefix.push_back(count);
+        if (active[flag]) {
+          mActiveRows[flag].push_back(row);
+        }
+      }
+      row++;
+    }
+    mMaxFITtime = maxFITtime;
+    mLims = lims;
+    mBuilt = true;
+  }
+
+  template <typename T>
+  bool isBuiltFor(T const& bcs, float maxFITtime, std::vector<float> const& lims) const
+  {
+    if (!mBuilt || static_cast<int64_t>(mGlobalBCs.size()) != static_cast<int64_t>(bcs.size()) || maxFITtime != mMaxFITtime || lims != mLims) {
+      return false;
+    }
+    return mGlobalBCs.empty() || (mGlobalBCs.front() == bcs.iteratorAt(0).globalBC() && mGlobalBCs.back() == bcs.iteratorAt(bcs.size() - 1).globalBC());
+  }
+
+  int64_t size() const { return mGlobalBCs.size(); }
+  uint64_t globalBC(int64_t row) const { return mGlobalBCs[row]; }
+
+  // rows of BCs with globalBC in [minBC, maxBC]
+  BCRowRange rows(uint64_t minBC, uint64_t maxBC) const
+  {
+    auto first = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), minBC);
+    auto last = std::upper_bound(first, mGlobalBCs.end(), maxBC);
+    return BCRowRange{first - mGlobalBCs.begin(), last - mGlobalBCs.begin()};
+  }
+
+  // rows of BCs with globalBC in meanBC +- deltaBC
+  BCRowRange window(uint64_t meanBC, int deltaBC) const
+  {
+    uint64_t minBC = static_cast<uint64_t>(deltaBC) < meanBC ? meanBC - static_cast<uint64_t>(deltaBC) : 0;
+    uint64_t maxBC = meanBC + static_cast<uint64_t>(deltaBC);
+    return rows(minBC, maxBC);
+  }
+
+  // number of BCs in range carrying flag
+  int count(int flag, BCRowRange const& range) const
+  {
+    if (range.empty()) {
+      return 0;
+    }
+    return mPrefix[range.last * kNFlags + flag] - mPrefix[range.first * kNFlags + flag];
+  }
+  bool isActive(int flag, BCRowRange const& range) const { return count(flag, range) > 0; }
+
+  // row of the BC in range carrying flag with globalBC closest to refBC,
+  // the lower row on ties, -1 if there is none
+  int64_t closestActive(int flag, BCRowRange const& range, uint64_t refBC) const
+  {
+    if (!isActive(flag, range)) {
+      return -1;
+    }
+    int64_t pivot = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), refBC) - mGlobalBCs.begin();
+    pivot = std::clamp(pivot, range.first, range.last);
+    const auto& activeRows = mActiveRows[flag];
+    const int32_t nBefore = mPrefix[pivot * kNFlags + flag];
+    int64_t before = nBefore > mPrefix[range.first * kNFlags + flag] ? activeRows[nBefore - 1] : -1;
+    int64_t after = nBefore < mPrefix[range.last * kNFlags + flag] ? activeRows[nBefore] : -1;
+    if (before < 0) {
+      return after;
+    }
+    if (after < 0) {
+      return before;
+    }
+    return (mGlobalBCs[after] - refBC) < (refBC - mGlobalBCs[before]) ? after : before;
+  }
+
+  // slice of bcs covering range
+  template <typename T>
+  T slice(T const& bcs, BCRowRange const& range) const
+  {
+    if (range.empty()) {
+      return bcs.emptySlice();
+    }
+    auto bcslice = bcs.rawSlice(range.first, range.last - 1);
+    bcs.copyIndexBindings(bcslice);
+    return bcslice;
+  }
+
+ private:
+  bool mBuilt = false;
+  float mMaxFITtime = 0.;
+  std::vector<float> mLims;
+  std::vector<uint64_t> mGlobalBCs;
+  std::vector<int32_t> mPrefix; // (row, flag) -> number of BCs with flag in rows [0, row)
+  std::array<std::vector<int64_t>, kNFlags> mActiveRows;
+};
+
+// -----------------------------------------------------------------------------
+// rows of BCs compatible with a collision, same window as compatibleBCs(collision, ndt, bcs, nMinBCs)
+template <typename C>
+BCRowRange compatibleBCRows(FITActivityIndex const& fitIndex, C const& collision, int ndt, int nMinBCs = 7)
+{
+  if (!collision.has_foundBC() || ndt < 0) {
+    return BCRowRange{};
+  }
+  uint64_t mostProbableBC = fitIndex.globalBC(collision.foundBCId());
+  uint64_t meanBC = mostProbableBC + std::lround(collision.collisionTime() / o2::constants::lhc::LHCBunchSpacingNS);
+  int deltaBC = std::ceil(collision.collisionTimeRes() / o2::constants::lhc::LHCBunchSpacingNS * ndt);
+  if (deltaBC < nMinBCs) {
+    deltaBC = nMinBCs;
+  }
+  return fitIndex.window(meanBC, deltaBC);
+}
+
+// -----------------------------------------------------------------------------
+// same as FITveto, for all BCs in range at once
+inline bool FITveto(FITActivityIndex const& fitIndex, BCRowRange const& range, DGCutparHolder const& diffCuts)
+{
+  if (diffCuts.withTVX()) {
+    return fitIndex.isActive(FITActivityIndex::kTVX, range);
+  }
+  if (diffCuts.withTSC()) {
+    return fitIndex.isActive(FITActivityIndex::kTSC, range);
+  }
+  if (diffCuts.withTCE()) {
+    return fitIndex.isActive(FITActivityIndex::kTCE, range);
+  }
+  if (diffCuts.withTOR()) {
+    return fitIndex.isActive(FITActivityIndex::kFIT, range);
+  }
+  return false;
+}
+
 inline void setBit(uint64_t w[4], int bit, bool val)
 {
   if (!val) {
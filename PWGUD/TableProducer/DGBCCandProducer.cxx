@@ -287,6 +287,8 @@ struct DGBCCandProducer {
 
   // DG selector
   DGSelector dgSelector;
+  // FIT activity of the BCs in the current dataframe
+  udhelpers::FITActivityIndex fitIndex;
 
   HistogramRegistry registry{
     "registry",
@@ -408,6 +410,9 @@ struct DGBCCandProducer {
                      TCs const& tracks, aod::FwdTracks const& fwdtracks, FTIBCs const& ftibcs,
                      aod::Zdcs const& /*zdcs*/, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds)
   {
+    // FIT activity of the BCs, rebuilt only when bcs changes
+    fitIndex.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+
     // fill FITInfo
     auto bcnum = tibc.bcnum();
     upchelpers::FITInfo fitInfo{};
@@ -438,8 +443,8 @@ struct DGBCCandProducer {
 
         auto colTracks = tracks.sliceByCached(aod::track::collisionId, col.globalIndex(), cache);
         auto colFwdTracks = fwdtracks.sliceByCached(aod::fwdtrack::collisionId, col.globalIndex(), cache);
-        auto bcRange = udhelpers::compatibleBCs(col, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
-        isDG = dgSelector.IsSelected(diffCuts, col, bcRange, colTracks, colFwdTracks);
+        auto bcRows = udhelpers::compatibleBCRows(fitIndex, col, diffCuts.NDtcoll(), diffCuts.minNBCs());
+        isDG = dgSelector.IsSelected(diffCuts, col, fitIndex, bcRows, colTracks, colFwdTracks);
 
         // update UDTables, case 1.
         if (isDG == 0) {
@@ -456,7 +461,7 @@ struct DGBCCandProducer {
       } else {
         LOGF(debug, "  2. BC has NO collision");
         auto tracksArray = tibc.track_as<TCs>();
-        auto bcRange = udhelpers::compatibleBCs(bc, bc.globalBC(), diffCuts.minNBCs(), bcs);
+        auto bcRows = fitIndex.window(bc.globalBC(), diffCuts.minNBCs());
 
         // does BC have fwdTracks?
         if (ftibcs.size() > 0) {
@@ -466,14 +471,14 @@ struct DGBCCandProducer {
           if (ftibcSlice.size() > 0) {
             ftibcSlice.bindExternalIndices(&fwdtracks);
             auto fwdTracksArray = ftibcSlice.begin().fwdtrack_as<FTCs>();
-            isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+            isDG = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
           } else {
             auto fwdTracksArray = fwdtracks.emptySlice();
-            isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+            isDG = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
           }
         } else {
           auto fwdTracksArray = fwdtracks.emptySlice();
-          isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
         }
 
         // update UDTables, case 2.
@@ -502,7 +507,7 @@ struct DGBCCandProducer {
 
       // the BC is not contained in the BCs table
       auto tracksArray = tibc.track_as<TCs>();
-      auto bcRange = udhelpers::compatibleBCs(bcnum, diffCuts.minNBCs(), bcs);
+      auto bcRows = fitIndex.window(bcnum, diffCuts.minNBCs());
 
       // does BC have fwdTracks?
       if (ftibcs.size() > 0) {
@@ -512,14 +517,14 @@ struct DGBCCandProducer {
         if (ftibcPart.size() > 0) {
           ftibcPart.bindExternalIndices(&fwdtracks);
           auto fwdTracksArray = ftibcPart.begin().fwdtrack_as<FTCs>();
-          isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
         } else {
           auto fwdTracksArray = fwdtracks.emptySlice();
-          isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDG = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
         }
       } else {
         auto fwdTracksArray = fwdtracks.emptySlice();
-        isDG = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+        isDG = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
       }
 
       // update UDTables, case 3.
@@ -568,6 +573,7 @@ struct DGBCCandProducer {
     if (bcs.size() <= 0) {
       return;
     }
+    fitIndex.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
 
     // run over all BC in bcs and tibcs
     // int64_t lastCollision = 0;
@@ -633,10 +639,10 @@ struct DGBCCandProducer {
           // lastCollision = col.globalIndex();
 
           ntr1 = col.numContrib();
-          auto bcRange = udhelpers::compatibleBCs(bc, bcnum, diffCuts.minNBCs(), bcs);
+          auto bcRows = fitIndex.window(bcnum, diffCuts.minNBCs());
           auto colTracks = tracks.sliceByCached(aod::track::collisionId, col.globalIndex(), cache);
           auto colFwdTracks = fwdtracks.sliceByCached(aod::fwdtrack::collisionId, col.globalIndex(), cache);
-          isDG1 = dgSelector.IsSelected(diffCuts, col, bcRange, colTracks, colFwdTracks);
+          isDG1 = dgSelector.IsSelected(diffCuts, col, fitIndex, bcRows, colTracks, colFwdTracks);
           LOGF(debug, "  isDG1 %d with %d tracks", isDG1, ntr1);
           if (isDG1 == 0) {
             // this is a DG candidate with proper collision vertex
@@ -671,7 +677,7 @@ struct DGBCCandProducer {
         if (tibc.bcnum() == bcnum) {
           SETBIT(bcFlag, 4);
 
-          auto bcRange = udhelpers::compatibleBCs(bc, bcnum, diffCuts.minNBCs(), bcs);
+          auto bcRows = fitIndex.window(bcnum, diffCuts.minNBCs());
           auto tracksArray = tibc.track_as<TCs>();
           ntr2 = tracksArray.size();
 
@@ -681,14 +687,14 @@ struct DGBCCandProducer {
             }
             if (ftibc.bcnum() == bcnum) {
               auto fwdTracksArray = ftibc.fwdtrack_as<FTCs>();
-              isDG2 = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+              isDG2 = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
             } else {
               auto fwdTracksArray = fwdtracks.emptySlice();
-              isDG2 = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+              isDG2 = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
             }
           } else {
             auto fwdTracksArray = fwdtracks.emptySlice();
-            isDG2 = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+            isDG2 = dgSelector.IsSelectedBC(diffCuts, fitIndex, bcRows, tracksArray, fwdTracksArray);
           }
 
           LOGF(debug, "  isDG2 %d with %d tracks", isDG2, ntr2);
@@ -112,6 +112,8 @@ struct SGCandProducer {
 
   // SG selector
   SGSelector sgSelector;
+  // FIT activity of the BCs in the current dataframe
+  udhelpers::FITActivityIndex fitIndex;
   ctpRateFetcher mRateFetcher;
 
   // initialize RCT flag checker
@@ -290,9 +292,10 @@ struct SGCandProducer {
     }
     auto newbc = bc;
 
-    // obtain slice of compatible BCs
-    auto bcRange = udhelpers::compatibleBCs(collision, sameCuts.NDtcoll(), bcs, sameCuts.minNBCs());
-    auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, bc);
+    // obtain range of compatible BCs
+    fitIndex.update(bcs, sameCuts.maxFITtime(), sameCuts.FITAmpLimits());
+    auto bcRows = udhelpers::compatibleBCRows(fitIndex, collision, sameCuts.NDtcoll(), sameCuts.minNBCs());
+    auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, fitIndex, bcRows, bcs, bc);
     // auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, tracks);
     int issgevent = isSGEvent.value;
     if (isSGEvent.bc && issgevent < 2) {
@@ -85,6 +85,8 @@ struct DgCandProducer {
 
   // DG selector
   DGSelector dgSelector;
+  // FIT activity of the BCs in the current dataframe
+  udhelpers::FITActivityIndex fitIndex;
 
   // configurables
   Configurable<bool> saveAllTracks{"saveAllTracks", true, "save only PV contributors or all tracks associated to a collision"};
@@ -342,12 +344,13 @@ struct DgCandProducer {
     // fill FIT histograms
     fillFIThistograms(bc, histdir);
 
-    // obtain slice of compatible BCs
-    auto bcRange = udhelpers::compatibleBCs(collision, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
-    LOGF(debug, "<DGCandProducer>  Size of bcRange %d", bcRange.size());
+    // obtain range of compatible BCs
+    fitIndex.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+    auto bcRows = udhelpers::compatibleBCRows(fitIndex, collision, diffCuts.NDtcoll(), diffCuts.minNBCs());
+    LOGF(debug, "<DGCandProducer>  Size of bcRange %d", bcRows.size());
 
     // apply DG selection
-    auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, bcRange, tracks, fwdtracks);
+    auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, fitIndex, bcRows, tracks, fwdtracks);
 
     // save DG candidates
     getHist(TH1, histdir + "/Stat")->Fill(isDGEvent + 3, 1.);
@@ -97,6 +97,7 @@ struct PidMlBatchEffAndPurProducer {
   Configurable<std::string> localPath{"localPath", "/home/mkabus/PIDML/", "Base path to the local directory with ONNX models"};
   Configurable<bool> useFixedTimestamp{"useFixedTimestamp", false, "Whether to use fixed timestamp from configurable instead of timestamp calculated from the data"};
   Configurable<uint64_t> fixedTimestamp{"fixedTimestamp", 1524176895000, "Hardcoded timestamp for tests"};
+  Configurable<int> batchSize{"batchSize", 1024, "Number of tracks evaluated by the models in one batch"};
 
   Filter trackFilter = requireGlobalTrackInFilter();
 
@@ -105,6 +106,13 @@ struct PidMlBatchEffAndPurProducer {
                                             aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr, aod::pidTOFFullEl, aod::pidTOFFullMu>>;
   std::vector<PidONNXModel<BigTracks>> models;
 
+  // batched inference
+  std::vector<BigTracks::iterator> selectedTracks;
+  std::vector<BigTracks::iterator> batchTracks;
+  std::vector<std::size_t> modelInputs;        // index of the inputs used by each model; models with the same inputs share them
+  std::vector<PidONNXInputs> inputs;           // scaled inputs of the batch
+  std::vector<std::vector<float>> certainties; // outputs of each model for the batch
+
   void initHistos()
   {
     static const AxisSpec axisPt{50, 0, 3.1, "pt"};
@@ -240,19 +248,59 @@ struct PidMlBatchEffAndPurProducer {
       }
     }
 
+    const std::size_t nModels = pdgPids.value.size();
+    modelInputs.resize(nModels);
+    std::size_t nInputs = 0;
+    for (std::size_t i = 0; i < nModels; ++i) {
+      modelInputs[i] = nInputs;
+      for (std::size_t j = 0; j < i; ++j) {
+        if (models[j].hasSameInputs(models[i])) {
+          modelInputs[i] = modelInputs[j];
+          break;
+        }
+      }
+      if (modelInputs[i] == nInputs) {
+        nInputs++;
+      }
+    }
+    inputs.resize(nInputs);
+    certainties.resize(nModels);
+
+    selectedTracks.clear();
     for (const auto& track : tracks) {
       if (track.has_mcParticle()) {
         auto mcPart = track.mcParticle();
         if (mcPart.isPhysicalPrimary()) {
           fillTrackedHist(mcPart.pdgCode(), track.pt());
+          selectedTracks.push_back(track);
+        }
+      }
+    }
 
-          for (size_t i = 0; i < pdgPids.value.size(); ++i) {
-            float mlCertainty = models[i].applyModel(track);
-            nSigma_t nSigma = getNSigma(track, pdgPids.value[i]);
-            bool isMCPid = mcPart.pdgCode() == pdgPids.value[i];
+    const std::size_t nTracksPerBatch = std::max(1, batchSize.value);
+    for (std::size_t first = 0; first < selectedTracks.size(); first += nTracksPerBatch) {
+      const std::size_t last = std::min(first + nTracksPerBatch, selectedTracks.size());
+      batchTracks.assign(selectedTracks.begin() + first, selectedTracks.begin() + last);
+
+      // the inputs are numbered in the order of their first model, fill each of them only once
+      std::size_t nFilledInputs = 0;
+      for (std::size_t i = 0; i < nModels; ++i) {
+        if (modelInputs[i] == nFilledInputs) {
+          models[i].fillInputs(batchTracks, inputs[modelInputs[i]]);
+          nFilledInputs++;
+        }
+        models[i].applyModel(inputs[modelInputs[i]], certainties[i]);
+      }
+
+      for (std::size_t iTrack = 0; iTrack < batchTracks.size(); ++iTrack) {
+        const auto& track = batchTracks[iTrack];
+        auto mcPart = track.mcParticle();
+        for (size_t i = 0; i < nModels; ++i) {
+          float mlCertainty = certainties[i][iTrack];
+          nSigma_t nSigma = getNSigma(track, pdgPids.value[i]);
+          bool isMCPid = mcPart.pdgCode() == pdgPids.value[i];
 
-            effAndPurPIDResult(track.index(), pdgPids.value[i], track.pt(), mlCertainty, nSigma.composed, isMCPid, track.hasTOF(), track.hasTRD());
-          }
+          effAndPurPIDResult(track.index(), pdgPids.value[i], track.pt(), mlCertainty, nSigma.composed, isMCPid, track.hasTOF(), track.hasTRD());
         }
       }
     }
@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
@@ -79,6 +80,18 @@ bool readJsonFile(std::string const& config, rapidjson::Document& d)
 }
 } // namespace
 
+/// Scaled inputs of a block of tracks, row-major, to run the models on the whole block at once.
+/// The rows are grouped by the detectors used for the track, so that the rows of one session run
+/// have the NaNs of the missing detectors in the same columns.
+struct PidONNXInputs {
+  static constexpr int NGroups = 4; // TOF used + 2 * TRD used
+
+  std::size_t nColumns{0};
+  std::size_t nRows{0};
+  std::array<std::vector<float>, NGroups> values{};  // row-major inputs of each group
+  std::array<std::vector<uint32_t>, NGroups> rows{}; // position in the block of each row of the group
+};
+
 template <typename T>
 struct PidONNXModel {
  public:
@@ -123,6 +136,9 @@ struct PidONNXModel {
 
     // Assume model has 1 input node and 1 output node.
     assert(mInputNames.size() == 1 && mOutputNames.size() == 1);
+
+    mMemoryInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    mRunOptions = Ort::RunOptions{};
   }
   PidONNXModel() = default;
   PidONNXModel(PidONNXModel&&) = default;
@@ -141,6 +157,54 @@ struct PidONNXModel {
     return getModelOutput(track) >= mMinCertainty;
   }
 
+  /// Whether the other model takes the same inputs, i.e. the inputs of a block can be shared
+  bool hasSameInputs(const PidONNXModel& other) const
+  {
+    return mTrainColumns == other.mTrainColumns && mColumnScaling == other.mColumnScaling && mPLimits == other.mPLimits;
+  }
+
+  /// Gathers the scaled inputs of a block of tracks
+  void fillInputs(const std::vector<typename T::iterator>& tracks, PidONNXInputs& inputs) const
+  {
+    const std::size_t nColumns = mTrainColumns.size();
+    inputs.nColumns = nColumns;
+    inputs.nRows = tracks.size();
+    for (int iGroup = 0; iGroup < PidONNXInputs::NGroups; ++iGroup) {
+      inputs.values[iGroup].clear();
+      inputs.rows[iGroup].clear();
+    }
+    for (std::size_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
+      const auto& track = tracks[iTrack];
+      bool useTOF = !pidml::pidutils::tofMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOF]);
+      bool useTRD = !pidml::pidutils::trdMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOFTRD]);
+      const int group = static_cast<int>(useTOF) + 2 * static_cast<int>(useTRD);
+      auto& values = inputs.values[group];
+      values.resize(values.size() + nColumns);
+      fillValues(track, useTOF, useTRD, values.data() + values.size() - nColumns);
+      inputs.rows[group].push_back(iTrack);
+    }
+  }
+
+  /// Runs the model on the inputs of a block, with one session run per group of rows
+  /// \param certainties are the model outputs, in the order of the tracks of the block
+  void applyModel(PidONNXInputs& inputs, std::vector<float>& certainties)
+  {
+    certainties.assign(inputs.nRows, 0.f);
+    for (int iGroup = 0; iGroup < PidONNXInputs::NGroups; ++iGroup) {
+      const auto& rows = inputs.rows[iGroup];
+      if (rows.empty()) {
+        continue;
+      }
+      const float* outputValues = runModel(inputs.values[iGroup].data(), rows.size());
+      if (outputValues == nullptr) {
+        continue;
+      }
+      for (std::size_t iRow = 0; iRow < rows.size(); ++iRow) {
+        certainties[rows[iRow]] = outputValues[iRow * mOutputsPerRow];
+      }
+    }
+  }
+
   int mPid{0};
   double mMinCertainty{0};
 
@@ -207,6 +271,23 @@ struct PidONNXModel {
         mScalingParams[param[0].GetString()] = std::make_pair(param[1].GetFloat(), param[2].GetFloat());
       }
     }
+
+    // per-column scaling and detector, to avoid the lookups by label for each track
+    for (const auto& columnLabel : mTrainColumns) {
+      auto scalingParamsEntry = mScalingParams.find(columnLabel);
+      if (scalingParamsEntry != mScalingParams.end()) {
+        mColumnScaling.emplace_back(scalingParamsEntry->second);
+      } else {
+        mColumnScaling.emplace_back(std::nullopt);
+      }
+      if (columnLabel == "fTRDSignal" || columnLabel == "fTRDPattern") {
+        mColumnDetectors.push_back(kTPCTOFTRD);
+      } else if (columnLabel == "fTOFSignal" || columnLabel == "fBeta") {
+        mColumnDetectors.push_back(kTPCTOF);
+      } else {
+        mColumnDetectors.push_back(kTPCOnly);
+      }
+    }
   }
 
   static float scale(float value, const std::pair<float, float>& scalingParams)
@@ -214,87 +295,93 @@ struct PidONNXModel {
     return (value - scalingParams.first) / scalingParams.second;
   }
 
-  std::vector<float> getValues(const typename T::iterator& track)
+  void fillValues(const typename T::iterator& track, bool useTOF, bool useTRD, float* output) const
   {
-    std::vector<float> output;
-    output.reserve(mTrainColumns.size());
-
-    bool useTOF = !pidml::pidutils::tofMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOF]);
-    bool useTRD = !pidml::pidutils::trdMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOFTRD]);
-
     for (uint32_t i = 0; i < mTrainColumns.size(); ++i) {
-      auto& columnLabel = mTrainColumns[i];
-
-      if (
-        ((columnLabel == "fTRDSignal" || columnLabel == "fTRDPattern") && !useTRD) ||
-        ((columnLabel == "fTOFSignal" || columnLabel == "fBeta") && !useTOF)) {
-        output.push_back(std::numeric_limits<float>::quiet_NaN());
+      if ((mColumnDetectors[i] == kTPCTOFTRD && !useTRD) || (mColumnDetectors[i] == kTPCTOF && !useTOF)) {
+        output[i] = std::numeric_limits<float>::quiet_NaN();
         continue;
       }
 
-      std::optional<std::pair<float, float>> scalingParams = std::nullopt;
-
-      auto scalingParamsEntry = mScalingParams.find(columnLabel);
-      if (scalingParamsEntry != mScalingParams.end()) {
-        scalingParams = scalingParamsEntry->second;
-      }
-
       float value = mGetters[i](track);
 
-      if (scalingParams) {
-        value = scale(value, scalingParams.value());
+      if (mColumnScaling[i]) {
+        value = scale(value, mColumnScaling[i].value());
       }
 
-      output.push_back(value);
+      output[i] = value;
     }
+  }
+
+  std::vector<float> getValues(const typename T::iterator& track)
+  {
+    std::vector<float> output(mTrainColumns.size());
+
+    bool useTOF = !pidml::pidutils::tofMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOF]);
+    bool useTRD = !pidml::pidutils::trdMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOFTRD]);
+    fillValues(track, useTOF, useTRD, output.data());
 
     return output;
   }
 
-  float getModelOutput(const typename T::iterator& track)
+  /// Points the cached name arrays to the names, again if the model was moved
+  void updateNamesChar()
   {
-    // First rank of the expected model input is -1 which means that it is dynamic axis.
-    // Axis is exported as dynamic to make it possible to run model inference with the batch of
-    // tracks at once in the future (batch would need to have the same amount of quiet_NaNs in each row).
-    // For now we hardcode 1.
-    static constexpr int64_t BatchSize = 1;
-    auto inputShape = mInputShapes[0];
-    inputShape[0] = BatchSize;
+    if (mInputNamesChar.size() == mInputNames.size() && (mInputNames.empty() || mInputNamesChar[0] == mInputNames[0].c_str()) &&
+        mOutputNamesChar.size() == mOutputNames.size() && (mOutputNames.empty() || mOutputNamesChar[0] == mOutputNames[0].c_str())) {
+      return;
+    }
+    mInputNamesChar.resize(mInputNames.size());
+    std::transform(std::begin(mInputNames), std::end(mInputNames), std::begin(mInputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
+    mOutputNamesChar.resize(mOutputNames.size());
+    std::transform(std::begin(mOutputNames), std::end(mOutputNames), std::begin(mOutputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
+  }
 
-    std::vector<float> inputTensorValues = getValues(track);
-    std::vector<Ort::Value> inputTensors;
+  /// Runs the session on nRows rows of inputs
+  /// \return the outputs, mOutputsPerRow values per row, valid until the next run; nullptr if the inference failed
+  const float* runModel(float* inputValues, std::size_t nRows)
+  {
+    // First rank of the expected model input is -1 which means that it is dynamic axis.
+    // The rows of one run must have the same amount of quiet_NaNs at the same positions.
+    mInputShape = mInputShapes[0];
+    mInputShape[0] = nRows;
 
-    Ort::MemoryInfo memInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-    inputTensors.emplace_back(Ort::Value::CreateTensor<float>(memInfo, inputTensorValues.data(), inputTensorValues.size(), inputShape.data(), inputShape.size()));
+    updateNamesChar();
+    mInputTensors.clear();
+    mInputTensors.emplace_back(Ort::Value::CreateTensor<float>(mMemoryInfo, inputValues, nRows * mTrainColumns.size(), mInputShape.data(), mInputShape.size()));
 
     // Double-check the dimensions of the input tensor
-    assert(inputTensors[0].IsTensor() &&
-           inputTensors[0].GetTensorTypeAndShapeInfo().GetShape() == inputShape);
-    LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+    assert(mInputTensors[0].IsTensor() &&
+           mInputTensors[0].GetTensorTypeAndShapeInfo().GetShape() == mInputShape);
+    LOG(debug) << "input tensor shape: " << printShape(mInputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
 
     try {
-      Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(mInputNames.size(), nullptr);
-      std::transform(std::begin(mInputNames), std::end(mInputNames), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-
-      std::vector<const char*> outputNamesChar(mOutputNames.size(), nullptr);
-      std::transform(std::begin(mOutputNames), std::end(mOutputNames), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-      auto outputTensors = mSession->Run(runOptions, inputNamesChar.data(), inputTensors.data(), inputTensors.size(), outputNamesChar.data(), outputNamesChar.size());
+      mOutputTensors = mSession->Run(mRunOptions, mInputNamesChar.data(), mInputTensors.data(), mInputTensors.size(), mOutputNamesChar.data(), mOutputNamesChar.size());
 
       // Double-check the dimensions of the output tensors
       // The number of output tensors is equal to the number of output nodes specified in the Run() call
-      assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
-      LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+      assert(mOutputTensors.size() == mOutputNames.size() && mOutputTensors[0].IsTensor());
+      LOG(debug) << "output tensor shape: " << printShape(mOutputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
 
-      const float* outputValue = outputTensors[0].GetTensorData<float>();
-      float certainty = *outputValue;
-      return certainty;
+      mOutputsPerRow = mOutputTensors[0].GetTensorTypeAndShapeInfo().GetElementCount() / nRows;
+      return mOutputTensors[0].GetTensorData<float>();
     } catch (const Ort::Exception& exception) {
       LOG(error) << "Error running model inference: " << exception.what();
     }
-    return false; // unreachable code
+    return nullptr;
+  }
+
+  float getModelOutput(const typename T::iterator& track)
+  {
+    mSingleInput = getValues(track);
+    const float* outputValue = runModel(mSingleInput.data(), 1);
+    if (outputValue == nullptr) {
+      return 0.f;
+    }
+    float certainty = *outputValue;
+    return certainty;
   }
 
   // Pretty prints a shape dimension vector
@@ -310,6 +397,8 @@ struct PidONNXModel {
   std::vector<std::string> mTrainColumns;
   std::vector<float (*)(const typename T::iterator&)> mGetters;
   std::map<std::string, std::pair<float, float>> mScalingParams;
+  std::vector<std::optional<std::pair<float, float>>> mColumnScaling; // scaling parameters of each training column, if any
+  std::vector<PidMLDetector> mColumnDetectors;                        // detector needed by each training column
 
   std::shared_ptr<Ort::Env> mEnv = nullptr;
   // No empty constructors for Session, we need a pointer
@@ -320,6 +409,17 @@ struct PidONNXModel {
   std::vector<std::vector<int64_t>> mInputShapes;
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
+
+  // reused by all the session runs
+  Ort::MemoryInfo mMemoryInfo{nullptr};
+  Ort::RunOptions mRunOptions{nullptr};
+  std::vector<const char*> mInputNamesChar;
+  std::vector<const char*> mOutputNamesChar;
+  std::vector<int64_t> mInputShape;
+  std::vector<Ort::Value> mInputTensors;
+  std::vector<Ort::Value> mOutputTensors;
+  std::size_t mOutputsPerRow{1};
+  std::vector<float> mSingleInput;
 };
 
 #endif // TOOLS_PIDML_PIDONNXMODEL_H_